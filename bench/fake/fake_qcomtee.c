@@ -0,0 +1,281 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "qcomtee_object_types.h"
+
+#define FAKE_PAGE_SIZE 4096
+
+/* Object_ERROR_DEFUNCT, as returned by QTEE for a dead TA. */
+#define FAKE_ERROR_DEFUNCT (-90)
+
+static __thread uint64_t invoke_delay_ns;
+static int register_memory = 1;
+
+static uint64_t fake_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Spin rather than sleep; scheduler wake-up latency would dominate. */
+static void fake_delay(uint64_t ns)
+{
+	uint64_t end = fake_now() + ns;
+
+	while (fake_now() < end)
+		;
+}
+
+static struct qcomtee_object *fake_object_new(enum qcomtee_object_type type,
+					      struct qcomtee_object *root)
+{
+	struct qcomtee_object *object = calloc(1, sizeof(*object));
+	if (!object)
+		return QCOMTEE_OBJECT_NULL;
+
+	object->refs = 1;
+	object->object_type = type;
+	object->root = root;
+
+	return object;
+}
+
+static void fake_object_free(struct qcomtee_object *object)
+{
+	switch (object->object_type) {
+	case QCOMTEE_OBJECT_TYPE_CB:
+		/* Callback objects are owned by their implementer. */
+		if (object->ops && object->ops->release)
+			object->ops->release(object);
+		return;
+	case QCOMTEE_OBJECT_TYPE_MEMORY:
+		if (!object->registered)
+			free(object->addr);
+		break;
+	case QCOMTEE_OBJECT_TYPE_ROOT:
+		if (object->root_release)
+			object->root_release(object->root_arg);
+		break;
+	default:
+		break;
+	}
+
+	free(object);
+}
+
+struct qcomtee_object *qcomtee_object_root_init(const char *devname,
+						qcomtee_tee_call_t tee_call,
+						void (*release)(void *),
+						void *arg)
+{
+	(void)devname;
+	(void)tee_call;
+
+	struct qcomtee_object *root =
+		fake_object_new(QCOMTEE_OBJECT_TYPE_ROOT, QCOMTEE_OBJECT_NULL);
+	if (!root)
+		return QCOMTEE_OBJECT_NULL;
+
+	root->root = root;
+	root->root_release = release;
+	root->root_arg = arg;
+
+	return root;
+}
+
+void qcomtee_object_cb_init(struct qcomtee_object *object,
+			    struct qcomtee_object_ops *ops,
+			    struct qcomtee_object *root)
+{
+	object->refs = 1;
+	object->object_type = QCOMTEE_OBJECT_TYPE_CB;
+	object->root = root;
+	object->ops = ops;
+}
+
+enum qcomtee_object_type qcomtee_object_typeof(struct qcomtee_object *object)
+{
+	if (object == QCOMTEE_OBJECT_NULL)
+		return QCOMTEE_OBJECT_TYPE_NULL;
+
+	return object->object_type;
+}
+
+void qcomtee_object_refs_inc(struct qcomtee_object *object)
+{
+	if (object != QCOMTEE_OBJECT_NULL)
+		__atomic_add_fetch(&object->refs, 1, __ATOMIC_RELAXED);
+}
+
+void qcomtee_object_refs_dec(struct qcomtee_object *object)
+{
+	if (object == QCOMTEE_OBJECT_NULL)
+		return;
+
+	if (__atomic_sub_fetch(&object->refs, 1, __ATOMIC_ACQ_REL) == 0)
+		fake_object_free(object);
+}
+
+int qcomtee_object_invoke(struct qcomtee_object *object, qcomtee_op_t op,
+			  struct qcomtee_param *params, int num_params,
+			  qcomtee_result_t *result)
+{
+	if (object == QCOMTEE_OBJECT_NULL)
+		return -1;
+
+	/* Invoking a callback object loops straight back to its dispatcher. */
+	if (object->object_type == QCOMTEE_OBJECT_TYPE_CB) {
+		*result = fake_qcomtee_dispatch(object, op, params, num_params);
+		return 0;
+	}
+
+	if (__atomic_load_n(&object->defunct, __ATOMIC_ACQUIRE)) {
+		*result = (qcomtee_result_t)FAKE_ERROR_DEFUNCT;
+		return 0;
+	}
+
+	for (int i = 0; i < num_params; i++) {
+		switch (params[i].attr) {
+		case QCOMTEE_OBJREF_INPUT:
+			/* The callee consumes the input objects. Memory
+			 * objects are only mapped for the invocation.
+			 */
+			if (qcomtee_object_typeof(params[i].object) !=
+			    QCOMTEE_OBJECT_TYPE_MEMORY)
+				qcomtee_object_refs_dec(params[i].object);
+			break;
+		case QCOMTEE_OBJREF_OUTPUT:
+			params[i].object = fake_qcomtee_remote_object(object->root);
+			break;
+		case QCOMTEE_UBUF_OUTPUT:
+			/* QTEE fills the output buffers; all zeros reads as
+			 * success in the results returned by IDL methods.
+			 */
+			memset(params[i].ubuf.addr, 0, params[i].ubuf.size);
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (invoke_delay_ns)
+		fake_delay(invoke_delay_ns);
+
+	*result = QCOMTEE_OK;
+	return 0;
+}
+
+int qcomtee_object_process_one(struct qcomtee_object *root)
+{
+	(void)root;
+
+	/* Nothing is ever queued by the loopback transport. */
+	return -1;
+}
+
+int qcomtee_object_credentials_init(struct qcomtee_object *root,
+				    struct qcomtee_object **object)
+{
+	*object = fake_qcomtee_remote_object(root);
+
+	return *object == QCOMTEE_OBJECT_NULL ? -1 : 0;
+}
+
+int qcomtee_memory_object_alloc(size_t size, struct qcomtee_object *root,
+				struct qcomtee_object **object)
+{
+	size_t aligned = (size + FAKE_PAGE_SIZE - 1) & ~(size_t)(FAKE_PAGE_SIZE - 1);
+	struct qcomtee_object *mo = NULL;
+
+	if (!aligned)
+		return -1;
+
+	mo = fake_object_new(QCOMTEE_OBJECT_TYPE_MEMORY, root);
+	if (!mo)
+		return -1;
+
+	mo->addr = aligned_alloc(FAKE_PAGE_SIZE, aligned);
+	if (!mo->addr) {
+		free(mo);
+		return -1;
+	}
+
+	mo->size = aligned;
+	*object = mo;
+
+	return 0;
+}
+
+int qcomtee_memory_object_register(void *addr, size_t size,
+				   struct qcomtee_object *root,
+				   struct qcomtee_object **object)
+{
+	struct qcomtee_object *mo = NULL;
+
+	if (!register_memory)
+		return -1;
+
+	if (!addr || !size || ((uintptr_t)addr | size) & (FAKE_PAGE_SIZE - 1))
+		return -1;
+
+	mo = fake_object_new(QCOMTEE_OBJECT_TYPE_MEMORY, root);
+	if (!mo)
+		return -1;
+
+	mo->addr = addr;
+	mo->size = size;
+	mo->registered = 1;
+	*object = mo;
+
+	return 0;
+}
+
+void *qcomtee_memory_object_addr(struct qcomtee_object *object)
+{
+	return object->addr;
+}
+
+size_t qcomtee_memory_object_size(struct qcomtee_object *object)
+{
+	return object->size;
+}
+
+struct qcomtee_object *fake_qcomtee_remote_object(struct qcomtee_object *root)
+{
+	return fake_object_new(QCOMTEE_OBJECT_TYPE_TEE, root);
+}
+
+void fake_qcomtee_set_invoke_delay(uint64_t ns)
+{
+	invoke_delay_ns = ns;
+}
+
+void fake_qcomtee_set_register_memory(int enable)
+{
+	register_memory = enable;
+}
+
+void fake_qcomtee_set_defunct(struct qcomtee_object *object)
+{
+	__atomic_store_n(&object->defunct, 1, __ATOMIC_RELEASE);
+}
+
+qcomtee_result_t fake_qcomtee_dispatch(struct qcomtee_object *object,
+				       qcomtee_op_t op,
+				       struct qcomtee_param *params, int num)
+{
+	qcomtee_result_t ret = object->ops->dispatch(object, op, params, num);
+
+	/* QCOMTEE cleans up only after a successful response. */
+	if (!ret && object->ops->error)
+		object->ops->error(object, 0);
+
+	return ret;
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdlib.h>
+
+#include "supplicant.h"
+
+/**
+ * @brief Release the supplicant associated with a root object.
+ *
+ * @param arg Supplicant which is to be released.
+ */
+static void supplicant_release(void *arg)
+{
+	free(arg);
+}
+
+/* The loopback transport never queues callback requests, so unlike the real
+ * supplicant no worker threads are started here.
+ */
+struct supplicant *supplicant_start(int pthreads_num)
+{
+	struct supplicant *sup;
+
+	if (pthreads_num > SUPPLICANT_THREADS)
+		return NULL;
+
+	sup = calloc(1, sizeof(*sup));
+	if (!sup)
+		return NULL;
+
+	sup->root = qcomtee_object_root_init(DEV_TEE, NULL, supplicant_release,
+					     sup);
+	if (sup->root == QCOMTEE_OBJECT_NULL) {
+		free(sup);
+		return NULL;
+	}
+
+	return sup;
+}
@@ -0,0 +1,190 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef _QCOMTEE_OBJECT_TYPES_H
+#define _QCOMTEE_OBJECT_TYPES_H
+
+/* A host-side stand-in for the QCOMTEE object API.
+ *
+ * Only the subset of QCOMTEE used by the Mink Adaptor is provided. Remote
+ * objects are served in-process by a loopback transport (see fake_qcomtee.c),
+ * so the marshalling layer can be built and measured on a plain Linux host
+ * without the QCOM-TEE driver.
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MSGE
+#define MSGE(...) fprintf(stderr, __VA_ARGS__)
+#endif
+
+#ifndef MSGD
+#define MSGD(...)
+#endif
+
+typedef uint32_t qcomtee_op_t;
+typedef uint32_t qcomtee_result_t;
+
+#define QCOMTEE_OK 0
+
+enum qcomtee_object_type {
+	QCOMTEE_OBJECT_TYPE_NULL = 0,
+	QCOMTEE_OBJECT_TYPE_TEE,
+	QCOMTEE_OBJECT_TYPE_ROOT,
+	QCOMTEE_OBJECT_TYPE_CB,
+	QCOMTEE_OBJECT_TYPE_MEMORY,
+};
+
+/* Parameter attributes. */
+#define QCOMTEE_UBUF_INPUT    1
+#define QCOMTEE_UBUF_OUTPUT   2
+#define QCOMTEE_OBJREF_INPUT  3
+#define QCOMTEE_OBJREF_OUTPUT 4
+
+struct qcomtee_object;
+
+struct qcomtee_ubuf {
+	void *addr;
+	size_t size;
+};
+
+struct qcomtee_param {
+	uint64_t attr;
+	union {
+		struct qcomtee_ubuf ubuf;
+		struct qcomtee_object *object;
+	};
+};
+
+struct qcomtee_object_ops {
+	void (*release)(struct qcomtee_object *object);
+	qcomtee_result_t (*dispatch)(struct qcomtee_object *object,
+				     qcomtee_op_t op,
+				     struct qcomtee_param *params, int num);
+	void (*error)(struct qcomtee_object *object, int err);
+};
+
+typedef int (*qcomtee_tee_call_t)(int fd, unsigned long op, ...);
+
+struct qcomtee_object {
+	int refs;
+	enum qcomtee_object_type object_type;
+	struct qcomtee_object *root;
+	struct qcomtee_object_ops *ops;
+
+	/* QCOMTEE_OBJECT_TYPE_MEMORY */
+	void *addr;
+	size_t size;
+	int registered; /* addr is owned by the client. */
+
+	/* QCOMTEE_OBJECT_TYPE_TEE */
+	int defunct; /* Invocations fail with Object_ERROR_DEFUNCT. */
+
+	/* QCOMTEE_OBJECT_TYPE_ROOT */
+	void (*root_release)(void *arg);
+	void *root_arg;
+};
+
+#define QCOMTEE_OBJECT_NULL ((struct qcomtee_object *)NULL)
+
+struct qcomtee_object *qcomtee_object_root_init(const char *devname,
+						qcomtee_tee_call_t tee_call,
+						void (*release)(void *),
+						void *arg);
+
+void qcomtee_object_cb_init(struct qcomtee_object *object,
+			    struct qcomtee_object_ops *ops,
+			    struct qcomtee_object *root);
+
+enum qcomtee_object_type qcomtee_object_typeof(struct qcomtee_object *object);
+
+void qcomtee_object_refs_inc(struct qcomtee_object *object);
+
+void qcomtee_object_refs_dec(struct qcomtee_object *object);
+
+int qcomtee_object_invoke(struct qcomtee_object *object, qcomtee_op_t op,
+			  struct qcomtee_param *params, int num_params,
+			  qcomtee_result_t *result);
+
+int qcomtee_object_process_one(struct qcomtee_object *root);
+
+int qcomtee_object_credentials_init(struct qcomtee_object *root,
+				    struct qcomtee_object **object);
+
+int qcomtee_memory_object_alloc(size_t size, struct qcomtee_object *root,
+				struct qcomtee_object **object);
+
+int qcomtee_memory_object_register(void *addr, size_t size,
+				   struct qcomtee_object *root,
+				   struct qcomtee_object **object);
+
+void *qcomtee_memory_object_addr(struct qcomtee_object *object);
+
+size_t qcomtee_memory_object_size(struct qcomtee_object *object);
+
+/**
+ * @brief Create a remote (QTEE) object served by the loopback transport.
+ *
+ * @param root The root object the new object belongs to.
+ * @return A new remote object with a single reference.
+ *         QCOMTEE_OBJECT_NULL on failure.
+ */
+struct qcomtee_object *fake_qcomtee_remote_object(struct qcomtee_object *root);
+
+/**
+ * @brief Set the time each invocation of a remote object takes.
+ *
+ * Emulates the time spent in QTEE; the loopback transport returns
+ * immediately by default. The setting is per thread.
+ *
+ * @param ns Time to spin in qcomtee_object_invoke(), in nanoseconds.
+ */
+void fake_qcomtee_set_invoke_delay(uint64_t ns);
+
+/**
+ * @brief Enable or disable registering client memory.
+ *
+ * Registration is enabled by default; when disabled,
+ * qcomtee_memory_object_register() fails so the copy path can be measured.
+ *
+ * @param enable Whether registration succeeds.
+ */
+void fake_qcomtee_set_register_memory(int enable);
+
+/**
+ * @brief Make a remote object defunct, as if the TA serving it crashed.
+ *
+ * Every later invocation of the object fails with Object_ERROR_DEFUNCT.
+ *
+ * @param object The remote object.
+ */
+void fake_qcomtee_set_defunct(struct qcomtee_object *object);
+
+/**
+ * @brief Simulate QTEE invoking a callback object.
+ *
+ * Calls the dispatch operation of the callback object and, on success, its
+ * post-response cleanup, as QCOMTEE does for callback requests.
+ *
+ * @param object The callback object to invoke.
+ * @param op Operation being invoked on the callback object.
+ * @param params List of parameters for this invocation.
+ * @param num Number of parameters in the params list.
+ * @return The result of the dispatch operation.
+ */
+qcomtee_result_t fake_qcomtee_dispatch(struct qcomtee_object *object,
+				       qcomtee_op_t op,
+				       struct qcomtee_param *params, int num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _QCOMTEE_OBJECT_TYPES_H
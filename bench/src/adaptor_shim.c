@@ -0,0 +1,63 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+/* The marshalling helpers are static to the Mink Adaptor; build it as part of
+ * this translation unit so they can be measured directly.
+ */
+#include "mink_adaptor.c"
+
+#include "bench_shim.h"
+
+ObjectCounts bench_get_obj_counts(struct qcomtee_param *params,
+				  uint32_t num_params)
+{
+	return get_obj_counts(params, num_params);
+}
+
+int32_t bench_object_args_to_tee_params(ObjectArg *args, ObjectCounts counts,
+					struct qcomtee_param *params,
+					struct qcomtee_object *root)
+{
+	return object_args_to_tee_params(args, counts, params, root);
+}
+
+int32_t bench_object_args_from_tee_params(struct qcomtee_param *params,
+					  ObjectArg *args,
+					  ObjectCounts counts)
+{
+	return object_args_from_tee_params(params, args, counts);
+}
+
+int32_t bench_object_args_from_tee_params_cb(struct qcomtee_param *params,
+					     uint32_t num_params,
+					     ObjectArg *args,
+					     void **allocated_bo)
+{
+	return object_args_from_tee_params_cb(params, num_params, args,
+					      allocated_bo);
+}
+
+void bench_release_qcomtee_objs(struct qcomtee_param *params,
+				uint32_t num_params, uint64_t attr)
+{
+	release_qcomtee_objs(params, num_params, attr);
+}
+
+Object bench_remote_object(Object root)
+{
+	struct qcomtee_object *object =
+		fake_qcomtee_remote_object((struct qcomtee_object *)root.context);
+
+	return mink_obj_from_qcomtee_obj(object);
+}
+
+struct qcomtee_object *bench_callback_object(Object root, Object obj)
+{
+	struct qcomtee_object *object = QCOMTEE_OBJECT_NULL;
+
+	if (qcomtee_obj_from_mink_obj((struct qcomtee_object *)root.context,
+				      obj, &object))
+		return QCOMTEE_OBJECT_NULL;
+
+	return object;
+}
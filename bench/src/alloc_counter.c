@@ -0,0 +1,49 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "bench_shim.h"
+
+/* Resolved by the linker's --wrap option to the C library allocators. */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+void *__wrap_aligned_alloc(size_t alignment, size_t size);
+
+static atomic_uint_fast64_t alloc_count;
+
+uint64_t bench_alloc_count(void)
+{
+	return atomic_load_explicit(&alloc_count, memory_order_relaxed);
+}
+
+void *__wrap_malloc(size_t size)
+{
+	atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+	atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+	return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+	atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+	return __real_realloc(ptr, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size)
+{
+	atomic_fetch_add_explicit(&alloc_count, 1, memory_order_relaxed);
+	return __real_aligned_alloc(alignment, size);
+}
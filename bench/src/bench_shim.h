@@ -0,0 +1,98 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef _BENCH_SHIM_H_
+#define _BENCH_SHIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "qcomtee_object_types.h"
+
+#include "object.h"
+#include "tee_client_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ''Allocation accounting'' (alloc_counter.c).
+ *
+ * malloc, calloc, realloc and aligned_alloc are wrapped at link time, so
+ * every allocation made by the marshalling code is counted.
+ */
+uint64_t bench_alloc_count(void);
+
+/* ''Mink Adaptor'' (adaptor_shim.c). */
+
+ObjectCounts bench_get_obj_counts(struct qcomtee_param *params,
+				  uint32_t num_params);
+
+int32_t bench_object_args_to_tee_params(ObjectArg *args, ObjectCounts counts,
+					struct qcomtee_param *params,
+					struct qcomtee_object *root);
+
+int32_t bench_object_args_from_tee_params(struct qcomtee_param *params,
+					  ObjectArg *args,
+					  ObjectCounts counts);
+
+int32_t bench_object_args_from_tee_params_cb(struct qcomtee_param *params,
+					     uint32_t num_params,
+					     ObjectArg *args,
+					     void **allocated_bo);
+
+void bench_release_qcomtee_objs(struct qcomtee_param *params,
+				uint32_t num_params, uint64_t attr);
+
+/**
+ * @brief Wrap a remote object served by the loopback transport in a MINK
+ * object.
+ */
+Object bench_remote_object(Object root);
+
+/**
+ * @brief Wrap a local MINK object in a QCOMTEE callback object, the same way
+ * the adaptor does when a MINK object is sent to QTEE.
+ */
+struct qcomtee_object *bench_callback_object(Object root, Object obj);
+
+/* ''Mink TEEC'' (teec_shim.c). */
+
+/**
+ * @brief Run mink_params_from_teec_params() over an operation's parameters.
+ *
+ * @return The extended parameter types computed for the operation.
+ */
+uint32_t bench_mink_params_from_teec_params(uint32_t param_types,
+					    TEEC_Parameter *params);
+
+/**
+ * @brief Run the marshalling done by invoke_command() around the IDL call:
+ * temporary memory conversion, MINK parameter conversion, type conversion,
+ * registered memory copy-out and temporary memory restoration.
+ */
+TEEC_Result bench_teec_marshal(TEEC_Context *ctx, TEEC_Operation *op);
+
+/**
+ * @brief Create the CWait object a TEE context hands QTEE for TEE_Wait().
+ */
+Object bench_cwait_open(void);
+
+/**
+ * @brief Signal a cancellation with a cancel code on a CWait object, as
+ * TEEC_RequestCancellation() does.
+ */
+int32_t bench_cwait_signal(Object wait, uint32_t code);
+
+/**
+ * @brief Wait for a cancellation with a cancel code on a CWait object, as a
+ * TA does from TEE_Wait().
+ */
+int32_t bench_cwait_wait(Object wait, uint32_t code, uint32_t msec,
+			 uint32_t *events);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _BENCH_SHIM_H_
@@ -0,0 +1,471 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_shim.h"
+#include "tee_client_api_ext.h"
+
+/* Run a configurable TEEC_InvokeCommand() workload from a number of threads
+ * over a number of sessions, and report its throughput and latency
+ * distribution as JSON.
+ */
+
+#define GP_BENCH_MAX_PARAMS 4
+
+enum param_kind {
+	PARAM_VALUE,
+	PARAM_TEMP,
+	PARAM_WHOLE,
+	PARAM_PARTIAL,
+};
+
+static const char *const param_names[] = {
+	[PARAM_VALUE] = "value",
+	[PARAM_TEMP] = "temp",
+	[PARAM_WHOLE] = "whole",
+	[PARAM_PARTIAL] = "partial",
+};
+
+struct workload {
+	enum param_kind mix[GP_BENCH_MAX_PARAMS];
+	size_t num_params;
+	size_t size;
+	unsigned int threads;
+	unsigned int sessions;
+	/* Shared memory is allocated by the library, rather than registered */
+	int allocate;
+	/* Sessions are opened with the local reference TA */
+	int local;
+	uint32_t command;
+	size_t iterations;
+	size_t warmup;
+};
+
+/* Workers wait at the gate until all of them are set up. */
+struct gate {
+	/* 0 while closed, 1 once open, -1 if the run was aborted */
+	int state;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+struct worker {
+	const struct workload *w;
+	TEEC_Context *ctx;
+	TEEC_Session *session;
+	struct gate *gate;
+
+	TEEC_Operation op;
+	TEEC_SharedMemory shm[GP_BENCH_MAX_PARAMS];
+	void *bufs[GP_BENCH_MAX_PARAMS];
+
+	uint64_t *ns;
+	size_t errors;
+	/* Past the warmup, and done */
+	uint64_t begin;
+	uint64_t end;
+
+	pthread_t thread;
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int cmp_ns(const void *a, const void *b)
+{
+	const uint64_t *x = a, *y = b;
+
+	return (*x > *y) - (*x < *y);
+}
+
+static uint64_t percentile(uint64_t *ns, size_t n, double p)
+{
+	size_t i = (size_t)(p * (n - 1) + 0.5);
+
+	return ns[i];
+}
+
+/**
+ * @brief Parse a comma-separated list of parameter kinds.
+ *
+ * @return 0 on success, -1 if the list is invalid.
+ */
+static int parse_mix(const char *arg, struct workload *w)
+{
+	char *list = strdup(arg);
+	char *save = NULL;
+	char *tok = NULL;
+	int ret = 0;
+
+	if (!list)
+		return -1;
+
+	w->num_params = 0;
+
+	for (tok = strtok_r(list, ",", &save); tok;
+	     tok = strtok_r(NULL, ",", &save)) {
+		size_t k = 0;
+
+		while (k <= PARAM_PARTIAL && strcmp(tok, param_names[k]))
+			k++;
+
+		if (k > PARAM_PARTIAL || w->num_params == GP_BENCH_MAX_PARAMS) {
+			ret = -1;
+			break;
+		}
+
+		w->mix[w->num_params++] = (enum param_kind)k;
+	}
+
+	free(list);
+
+	return w->num_params ? ret : -1;
+}
+
+/**
+ * @brief Set up the operation a worker invokes, with its own memory.
+ */
+static int worker_setup(struct worker *wk)
+{
+	const struct workload *w = wk->w;
+	uint32_t types[GP_BENCH_MAX_PARAMS] = { TEEC_NONE, TEEC_NONE,
+						TEEC_NONE, TEEC_NONE };
+	TEEC_SharedMemory *shm = NULL;
+	TEEC_Result result;
+
+	memset(&wk->op, 0, sizeof(wk->op));
+
+	for (size_t i = 0; i < w->num_params; i++) {
+		TEEC_Parameter *param = &wk->op.params[i];
+
+		shm = &wk->shm[i];
+
+		switch (w->mix[i]) {
+		case PARAM_VALUE:
+			types[i] = TEEC_VALUE_INOUT;
+			param->value.a = (uint32_t)i;
+			continue;
+		case PARAM_TEMP:
+			wk->bufs[i] = malloc(w->size ? w->size : 1);
+			if (!wk->bufs[i])
+				return -1;
+
+			memset(wk->bufs[i], 't', w->size);
+			types[i] = TEEC_MEMREF_TEMP_INOUT;
+			param->tmpref.buffer = wk->bufs[i];
+			param->tmpref.size = w->size;
+			continue;
+		case PARAM_WHOLE:
+			types[i] = TEEC_MEMREF_WHOLE;
+			break;
+		case PARAM_PARTIAL:
+			types[i] = TEEC_MEMREF_PARTIAL_INOUT;
+			break;
+		}
+
+		shm->size = w->size;
+		shm->flags = TEEC_MEM_INPUT | TEEC_MEM_OUTPUT;
+
+		if (w->allocate) {
+			result = TEEC_AllocateSharedMemory(wk->ctx, shm);
+		} else {
+			wk->bufs[i] = malloc(w->size ? w->size : 1);
+			if (!wk->bufs[i])
+				return -1;
+
+			shm->buffer = wk->bufs[i];
+			result = TEEC_RegisterSharedMemory(wk->ctx, shm);
+		}
+
+		if (result) {
+			printf("Failed to set up shared memory: 0x%x\n",
+			       result);
+			return -1;
+		}
+
+		memset(shm->buffer, 's', w->size);
+		param->memref.parent = shm;
+		param->memref.size = w->size;
+	}
+
+	wk->op.paramTypes = TEEC_PARAM_TYPES(types[0], types[1], types[2],
+					     types[3]);
+
+	return 0;
+}
+
+static void worker_teardown(struct worker *wk)
+{
+	for (size_t i = 0; i < GP_BENCH_MAX_PARAMS; i++) {
+		if (wk->shm[i].imp.ctx)
+			TEEC_ReleaseSharedMemory(&wk->shm[i]);
+
+		free(wk->bufs[i]);
+	}
+}
+
+static void gate_set(struct gate *gate, int state)
+{
+	pthread_mutex_lock(&gate->lock);
+	gate->state = state;
+	pthread_cond_broadcast(&gate->cond);
+	pthread_mutex_unlock(&gate->lock);
+}
+
+static void *worker_run(void *arg)
+{
+	struct worker *wk = arg;
+	const struct workload *w = wk->w;
+	TEEC_Parameter params[GP_BENCH_MAX_PARAMS];
+	uint32_t origin = 0;
+	uint64_t start;
+	int state;
+
+	memcpy(params, wk->op.params, sizeof(params));
+
+	pthread_mutex_lock(&wk->gate->lock);
+	while (!wk->gate->state)
+		pthread_cond_wait(&wk->gate->cond, &wk->gate->lock);
+	state = wk->gate->state;
+	pthread_mutex_unlock(&wk->gate->lock);
+
+	if (state < 0)
+		return NULL;
+
+	for (size_t i = 0; i < w->warmup + w->iterations; i++) {
+		start = now_ns();
+		if (i == w->warmup)
+			wk->begin = start;
+
+		if (TEEC_InvokeCommand(wk->session, w->command, &wk->op,
+				       &origin))
+			wk->errors++;
+
+		if (i >= w->warmup)
+			wk->ns[i - w->warmup] = now_ns() - start;
+
+		/* Output sizes are updated by each invocation */
+		memcpy(wk->op.params, params, sizeof(params));
+	}
+
+	wk->end = now_ns();
+
+	return NULL;
+}
+
+static void report(const struct workload *w, uint64_t *ns, size_t n,
+		   size_t errors, uint64_t elapsed)
+{
+	uint64_t sum = 0;
+
+	for (size_t i = 0; i < n; i++)
+		sum += ns[i];
+
+	qsort(ns, n, sizeof(*ns), cmp_ns);
+
+	printf("{\n  \"workload\": {\n    \"target\": \"%s\",\n"
+	       "    \"params\": [",
+	       w->local ? "local" : "qtee");
+	for (size_t i = 0; i < w->num_params; i++)
+		printf("%s\"%s\"", i ? ", " : "", param_names[w->mix[i]]);
+	printf("],\n    \"size\": %zu,\n    \"shm\": \"%s\",\n"
+	       "    \"threads\": %u,\n    \"sessions\": %u,\n"
+	       "    \"iterations\": %zu\n  },\n",
+	       w->size, w->allocate ? "allocate" : "register", w->threads,
+	       w->sessions, w->iterations);
+
+	printf("  \"invocations\": %zu,\n  \"errors\": %zu,\n"
+	       "  \"seconds\": %.6f,\n  \"throughput\": %.1f,\n",
+	       n, errors, elapsed / 1e9, n / (elapsed / 1e9));
+
+	printf("  \"latency_ns\": {\n    \"min\": %llu,\n    \"mean\": %llu,\n"
+	       "    \"p50\": %llu,\n    \"p99\": %llu,\n    \"p999\": %llu,\n"
+	       "    \"max\": %llu\n  }\n}\n",
+	       (unsigned long long)ns[0], (unsigned long long)(sum / n),
+	       (unsigned long long)percentile(ns, n, 0.50),
+	       (unsigned long long)percentile(ns, n, 0.99),
+	       (unsigned long long)percentile(ns, n, 0.999),
+	       (unsigned long long)ns[n - 1]);
+}
+
+static void usage(const char *prog)
+{
+	printf("Usage: %s [-p params] [-s size] [-t threads] [-S sessions] "
+	       "[-a] [-q] [-c command] [-n iterations] [-w warmup]\n"
+	       "  -p  comma-separated parameters: value, temp, whole, "
+	       "partial (default temp)\n"
+	       "  -s  size of each memory reference in bytes (default 4096)\n"
+	       "  -t  invoking threads (default 1)\n"
+	       "  -S  sessions the threads share, round robin (default 1)\n"
+	       "  -a  allocate shared memory rather than register it\n"
+	       "  -q  invoke QTEE rather than the local reference TA\n"
+	       "  -c  command ID to invoke (default 0, echo)\n"
+	       "  -n  invocations per thread (default 100000)\n"
+	       "  -w  warmup invocations per thread (default 1000)\n",
+	       prog);
+}
+
+int main(int argc, char *argv[])
+{
+	static const TEEC_UUID uuid = { 0 };
+	struct workload w = {
+		.mix = { PARAM_TEMP },
+		.num_params = 1,
+		.size = 4096,
+		.threads = 1,
+		.sessions = 1,
+		.local = 1,
+		.command = TEEC_LOCAL_TA_CMD_ECHO,
+		.iterations = 100000,
+		.warmup = 1000,
+	};
+	TEEC_Context ctx;
+	TEEC_Session *sessions = NULL;
+	struct worker *workers = NULL;
+	struct gate gate = {
+		.lock = PTHREAD_MUTEX_INITIALIZER,
+		.cond = PTHREAD_COND_INITIALIZER,
+	};
+	uint64_t *ns = NULL;
+	uint64_t begin = UINT64_MAX, end = 0;
+	unsigned int opened = 0, started = 0;
+	size_t errors = 0;
+	uint32_t origin = 0;
+	int opt, ret = -1;
+
+	while ((opt = getopt(argc, argv, "p:s:t:S:aqc:n:w:h")) != -1) {
+		switch (opt) {
+		case 'p':
+			if (parse_mix(optarg, &w)) {
+				usage(argv[0]);
+				return -1;
+			}
+			break;
+		case 's':
+			w.size = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			w.threads = (unsigned int)strtoul(optarg, NULL, 0);
+			break;
+		case 'S':
+			w.sessions = (unsigned int)strtoul(optarg, NULL, 0);
+			break;
+		case 'a':
+			w.allocate = 1;
+			break;
+		case 'q':
+			w.local = 0;
+			break;
+		case 'c':
+			w.command = (uint32_t)strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			w.iterations = strtoul(optarg, NULL, 0);
+			break;
+		case 'w':
+			w.warmup = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+	}
+
+	if (!w.threads || !w.sessions || !w.iterations) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	setenv("MINKTEEC_LOCAL_TA", w.local ? "1" : "0", 1);
+
+	memset(&ctx, 0, sizeof(ctx));
+	if (TEEC_InitializeContext(NULL, &ctx)) {
+		printf("Failed TEEC_InitializeContext\n");
+		return -1;
+	}
+
+	sessions = calloc(w.sessions, sizeof(*sessions));
+	workers = calloc(w.threads, sizeof(*workers));
+	ns = malloc(w.threads * w.iterations * sizeof(*ns));
+	if (!sessions || !workers || !ns) {
+		printf("Out of memory\n");
+		goto err;
+	}
+
+	for (; opened < w.sessions; opened++) {
+		if (TEEC_OpenSession(&ctx, &sessions[opened], &uuid,
+				     TEEC_LOGIN_PUBLIC, NULL, NULL, &origin)) {
+			printf("Failed TEEC_OpenSession\n");
+			goto err;
+		}
+	}
+
+	for (unsigned int t = 0; t < w.threads; t++) {
+		struct worker *wk = &workers[t];
+
+		wk->w = &w;
+		wk->ctx = &ctx;
+		wk->session = &sessions[t % w.sessions];
+		wk->gate = &gate;
+		wk->ns = &ns[t * w.iterations];
+
+		if (worker_setup(wk))
+			goto err_threads;
+	}
+
+	for (; started < w.threads; started++) {
+		if (pthread_create(&workers[started].thread, NULL, worker_run,
+				   &workers[started])) {
+			printf("Failed pthread_create\n");
+			goto err_threads;
+		}
+	}
+
+	gate_set(&gate, 1);
+
+	for (unsigned int t = 0; t < w.threads; t++) {
+		pthread_join(workers[t].thread, NULL);
+		errors += workers[t].errors;
+
+		if (workers[t].begin < begin)
+			begin = workers[t].begin;
+		if (workers[t].end > end)
+			end = workers[t].end;
+	}
+	started = 0;
+
+	report(&w, ns, w.threads * w.iterations, errors, end - begin);
+	ret = errors ? -1 : 0;
+
+err_threads:
+	/* The threads started are still at the gate */
+	gate_set(&gate, -1);
+	for (unsigned int t = 0; t < started; t++)
+		pthread_join(workers[t].thread, NULL);
+
+	for (unsigned int t = 0; t < w.threads; t++)
+		worker_teardown(&workers[t]);
+
+err:
+	for (unsigned int s = 0; s < opened; s++)
+		TEEC_CloseSession(&sessions[s]);
+
+	TEEC_FinalizeContext(&ctx);
+	free(workers);
+	free(sessions);
+	free(ns);
+
+	return ret;
+}
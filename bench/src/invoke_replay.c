@@ -0,0 +1,407 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_shim.h"
+#include "invoke_trace.h"
+#include "MinkCom.h"
+
+/* Replay an invocation trace recorded with MINKCOM_TRACE against the
+ * loopback transport and report the latency distribution of the replay.
+ */
+
+#define REPLAY_MAX_ARGS                                                 \
+	(ObjectCounts_maxBI + ObjectCounts_maxBO + ObjectCounts_maxOI + \
+	 ObjectCounts_maxOO)
+
+struct replay_invoke {
+	struct invoke_trace_record record;
+	uint64_t size[INVOKE_TRACE_MAX_BUFS];
+	uint8_t kind[ObjectCounts_maxOI];
+	void *data[ObjectCounts_maxBI]; /* BI contents, if recorded. */
+};
+
+struct replay_sample {
+	uint32_t op;
+	uint64_t ns;
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* A local object standing in for callback objects sent to QTEE. */
+static int32_t local_invoke(ObjectCxt h, ObjectOp op, ObjectArg *args,
+			    ObjectCounts counts)
+{
+	(void)h;
+	(void)op;
+	(void)args;
+	(void)counts;
+
+	return Object_OK;
+}
+
+static const Object local_object = { local_invoke, NULL };
+
+/**
+ * @brief Read the next invocation from a trace.
+ *
+ * @return 1 if an invocation was read, 0 at the end of the trace and -1 if
+ *         the trace is truncated.
+ */
+static int read_invoke(FILE *fp, struct replay_invoke *inv)
+{
+	struct invoke_trace_record *rec = &inv->record;
+	uint64_t size_out[ObjectCounts_maxBO];
+	size_t n;
+
+	memset(inv, 0, sizeof(*inv));
+
+	n = fread(rec, sizeof(*rec), 1, fp);
+	if (n != 1)
+		return feof(fp) ? 0 : -1;
+
+	n = ObjectCounts_numBuffers(rec->counts);
+	if (fread(inv->size, sizeof(uint64_t), n, fp) != n)
+		return -1;
+
+	n = ObjectCounts_numBO(rec->counts);
+	if (fread(size_out, sizeof(uint64_t), n, fp) != n)
+		return -1;
+
+	n = ObjectCounts_numOI(rec->counts);
+	if (fread(inv->kind, sizeof(uint8_t), n, fp) != n)
+		return -1;
+
+	for (size_t i = 0; i < ObjectCounts_numBI(rec->counts); i++) {
+		inv->data[i] = calloc(1, inv->size[i] ? inv->size[i] : 1);
+		if (!inv->data[i])
+			return -1;
+
+		if (!(rec->flags & INVOKE_TRACE_F_BUFFERS))
+			continue;
+
+		if (fread(inv->data[i], 1, inv->size[i], fp) != inv->size[i])
+			return -1;
+	}
+
+	return 1;
+}
+
+static void free_invoke(struct replay_invoke *inv)
+{
+	for (size_t i = 0; i < ObjectCounts_maxBI; i++)
+		free(inv->data[i]);
+}
+
+/**
+ * @brief Replay one invocation on a remote object.
+ *
+ * @return Time spent in Object_invoke(), in nanoseconds.
+ */
+static uint64_t replay_invoke(Object root, Object target,
+			      struct replay_invoke *inv, void *bo_buf)
+{
+	ObjectCounts counts = inv->record.counts;
+	ObjectArg args[REPLAY_MAX_ARGS];
+	uint64_t start, end;
+	size_t i = 0;
+
+	for (size_t n = 0; n < ObjectCounts_numBI(counts); n++, i++) {
+		args[i].b.ptr = inv->data[n];
+		args[i].b.size = inv->size[i];
+	}
+
+	for (size_t n = 0; n < ObjectCounts_numBO(counts); n++, i++) {
+		args[i].b.ptr = bo_buf;
+		args[i].b.size = inv->size[i];
+	}
+
+	for (size_t n = 0; n < ObjectCounts_numOI(counts); n++, i++) {
+		switch (inv->kind[n]) {
+		case INVOKE_TRACE_OBJECT_REMOTE:
+			args[i].o = bench_remote_object(root);
+			break;
+		case INVOKE_TRACE_OBJECT_LOCAL:
+			args[i].o = local_object;
+			break;
+		default:
+			args[i].o = Object_NULL;
+			break;
+		}
+	}
+
+	for (size_t n = 0; n < ObjectCounts_numOO(counts); n++, i++)
+		args[i].o = Object_NULL;
+
+	fake_qcomtee_set_invoke_delay(inv->record.tee_ns);
+
+	start = now_ns();
+	Object_invoke(target, inv->record.op, args, counts);
+	end = now_ns();
+
+	for (i = ObjectCounts_indexOO(counts); i < ObjectCounts_total(counts);
+	     i++)
+		Object_ASSIGN_NULL(args[i].o);
+
+	return end - start;
+}
+
+static int cmp_sample(const void *a, const void *b)
+{
+	const struct replay_sample *x = a, *y = b;
+
+	if (x->op != y->op)
+		return x->op < y->op ? -1 : 1;
+
+	return (x->ns > y->ns) - (x->ns < y->ns);
+}
+
+static int cmp_ns(const void *a, const void *b)
+{
+	const uint64_t *x = a, *y = b;
+
+	return (*x > *y) - (*x < *y);
+}
+
+static uint64_t percentile(uint64_t *ns, size_t n, double p)
+{
+	size_t i = (size_t)(p * (n - 1) + 0.5);
+
+	return ns[i];
+}
+
+static void print_stats(const char *name, uint64_t *ns, size_t n)
+{
+	uint64_t sum = 0;
+
+	for (size_t i = 0; i < n; i++)
+		sum += ns[i];
+
+	printf("%-12s %10zu %10llu %10llu %10llu %10llu %10llu %10llu %10llu\n",
+	       name, n, (unsigned long long)ns[0],
+	       (unsigned long long)(sum / n),
+	       (unsigned long long)percentile(ns, n, 0.50),
+	       (unsigned long long)percentile(ns, n, 0.90),
+	       (unsigned long long)percentile(ns, n, 0.99),
+	       (unsigned long long)percentile(ns, n, 0.999),
+	       (unsigned long long)ns[n - 1]);
+}
+
+/**
+ * @brief Print the latency distribution, overall and per operation.
+ */
+static void report(struct replay_sample *samples, size_t n)
+{
+	uint64_t *ns = malloc(n * sizeof(*ns));
+	char name[16];
+	size_t first = 0;
+
+	if (!ns)
+		return;
+
+	printf("%-12s %10s %10s %10s %10s %10s %10s %10s %10s\n", "op (ns)",
+	       "count", "min", "mean", "p50", "p90", "p99", "p99.9", "max");
+
+	for (size_t i = 0; i < n; i++)
+		ns[i] = samples[i].ns;
+
+	qsort(ns, n, sizeof(*ns), cmp_ns);
+	print_stats("all", ns, n);
+
+	qsort(samples, n, sizeof(*samples), cmp_sample);
+	for (size_t i = 1; i <= n; i++) {
+		if (i < n && samples[i].op == samples[first].op)
+			continue;
+
+		for (size_t j = first; j < i; j++)
+			ns[j - first] = samples[j].ns;
+
+		snprintf(name, sizeof(name), "0x%x", samples[first].op);
+		print_stats(name, ns, i - first);
+		first = i;
+	}
+
+	free(ns);
+}
+
+static void usage(const char *prog)
+{
+	printf("Usage: %s [-p] [-e] [-r] [-n repeat] [-o latencies] trace\n"
+	       "  -p  pace invocations as recorded\n"
+	       "  -e  emulate the recorded time spent in QTEE\n"
+	       "  -r  report the recorded latencies, do not replay\n"
+	       "  -n  replay the trace this many times\n"
+	       "  -o  write each latency to a file, one per line\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+	struct invoke_trace_header header;
+	struct replay_invoke inv;
+	struct replay_sample *samples = NULL;
+	size_t num = 0, cap = 0;
+	int pace = 0, emulate = 0, recorded = 0, repeat = 1;
+	const char *out_path = NULL;
+	FILE *fp = NULL, *out = NULL;
+	Object root = Object_NULL, target = Object_NULL;
+	void *bo_buf = NULL;
+	size_t bo_cap = 0;
+	int opt, ret = -1;
+
+	while ((opt = getopt(argc, argv, "pern:o:h")) != -1) {
+		switch (opt) {
+		case 'p':
+			pace = 1;
+			break;
+		case 'e':
+			emulate = 1;
+			break;
+		case 'r':
+			recorded = 1;
+			break;
+		case 'n':
+			repeat = atoi(optarg);
+			break;
+		case 'o':
+			out_path = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+	}
+
+	if (optind >= argc || repeat < 1) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	fp = fopen(argv[optind], "rb");
+	if (!fp) {
+		printf("Failed to open %s\n", argv[optind]);
+		return -1;
+	}
+
+	if (fread(&header, sizeof(header), 1, fp) != 1 ||
+	    header.magic != INVOKE_TRACE_MAGIC ||
+	    header.version != INVOKE_TRACE_VERSION) {
+		printf("%s is not an invoke trace\n", argv[optind]);
+		goto err;
+	}
+
+	if (out_path) {
+		out = fopen(out_path, "w");
+		if (!out) {
+			printf("Failed to open %s\n", out_path);
+			goto err;
+		}
+	}
+
+	if (MinkCom_getRootEnvObject(&root)) {
+		printf("Failed MinkCom_getRootEnvObject\n");
+		goto err;
+	}
+
+	/* The loopback transport does not care which object is invoked. */
+	target = bench_remote_object(root);
+
+	for (int r = 0; r < repeat; r++) {
+		uint64_t base = now_ns();
+		int status;
+
+		fseek(fp, sizeof(header), SEEK_SET);
+
+		while ((status = read_invoke(fp, &inv)) > 0) {
+			ObjectCounts counts = inv.record.counts;
+			uint64_t ns = inv.record.total_ns;
+			size_t bo_size = 1;
+
+			for (size_t i = 0; i < ObjectCounts_numBO(counts); i++) {
+				size_t size = inv.size[ObjectCounts_indexBO(counts) + i];
+
+				if (size > bo_size)
+					bo_size = size;
+			}
+
+			if (!recorded && bo_size > bo_cap) {
+				void *buf = realloc(bo_buf, bo_size);
+				if (!buf) {
+					free_invoke(&inv);
+					goto err;
+				}
+				bo_buf = buf;
+				bo_cap = bo_size;
+			}
+
+			if (!recorded) {
+				while (pace && now_ns() - base < inv.record.start_ns)
+					;
+
+				if (!emulate)
+					inv.record.tee_ns = 0;
+
+				ns = replay_invoke(root, target, &inv, bo_buf);
+			}
+
+			free_invoke(&inv);
+
+			if (num == cap) {
+				struct replay_sample *s;
+
+				cap = cap ? cap * 2 : 1024;
+				s = realloc(samples, cap * sizeof(*s));
+				if (!s)
+					goto err;
+				samples = s;
+			}
+
+			samples[num].op = inv.record.op;
+			samples[num].ns = ns;
+			num++;
+
+			if (out)
+				fprintf(out, "%llu\n", (unsigned long long)ns);
+		}
+
+		if (status < 0) {
+			free_invoke(&inv);
+			printf("Truncated trace %s\n", argv[optind]);
+			goto err;
+		}
+
+		/* The recorded latencies do not change between repeats. */
+		if (recorded)
+			break;
+	}
+
+	if (!num) {
+		printf("Empty trace %s\n", argv[optind]);
+		goto err;
+	}
+
+	report(samples, num);
+	ret = 0;
+
+err:
+	Object_ASSIGN_NULL(target);
+	Object_ASSIGN_NULL(root);
+	free(samples);
+	free(bo_buf);
+	if (out)
+		fclose(out);
+	fclose(fp);
+
+	return ret;
+}
@@ -0,0 +1,944 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench_shim.h"
+#include "MinkCom.h"
+#include "tee_client_api_ext.h"
+
+namespace
+{
+
+/* ''Fixtures''. */
+
+/* A local MINK object, as implemented by a callback object provider. */
+int32_t local_invoke(ObjectCxt h, ObjectOp op, ObjectArg *args,
+		     ObjectCounts counts)
+{
+	(void)h;
+	(void)args;
+	(void)counts;
+
+	switch (ObjectOp_methodID(op)) {
+	case Object_OP_retain:
+	case Object_OP_release:
+		return Object_OK;
+	default:
+		/* Nothing to do, output buffers are returned as they are. */
+		return Object_OK;
+	}
+}
+
+const Object local_object = { local_invoke, nullptr };
+
+Object root_object()
+{
+	static Object root = Object_NULL;
+
+	if (Object_isNull(root) && MinkCom_getRootEnvObject(&root))
+		std::abort();
+
+	return root;
+}
+
+/* Set up a MINK argument list of BI, BO, OI and OO arguments; OI arguments
+ * alternate between remote (QTEE) and local (callback) objects as requested.
+ */
+struct ArgList {
+	std::vector<ObjectArg> args;
+	std::vector<std::vector<char> > bufs;
+	std::vector<Object> remotes;
+	ObjectCounts counts;
+
+	ArgList(size_t bi, size_t bo, size_t oi_remote, size_t oi_local,
+		size_t oo, size_t buf_size)
+		: args(bi + bo + oi_remote + oi_local + oo),
+		  counts(ObjectCounts_pack(bi, bo, oi_remote + oi_local, oo))
+	{
+		size_t i = 0;
+
+		for (size_t n = 0; n < bi + bo; n++, i++) {
+			bufs.emplace_back(buf_size, 'm');
+			args[i].b.ptr = bufs.back().data();
+			args[i].b.size = buf_size;
+		}
+
+		for (size_t n = 0; n < oi_remote; n++, i++) {
+			remotes.push_back(bench_remote_object(root_object()));
+			args[i].o = remotes.back();
+		}
+
+		for (size_t n = 0; n < oi_local; n++, i++)
+			args[i].o = local_object;
+
+		for (size_t n = 0; n < oo; n++, i++)
+			args[i].o = Object_NULL;
+	}
+
+	~ArgList()
+	{
+		for (Object &o : remotes)
+			Object_release(o);
+	}
+};
+
+/* Set up a QCOMTEE parameter list as received from QTEE. */
+struct ParamList {
+	std::vector<qcomtee_param> params;
+	std::vector<std::vector<char> > bufs;
+
+	ParamList(size_t bi, size_t bo, size_t oi, size_t oo, size_t buf_size)
+		: params(bi + bo + oi + oo)
+	{
+		size_t i = 0;
+
+		for (size_t n = 0; n < bi; n++, i++) {
+			bufs.emplace_back(buf_size, 'q');
+			params[i].attr = QCOMTEE_UBUF_INPUT;
+			params[i].ubuf.addr = bufs.back().data();
+			params[i].ubuf.size = buf_size;
+		}
+
+		for (size_t n = 0; n < bo; n++, i++) {
+			params[i].attr = QCOMTEE_UBUF_OUTPUT;
+			params[i].ubuf.addr = nullptr;
+			params[i].ubuf.size = buf_size;
+		}
+
+		for (size_t n = 0; n < oi; n++, i++) {
+			params[i].attr = QCOMTEE_OBJREF_INPUT;
+			params[i].object = bench_callback_object(root_object(),
+								 local_object);
+		}
+
+		for (size_t n = 0; n < oo; n++, i++) {
+			params[i].attr = QCOMTEE_OBJREF_OUTPUT;
+			params[i].object = QCOMTEE_OBJECT_NULL;
+		}
+	}
+
+	~ParamList()
+	{
+		bench_release_qcomtee_objs(params.data(), params.size(),
+					   QCOMTEE_OBJREF_INPUT);
+	}
+
+	uint32_t size() const
+	{
+		return static_cast<uint32_t>(params.size());
+	}
+};
+
+/* Report allocations per iteration alongside the default ns/op. */
+class AllocCounter
+{
+    public:
+	explicit AllocCounter(benchmark::State &state)
+		: state_(state), start_(bench_alloc_count())
+	{
+	}
+
+	~AllocCounter()
+	{
+		state_.counters["allocs/op"] = benchmark::Counter(
+			static_cast<double>(bench_alloc_count() - start_),
+			benchmark::Counter::kAvgIterations);
+	}
+
+    private:
+	benchmark::State &state_;
+	uint64_t start_;
+};
+
+/* ''Mink Adaptor''. */
+
+/* Args: number of parameters, cycling through BI, BO, OI and OO. */
+void BM_GetObjCounts(benchmark::State &state)
+{
+	size_t num = static_cast<size_t>(state.range(0));
+	std::vector<qcomtee_param> params(num);
+	const uint64_t attrs[] = { QCOMTEE_UBUF_INPUT, QCOMTEE_UBUF_OUTPUT,
+				   QCOMTEE_OBJREF_INPUT,
+				   QCOMTEE_OBJREF_OUTPUT };
+
+	for (size_t i = 0; i < num; i++)
+		params[i].attr = attrs[i % 4];
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		ObjectCounts counts = bench_get_obj_counts(
+			params.data(), static_cast<uint32_t>(num));
+		benchmark::DoNotOptimize(counts);
+	}
+}
+BENCHMARK(BM_GetObjCounts)->Arg(1)->Arg(4)->Arg(16)->Arg(60);
+
+/* Args: BI, BO, remote OI, local OI, OO. */
+void BM_ObjectArgsToTeeParams(benchmark::State &state)
+{
+	ArgList list(state.range(0), state.range(1), state.range(2),
+		     state.range(3), state.range(4), 64);
+	std::vector<qcomtee_param> params(list.args.size());
+	struct qcomtee_object *root =
+		static_cast<struct qcomtee_object *>(root_object().context);
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		if (bench_object_args_to_tee_params(list.args.data(),
+						    list.counts,
+						    params.data(), root))
+			state.SkipWithError("object_args_to_tee_params failed");
+
+		/* Drop the references QTEE would have consumed. */
+		state.PauseTiming();
+		for (Object &o : list.remotes)
+			Object_retain(o);
+		state.ResumeTiming();
+		bench_release_qcomtee_objs(params.data(), params.size(),
+					   QCOMTEE_OBJREF_INPUT);
+	}
+}
+BENCHMARK(BM_ObjectArgsToTeeParams)
+	->ArgNames({ "bi", "bo", "oi_remote", "oi_local", "oo" })
+	->Args({ 1, 1, 0, 0, 0 })
+	->Args({ 4, 4, 0, 0, 0 })
+	->Args({ 15, 15, 0, 0, 0 })
+	->Args({ 1, 1, 2, 0, 1 })
+	->Args({ 1, 1, 0, 2, 1 })
+	->Args({ 2, 2, 4, 4, 4 })
+	->Args({ 0, 0, 0, 15, 0 });
+
+/* Args: BI, BO, OO. */
+void BM_ObjectArgsFromTeeParams(benchmark::State &state)
+{
+	size_t bi = state.range(0), bo = state.range(1), oo = state.range(2);
+	ArgList list(bi, bo, 0, 0, oo, 64);
+	ParamList params(bi, bo, 0, 0, 64);
+
+	params.params.resize(list.args.size());
+	for (size_t i = bi + bo; i < list.args.size(); i++) {
+		params.params[i].attr = QCOMTEE_OBJREF_OUTPUT;
+		params.params[i].object = static_cast<struct qcomtee_object *>(
+			root_object().context);
+	}
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		if (bench_object_args_from_tee_params(params.params.data(),
+						      list.args.data(),
+						      list.counts))
+			state.SkipWithError("object_args_from_tee_params failed");
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_ObjectArgsFromTeeParams)
+	->ArgNames({ "bi", "bo", "oo" })
+	->Args({ 1, 1, 0 })
+	->Args({ 4, 4, 0 })
+	->Args({ 15, 15, 0 })
+	->Args({ 1, 1, 4 })
+	->Args({ 0, 0, 15 });
+
+/* Args: BI, BO, OI, buffer size. */
+void BM_ObjectArgsFromTeeParamsCb(benchmark::State &state)
+{
+	size_t bo = state.range(1);
+	ParamList params(state.range(0), bo, state.range(2), 0,
+			 state.range(3));
+	std::vector<ObjectArg> args(params.size());
+	void *allocated_bo[ObjectCounts_maxBO] = { nullptr };
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		if (bench_object_args_from_tee_params_cb(params.params.data(),
+							 params.size(),
+							 args.data(),
+							 allocated_bo))
+			state.SkipWithError("object_args_from_tee_params_cb failed");
+
+		/* The callback cleanup frees the BO buffers. */
+		for (size_t i = 0; i < bo; i++) {
+			std::free(allocated_bo[i]);
+			allocated_bo[i] = nullptr;
+		}
+	}
+}
+BENCHMARK(BM_ObjectArgsFromTeeParamsCb)
+	->ArgNames({ "bi", "bo", "oi", "size" })
+	->ArgsProduct({ { 1, 4 }, { 0, 1, 4 }, { 0, 2 },
+			{ 64, 4096, 65536 } });
+
+/* A complete callback request: QTEE invoking a local object through its
+ * QCOMTEE callback wrapper.
+ *
+ * Args: BI, BO, buffer size.
+ */
+void BM_CallbackDispatch(benchmark::State &state)
+{
+	ParamList params(state.range(0), state.range(1), 0, 0, state.range(2));
+	struct qcomtee_object *cbo =
+		bench_callback_object(root_object(), local_object);
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		if (fake_qcomtee_dispatch(cbo, 0, params.params.data(),
+					  params.size()))
+			state.SkipWithError("dispatch failed");
+
+		/* Requests always carry UBUF_OUTPUT with a NULL address. */
+		for (qcomtee_param &p : params.params)
+			if (p.attr == QCOMTEE_UBUF_OUTPUT)
+				p.ubuf.addr = nullptr;
+	}
+
+	qcomtee_object_refs_dec(cbo);
+}
+BENCHMARK(BM_CallbackDispatch)
+	->ArgNames({ "bi", "bo", "size" })
+	->ArgsProduct({ { 1, 4 }, { 0, 1, 4 }, { 64, 4096, 65536 } });
+
+/* A complete outbound invocation over the loopback transport.
+ *
+ * Args: BI, BO, remote OI, local OI, OO.
+ */
+void BM_InvokeOverTee(benchmark::State &state)
+{
+	ArgList list(state.range(0), state.range(1), state.range(2),
+		     state.range(3), state.range(4), 64);
+	Object target = bench_remote_object(root_object());
+	size_t oo_index = ObjectCounts_indexOO(list.counts);
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		/* QTEE consumes a reference to each remote OI. */
+		state.PauseTiming();
+		for (Object &o : list.remotes)
+			Object_retain(o);
+		state.ResumeTiming();
+
+		if (Object_invoke(target, 0, list.args.data(), list.counts))
+			state.SkipWithError("Object_invoke failed");
+
+		for (size_t i = oo_index; i < list.args.size(); i++)
+			Object_ASSIGN_NULL(list.args[i].o);
+	}
+
+	Object_release(target);
+}
+BENCHMARK(BM_InvokeOverTee)
+	->ArgNames({ "bi", "bo", "oi_remote", "oi_local", "oo" })
+	->Args({ 0, 0, 0, 0, 0 })
+	->Args({ 1, 1, 0, 0, 0 })
+	->Args({ 4, 4, 0, 0, 0 })
+	->Args({ 1, 1, 2, 0, 1 })
+	->Args({ 1, 1, 0, 2, 1 })
+	->Args({ 2, 2, 4, 4, 4 });
+
+/* ''Mink TEEC''. */
+
+enum ParamMix {
+	MIX_VALUE = 0, /* 4 x VALUE_INOUT */
+	MIX_TEMP, /* 4 x MEMREF_TEMP_INOUT */
+	MIX_WHOLE, /* 4 x MEMREF_WHOLE, distinct registered memories */
+	MIX_PARTIAL, /* 4 x MEMREF_PARTIAL_INOUT, one registered memory */
+	MIX_ALLOCATED, /* 4 x MEMREF_PARTIAL_INOUT, one allocated memory */
+	MIX_MIXED, /* VALUE, TEMP, WHOLE and PARTIAL sharing one memory */
+	MIX_WINDOW, /* 1 x MEMREF_PARTIAL_INOUT of 64 bytes, registered memory */
+};
+
+struct TeecFixture {
+	TEEC_Context ctx;
+	TEEC_Operation op;
+	std::vector<TEEC_SharedMemory> shm;
+	std::vector<std::vector<char> > bufs;
+	size_t bytes; /* Memory referenced by the operation. */
+
+	TeecFixture(int mix, size_t size) : shm(MAX_NUM_PARAMS), bytes(0)
+	{
+		std::memset(&ctx, 0, sizeof(ctx));
+		std::memset(&op, 0, sizeof(op));
+
+		if (TEEC_InitializeContext(nullptr, &ctx))
+			std::abort();
+
+		for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+			bufs.emplace_back(size, 't');
+			std::memset(&shm[i], 0, sizeof(shm[i]));
+			shm[i].buffer = bufs[i].data();
+			shm[i].size = size;
+			shm[i].flags = TEEC_MEM_INPUT | TEEC_MEM_OUTPUT;
+		}
+
+		switch (mix) {
+		case MIX_VALUE:
+			op.paramTypes = TEEC_PARAM_TYPES(
+				TEEC_VALUE_INOUT, TEEC_VALUE_INOUT,
+				TEEC_VALUE_INOUT, TEEC_VALUE_INOUT);
+			break;
+		case MIX_TEMP:
+			op.paramTypes = TEEC_PARAM_TYPES(
+				TEEC_MEMREF_TEMP_INOUT, TEEC_MEMREF_TEMP_INOUT,
+				TEEC_MEMREF_TEMP_INOUT, TEEC_MEMREF_TEMP_INOUT);
+			for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+				op.params[i].tmpref.buffer = bufs[i].data();
+				op.params[i].tmpref.size = size;
+			}
+			bytes = size * MAX_NUM_PARAMS;
+			break;
+		case MIX_WHOLE:
+			op.paramTypes = TEEC_PARAM_TYPES(
+				TEEC_MEMREF_WHOLE, TEEC_MEMREF_WHOLE,
+				TEEC_MEMREF_WHOLE, TEEC_MEMREF_WHOLE);
+			for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+				register_shm(i);
+				op.params[i].memref.parent = &shm[i];
+			}
+			bytes = size * MAX_NUM_PARAMS;
+			break;
+		case MIX_PARTIAL:
+		case MIX_ALLOCATED:
+			op.paramTypes = TEEC_PARAM_TYPES(
+				TEEC_MEMREF_PARTIAL_INOUT,
+				TEEC_MEMREF_PARTIAL_INOUT,
+				TEEC_MEMREF_PARTIAL_INOUT,
+				TEEC_MEMREF_PARTIAL_INOUT);
+			if (mix == MIX_PARTIAL)
+				register_shm(0);
+			else
+				allocate_shm(0);
+			for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+				op.params[i].memref.parent = &shm[0];
+				op.params[i].memref.offset =
+					i * (size / MAX_NUM_PARAMS);
+				op.params[i].memref.size = size / MAX_NUM_PARAMS;
+			}
+			bytes = size;
+			break;
+		case MIX_MIXED:
+			op.paramTypes = TEEC_PARAM_TYPES(
+				TEEC_VALUE_INOUT, TEEC_MEMREF_TEMP_INOUT,
+				TEEC_MEMREF_WHOLE, TEEC_MEMREF_PARTIAL_INOUT);
+			op.params[1].tmpref.buffer = bufs[1].data();
+			op.params[1].tmpref.size = size;
+			register_shm(0);
+			op.params[2].memref.parent = &shm[0];
+			op.params[3].memref.parent = &shm[0];
+			op.params[3].memref.offset = size / 2;
+			op.params[3].memref.size = size / 2;
+			bytes = size * 2 + size / 2;
+			break;
+		case MIX_WINDOW:
+			op.paramTypes = TEEC_PARAM_TYPES(
+				TEEC_MEMREF_PARTIAL_INOUT, TEEC_NONE,
+				TEEC_NONE, TEEC_NONE);
+			register_shm(0);
+			op.params[0].memref.parent = &shm[0];
+			op.params[0].memref.offset = size / 2;
+			op.params[0].memref.size = std::min<size_t>(size / 2, 64);
+			bytes = op.params[0].memref.size;
+			break;
+		default:
+			std::abort();
+		}
+	}
+
+	~TeecFixture()
+	{
+		for (TEEC_SharedMemory &s : shm)
+			if (s.imp.ctx)
+				TEEC_ReleaseSharedMemory(&s);
+
+		TEEC_FinalizeContext(&ctx);
+	}
+
+	void register_shm(size_t i)
+	{
+		if (TEEC_RegisterSharedMemory(&ctx, &shm[i]))
+			std::abort();
+	}
+
+	void allocate_shm(size_t i)
+	{
+		shm[i].buffer = nullptr;
+		if (TEEC_AllocateSharedMemory(&ctx, &shm[i]))
+			std::abort();
+	}
+
+	/* Output sizes are updated in-place by each invocation. */
+	void reset_sizes(size_t size)
+	{
+		for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+			uint32_t type = TEEC_PARAM_TYPE_GET(op.paramTypes, i);
+
+			if (type == TEEC_MEMREF_TEMP_INOUT)
+				op.params[i].tmpref.size = size;
+			else if (type == TEEC_MEMREF_WHOLE)
+				op.params[i].memref.size = size;
+		}
+	}
+};
+
+/* Args: parameter mix, buffer size. */
+void BM_MinkParamsFromTeecParams(benchmark::State &state)
+{
+	TeecFixture f(state.range(0), state.range(1));
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		uint32_t etypes = bench_mink_params_from_teec_params(
+			f.op.paramTypes, f.op.params);
+		benchmark::DoNotOptimize(etypes);
+	}
+}
+BENCHMARK(BM_MinkParamsFromTeecParams)
+	->ArgNames({ "mix", "size" })
+	->ArgsProduct({ { MIX_VALUE, MIX_TEMP, MIX_WHOLE, MIX_PARTIAL,
+			  MIX_ALLOCATED, MIX_MIXED },
+			{ 64, 4096, 65536, 1 << 20 } });
+
+/* Args: parameter mix, buffer size. */
+void BM_TeecMarshal(benchmark::State &state)
+{
+	size_t size = state.range(1);
+	TeecFixture f(state.range(0), size);
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		if (bench_teec_marshal(&f.ctx, &f.op))
+			state.SkipWithError("marshalling failed");
+
+		f.reset_sizes(size);
+	}
+	state.SetBytesProcessed(state.iterations() * f.bytes);
+}
+BENCHMARK(BM_TeecMarshal)
+	->ArgNames({ "mix", "size" })
+	->ArgsProduct({ { MIX_VALUE, MIX_TEMP, MIX_WHOLE, MIX_PARTIAL,
+			  MIX_ALLOCATED, MIX_MIXED, MIX_WINDOW },
+			{ 64, 4096, 65536, 1 << 20 } });
+
+/* As BM_TeecMarshal, with registered memory copied rather than shared in
+ * place, as when QCOMTEE cannot register client memory.
+ *
+ * Args: parameter mix, buffer size.
+ */
+void BM_TeecMarshalCopy(benchmark::State &state)
+{
+	fake_qcomtee_set_register_memory(0);
+	BM_TeecMarshal(state);
+	fake_qcomtee_set_register_memory(1);
+}
+BENCHMARK(BM_TeecMarshalCopy)
+	->ArgNames({ "mix", "size" })
+	->ArgsProduct({ { MIX_TEMP, MIX_WHOLE, MIX_PARTIAL, MIX_MIXED,
+			  MIX_WINDOW },
+			{ 65536, 1 << 20 } });
+
+/* TEEC_AllocateSharedMemory() and TEEC_ReleaseSharedMemory() of one buffer,
+ * with the given number of other buffers allocated.
+ *
+ * Args: buffer size, live buffers.
+ */
+void BM_TeecAllocateSharedMemory(benchmark::State &state)
+{
+	TeecFixture f(MIX_VALUE, 0);
+	std::vector<TEEC_SharedMemory> live(state.range(1));
+	TEEC_SharedMemory shm;
+
+	for (TEEC_SharedMemory &s : live) {
+		std::memset(&s, 0, sizeof(s));
+		s.size = state.range(0);
+		if (TEEC_AllocateSharedMemory(&f.ctx, &s))
+			std::abort();
+	}
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		std::memset(&shm, 0, sizeof(shm));
+		shm.size = state.range(0);
+		if (TEEC_AllocateSharedMemory(&f.ctx, &shm))
+			state.SkipWithError("TEEC_AllocateSharedMemory failed");
+
+		TEEC_ReleaseSharedMemory(&shm);
+	}
+
+	for (TEEC_SharedMemory &s : live)
+		TEEC_ReleaseSharedMemory(&s);
+}
+BENCHMARK(BM_TeecAllocateSharedMemory)
+	->ArgNames({ "size", "live" })
+	->ArgsProduct({ { 64, 4096, 65536 }, { 0, 64 } });
+
+/* A complete TEEC_InvokeCommand() over the loopback transport, or
+ * TEEC_InvokePrepared() of the operation prepared once.
+ *
+ * Args: parameter mix, buffer size, prepared.
+ */
+void BM_TeecInvoke(benchmark::State &state)
+{
+	static const TEEC_UUID uuid = {};
+	TeecFixture f(state.range(0), state.range(1));
+	TEEC_Parameter params[MAX_NUM_PARAMS];
+	TEEC_PreparedOperation prepared;
+	TEEC_Session session;
+	bool prepare = state.range(2);
+	uint32_t origin;
+
+	if (TEEC_OpenSession(&f.ctx, &session, &uuid, TEEC_LOGIN_PUBLIC,
+			     nullptr, nullptr, &origin))
+		std::abort();
+
+	if (prepare && TEEC_PrepareOperation(&session, &f.op, &prepared))
+		std::abort();
+
+	/* The loopback transport does not report output sizes. */
+	std::memcpy(params, f.op.params, sizeof(params));
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		TEEC_Result result =
+			prepare ? TEEC_InvokePrepared(&prepared, 0, &origin) :
+				  TEEC_InvokeCommand(&session, 0, &f.op,
+						     &origin);
+		if (result)
+			state.SkipWithError("invocation failed");
+
+		std::memcpy(f.op.params, params, sizeof(params));
+	}
+	state.SetBytesProcessed(state.iterations() * f.bytes);
+
+	if (prepare)
+		TEEC_ReleasePreparedOperation(&prepared);
+
+	TEEC_CloseSession(&session);
+}
+BENCHMARK(BM_TeecInvoke)
+	->ArgNames({ "mix", "size", "prepared" })
+	->ArgsProduct({ { MIX_VALUE, MIX_TEMP, MIX_WHOLE, MIX_PARTIAL,
+			  MIX_ALLOCATED, MIX_MIXED },
+			{ 64, 4096, 65536 },
+			{ 0, 1 } });
+
+/* A no-op TEEC_InvokeCommand() from a number of threads sharing one context
+ * and session, each with its own operation. The invocations per second grow
+ * with the threads, up to the number of cores, unless the threads contend in
+ * the library.
+ */
+void BM_TeecInvokeThreads(benchmark::State &state)
+{
+	static const TEEC_UUID uuid = {};
+	static TeecFixture *f;
+	static TEEC_Session session;
+	TEEC_Operation op;
+	uint32_t origin;
+
+	if (state.thread_index() == 0) {
+		f = new TeecFixture(MIX_VALUE, 0);
+		if (TEEC_OpenSession(&f->ctx, &session, &uuid,
+				     TEEC_LOGIN_PUBLIC, nullptr, nullptr,
+				     &origin))
+			std::abort();
+	}
+
+	std::memset(&op, 0, sizeof(op));
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INOUT, TEEC_NONE,
+					 TEEC_NONE, TEEC_NONE);
+
+	for (auto _ : state) {
+		if (TEEC_InvokeCommand(&session, 0, &op, &origin))
+			state.SkipWithError("TEEC_InvokeCommand failed");
+	}
+	state.SetItemsProcessed(state.iterations());
+
+	if (state.thread_index() == 0) {
+		TEEC_CloseSession(&session);
+		delete f;
+	}
+}
+BENCHMARK(BM_TeecInvokeThreads)->ThreadRange(1, 64)->UseRealTime();
+
+/* TEEC_OpenSession() and TEEC_CloseSession() of one session, with or without
+ * a session pool, and with a health check of pooled sessions.
+ *
+ * Args: pool, health check.
+ */
+void BM_TeecOpenSession(benchmark::State &state)
+{
+	static const TEEC_UUID uuid = {};
+	TeecFixture f(MIX_VALUE, 0);
+	TEEC_SessionPoolConfig config = {};
+	TEEC_Session session;
+	uint32_t origin;
+
+	config.maxSessions = state.range(0) ? 4 : 0;
+	config.maxIdleTime = TEEC_TIMEOUT_INFINITE;
+	config.flags = state.range(1) ? TEEC_SESSION_POOL_HEALTH_CHECK : 0;
+	if (TEEC_ConfigureSessionPool(&f.ctx, &config))
+		std::abort();
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		if (TEEC_OpenSession(&f.ctx, &session, &uuid,
+				     TEEC_LOGIN_PUBLIC, nullptr, nullptr,
+				     &origin))
+			state.SkipWithError("TEEC_OpenSession failed");
+
+		TEEC_CloseSession(&session);
+	}
+}
+BENCHMARK(BM_TeecOpenSession)
+	->ArgNames({ "pool", "check" })
+	->Args({ 0, 0 })
+	->Args({ 1, 0 })
+	->Args({ 1, 1 });
+
+/* TEEC_InitializeContext() and TEEC_FinalizeContext() of one context, with
+ * or without a context pool.
+ *
+ * Args: pool.
+ */
+void BM_TeecInitializeContext(benchmark::State &state)
+{
+	TEEC_ContextPoolConfig config = {};
+	TEEC_Context ctx;
+
+	config.maxContexts = state.range(0) ? 1 : 0;
+	if (TEEC_ConfigureContextPool(&config))
+		std::abort();
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		if (TEEC_InitializeContext(nullptr, &ctx))
+			state.SkipWithError("TEEC_InitializeContext failed");
+
+		TEEC_FinalizeContext(&ctx);
+	}
+
+	TEEC_ConfigureContextPool(nullptr);
+}
+BENCHMARK(BM_TeecInitializeContext)->ArgName("pool")->Arg(0)->Arg(1);
+
+/* One command invoked in several sessions with a 64 KiB temporary input
+ * memory reference to the same buffer, by TEEC_InvokeCommandMulti() or by
+ * one TEEC_InvokeCommand() per session in turn.
+ *
+ * Args: sessions, multi.
+ */
+void BM_TeecInvokeMulti(benchmark::State &state)
+{
+	static const TEEC_UUID uuid = {};
+	const size_t num = (size_t)state.range(0);
+	std::vector<char> input(64 << 10, 'm');
+	std::vector<TEEC_Session> sessions(num);
+	std::vector<TEEC_Session *> session_ptrs(num);
+	std::vector<TEEC_Operation> ops(num);
+	std::vector<TEEC_Operation *> op_ptrs(num);
+	std::vector<TEEC_Result> results(num);
+	TeecFixture f(MIX_VALUE, 0);
+	uint32_t origin;
+
+	for (size_t i = 0; i < num; i++) {
+		if (TEEC_OpenSession(&f.ctx, &sessions[i], &uuid,
+				     TEEC_LOGIN_PUBLIC, nullptr, nullptr,
+				     &origin))
+			std::abort();
+
+		std::memset(&ops[i], 0, sizeof(ops[i]));
+		ops[i].paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_TEMP_INPUT,
+						     TEEC_VALUE_INOUT, TEEC_NONE,
+						     TEEC_NONE);
+		ops[i].params[0].tmpref.buffer = input.data();
+		ops[i].params[0].tmpref.size = input.size();
+		session_ptrs[i] = &sessions[i];
+		op_ptrs[i] = &ops[i];
+	}
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		if (state.range(1)) {
+			if (TEEC_InvokeCommandMulti(session_ptrs.data(),
+						    (uint32_t)num, 1,
+						    op_ptrs.data(),
+						    TEEC_TIMEOUT_INFINITE,
+						    results.data(), nullptr))
+				state.SkipWithError(
+					"TEEC_InvokeCommandMulti failed");
+			continue;
+		}
+
+		for (size_t i = 0; i < num; i++) {
+			if (TEEC_InvokeCommand(&sessions[i], 1, &ops[i],
+					       &origin))
+				state.SkipWithError(
+					"TEEC_InvokeCommand failed");
+		}
+	}
+
+	for (size_t i = 0; i < num; i++)
+		TEEC_CloseSession(&sessions[i]);
+}
+BENCHMARK(BM_TeecInvokeMulti)
+	->ArgNames({ "sessions", "multi" })
+	->ArgsProduct({ { 1, 4, 16 }, { 0, 1 } })
+	->UseRealTime();
+
+/* A payload streamed to a TA from memory, by TEEC_InvokeStream() with a ring
+ * of buffers, or by one TEEC_InvokeCommand() per chunk into a single
+ * allocated memory (0 buffers).
+ *
+ * Args: chunk size, buffers.
+ */
+const size_t STREAM_PAYLOAD = 16 << 20;
+
+struct StreamSource {
+	const std::vector<char> *payload;
+	size_t offset;
+};
+
+ssize_t read_stream(void *user_data, void *buffer, size_t size)
+{
+	StreamSource *src = static_cast<StreamSource *>(user_data);
+	size_t n = std::min(size, src->payload->size() - src->offset);
+
+	std::memcpy(buffer, src->payload->data() + src->offset, n);
+	src->offset += n;
+
+	return (ssize_t)n;
+}
+
+void BM_TeecInvokeStream(benchmark::State &state)
+{
+	static const TEEC_UUID uuid = {};
+	const std::vector<char> payload(STREAM_PAYLOAD, 's');
+	TeecFixture f(MIX_VALUE, 0);
+	TEEC_StreamConfig config = {};
+	TEEC_SharedMemory shm = {};
+	TEEC_Operation op = {};
+	TEEC_Session session;
+	StreamSource src = { &payload, 0 };
+	uint32_t origin;
+
+	if (TEEC_OpenSession(&f.ctx, &session, &uuid, TEEC_LOGIN_PUBLIC,
+			     nullptr, nullptr, &origin))
+		std::abort();
+
+	config.commandID = 1;
+	config.numBuffers = (uint32_t)state.range(1);
+	config.chunkSize = (size_t)state.range(0);
+	config.read = read_stream;
+	config.userData = &src;
+
+	shm.size = config.chunkSize;
+	shm.flags = TEEC_MEM_INPUT;
+	if (TEEC_AllocateSharedMemory(&f.ctx, &shm))
+		std::abort();
+
+	op.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_PARTIAL_INPUT,
+					 TEEC_VALUE_INPUT, TEEC_NONE,
+					 TEEC_NONE);
+	op.params[0].memref.parent = &shm;
+
+	AllocCounter allocs(state);
+	for (auto _ : state) {
+		src.offset = 0;
+
+		if (config.numBuffers) {
+			if (TEEC_InvokeStream(&session, &config, &origin))
+				state.SkipWithError("TEEC_InvokeStream failed");
+			continue;
+		}
+
+		for (uint32_t i = 0; src.offset < payload.size(); i++) {
+			op.params[0].memref.size =
+				(size_t)read_stream(&src, shm.buffer, shm.size);
+			op.params[1].value.a = i;
+			if (TEEC_InvokeCommand(&session, config.commandID, &op,
+					       &origin))
+				state.SkipWithError("TEEC_InvokeCommand failed");
+		}
+	}
+	state.SetBytesProcessed((int64_t)state.iterations() *
+				(int64_t)payload.size());
+
+	TEEC_ReleaseSharedMemory(&shm);
+	TEEC_CloseSession(&session);
+}
+BENCHMARK(BM_TeecInvokeStream)
+	->ArgNames({ "chunk", "bufs" })
+	->ArgsProduct({ { 64 << 10, 1 << 20 }, { 0, 2, 4 } })
+	->UseRealTime();
+
+/* A TEEC_InvokeCommand() in a session with or without counters, over as
+ * many command IDs as counted apart. The difference is the cost of counting.
+ *
+ * Args: parameter mix, counters.
+ */
+void BM_TeecInvokeStats(benchmark::State &state)
+{
+	static const TEEC_UUID uuid = {};
+	TeecFixture f(state.range(0), 4096);
+	TEEC_StatisticsConfig config = {};
+	TEEC_Parameter params[MAX_NUM_PARAMS];
+	TEEC_Session session;
+	uint32_t command_id = 0;
+	uint32_t origin;
+
+	config.maxCommands = 64;
+	if (state.range(1) && TEEC_ConfigureStatistics(&f.ctx, &config))
+		std::abort();
+
+	if (TEEC_OpenSession(&f.ctx, &session, &uuid, TEEC_LOGIN_PUBLIC,
+			     nullptr, nullptr, &origin))
+		std::abort();
+
+	std::memcpy(params, f.op.params, sizeof(params));
+
+	for (auto _ : state) {
+		if (TEEC_InvokeCommand(&session, command_id++ % 64, &f.op,
+				       &origin))
+			state.SkipWithError("TEEC_InvokeCommand failed");
+
+		std::memcpy(f.op.params, params, sizeof(params));
+	}
+
+	TEEC_CloseSession(&session);
+}
+BENCHMARK(BM_TeecInvokeStats)
+	->ArgNames({ "mix", "stats" })
+	->ArgsProduct({ { MIX_VALUE, MIX_MIXED }, { 0, 1 } });
+
+/* TEEC_RequestCancellation() of an operation whose TA has yet to call
+ * TEE_Wait(), and the TEE_Wait() which consumes the pending signal, with a
+ * number of other operations' signals pending. The time stays flat as the
+ * signals pending grow, unless CWait scans them all.
+ *
+ * Args: signals pending.
+ */
+void BM_CWaitPending(benchmark::State &state)
+{
+	Object wait = bench_cwait_open();
+	uint32_t events = 0;
+
+	/* Cancel codes as new_cancel_code() hands them out */
+	for (int64_t i = 0; i < state.range(0); i++)
+		bench_cwait_signal(wait, 2 + (uint32_t)i);
+
+	for (auto _ : state) {
+		bench_cwait_signal(wait, 1);
+		if (bench_cwait_wait(wait, 1, 1, &events) || !events)
+			state.SkipWithError("CWait lost the signal");
+	}
+
+	Object_ASSIGN_NULL(wait);
+}
+BENCHMARK(BM_CWaitPending)->Arg(0)->Arg(64)->Arg(1024)->Arg(4096);
+
+} // namespace
+
+BENCHMARK_MAIN();
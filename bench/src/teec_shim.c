@@ -0,0 +1,70 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+/* The parameter conversion helpers are static to the Mink TEEC library;
+ * build it as part of this translation unit so they can be measured directly.
+ */
+#include "mink_teec.c"
+
+#include "bench_shim.h"
+
+uint32_t bench_mink_params_from_teec_params(uint32_t param_types,
+					    TEEC_Parameter *params)
+{
+	uint32_t tee_exParamTypes = 0;
+	MINK_Parameter m_params[MAX_NUM_PARAMS];
+
+	mink_params_INIT(m_params);
+	mink_params_from_teec_params(param_types, params, m_params, NULL,
+				     &tee_exParamTypes);
+
+	return tee_exParamTypes;
+}
+
+TEEC_Result bench_teec_marshal(TEEC_Context *ctx, TEEC_Operation *op)
+{
+	TEEC_Result result = TEEC_SUCCESS;
+	uint32_t tee_paramTypes = 0;
+	uint32_t tee_exParamTypes = 0;
+	MINK_Parameter m_params[MAX_NUM_PARAMS];
+
+	mink_params_INIT(m_params);
+
+	result = memref_temp_to_partial_params(ctx, &(op->paramTypes),
+					       op->params);
+	if (result)
+		return result;
+
+	mink_params_from_teec_params(op->paramTypes, op->params, m_params, NULL,
+				     &tee_exParamTypes);
+
+	tee_types_from_teec_types(op, &tee_paramTypes);
+
+	/* IGPSession_invokeCommand() would be called here. */
+
+	update_shm_memref_from_mem_obj(op->paramTypes, op->params, m_params);
+
+	memref_temp_from_partial_params(&(op->paramTypes), op->params);
+
+	return result;
+}
+
+Object bench_cwait_open(void)
+{
+	Object wait = Object_NULL;
+
+	CWait_open(&wait);
+
+	return wait;
+}
+
+int32_t bench_cwait_signal(Object wait, uint32_t code)
+{
+	return IWait_signal(wait, code, IWait_EVENT_CANCEL);
+}
+
+int32_t bench_cwait_wait(Object wait, uint32_t code, uint32_t msec,
+			 uint32_t *events)
+{
+	return IWait_wait(wait, msec, code, IWait_EVENT_CANCEL, events);
+}
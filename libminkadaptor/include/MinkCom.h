@@ -71,6 +71,66 @@ int MinkCom_getMemoryObject(Object rootObj, size_t size, Object *memObj);
 */
 int MinkCom_getMemoryObjectInfo(Object memObj, void **address, size_t *size);
 
+/**
+ * @brief Get a memory object for memory owned by the client.
+ *
+ * Registers the client's pages with QCOMTEE, so they are shared with QTEE in
+ * place rather than copied. The memory must stay valid until the memory
+ * object is released.
+ *
+ * @param rootObj: The root object associated with the client.
+ * @param addr: Page aligned address of the memory.
+ * @param size: Size of the memory, a multiple of the page size.
+ * @param memObj: The memory object requested by the client.
+ * @return Object_OK on success.
+ *         Object_ERROR_UNAVAIL if QCOMTEE does not support registering
+ *         client memory.
+ *         Object_ERROR on failure.
+*/
+int MinkCom_registerMemoryObject(Object rootObj, void *addr, size_t size,
+				 Object *memObj);
+
+/**
+ * @brief Get a new correlation ID, unique in the system until the process ID
+ * is reused.
+ *
+ * @return A non-zero correlation ID.
+*/
+uint64_t MinkCom_newCorrelationId(void);
+
+/**
+ * @brief Set the correlation ID of the calling thread.
+ *
+ * The correlation ID identifies the client request the thread is serving. It
+ * is recorded with the invocations the thread makes, in invocation traces and
+ * probes, and is inherited by callback requests served while one of them is
+ * outstanding.
+ *
+ * @param id: The correlation ID, or 0 to clear it.
+*/
+void MinkCom_setCorrelationId(uint64_t id);
+
+/**
+ * @brief Get the correlation ID of the calling thread.
+ *
+ * @return The correlation ID, or 0 if none is set.
+*/
+uint64_t MinkCom_getCorrelationId(void);
+
+/**
+ * @brief Write a report of the live MINK objects to a file descriptor.
+ *
+ * Lists the callback, remote and memory objects for which references were
+ * taken through the Mink Adaptor and not released, by type and by call site.
+ * Available only if the library is built with ENABLE_OBJECT_PROFILE.
+ *
+ * @param fd: The file descriptor to write the report to.
+ * @return Object_OK on success.
+ *         Object_ERROR if the library is built without the profiler.
+ *         Object_ERROR_MEM on allocation failure.
+*/
+int MinkCom_dumpObjectProfile(int fd);
+
 #ifdef __cplusplus
 }
 #endif
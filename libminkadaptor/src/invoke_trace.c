@@ -0,0 +1,199 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define _GNU_SOURCE /* secure_getenv() */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "invoke_trace.h"
+#include "MinkCom.h"
+
+#define TRACE_ENV "MINKCOM_TRACE"
+#define TRACE_BUFFERS_ENV "MINKCOM_TRACE_BUFFERS"
+
+bool invoke_trace_on = false;
+
+static FILE *trace_file;
+static bool trace_buffers;
+static uint64_t trace_epoch;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t trace_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Expand the trace file name, replacing "%p" with the process ID.
+ */
+static void trace_path(const char *name, char *path, size_t size)
+{
+	const char *p = strstr(name, "%p");
+
+	if (!p) {
+		snprintf(path, size, "%s", name);
+		return;
+	}
+
+	snprintf(path, size, "%.*s%d%s", (int)(p - name), name, (int)getpid(),
+		 p + 2);
+}
+
+/**
+ * @brief Open the trace named by MINKCOM_TRACE when the library is loaded.
+ *
+ * The environment is ignored in set-user-ID and set-group-ID programs. The
+ * trace is created readable by its owner only, and never overwrites an
+ * existing file, as it can hold the contents of input buffers.
+ */
+__attribute__((constructor)) static void invoke_trace_init(void)
+{
+	struct invoke_trace_header header = {
+		.magic = INVOKE_TRACE_MAGIC,
+		.version = INVOKE_TRACE_VERSION,
+	};
+	const char *name = secure_getenv(TRACE_ENV);
+	const char *buffers = secure_getenv(TRACE_BUFFERS_ENV);
+	char path[256];
+	int fd = -1;
+
+	if (!name || !*name)
+		return;
+
+	trace_path(name, path, sizeof(path));
+
+	fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		MSGE("Failed to create invoke trace %s: %s\n", path,
+		     strerror(errno));
+		return;
+	}
+
+	trace_file = fdopen(fd, "wb");
+	if (!trace_file) {
+		MSGE("Failed to open invoke trace %s\n", path);
+		close(fd);
+		return;
+	}
+
+	if (fwrite(&header, sizeof(header), 1, trace_file) != 1) {
+		MSGE("Failed to write invoke trace %s\n", path);
+		fclose(trace_file);
+		trace_file = NULL;
+		return;
+	}
+
+	trace_buffers = buffers && !strcmp(buffers, "1");
+	trace_epoch = trace_now();
+	invoke_trace_on = true;
+}
+
+__attribute__((destructor)) static void invoke_trace_exit(void)
+{
+	pthread_mutex_lock(&trace_lock);
+
+	invoke_trace_on = false;
+	if (trace_file) {
+		fclose(trace_file);
+		trace_file = NULL;
+	}
+
+	pthread_mutex_unlock(&trace_lock);
+}
+
+void invoke_trace_begin(struct invoke_trace *trace,
+			struct qcomtee_object *object, ObjectOp op,
+			ObjectArg *args, ObjectCounts counts)
+{
+	memset(&trace->record, 0, sizeof(trace->record));
+	trace->record.object = (uint64_t)(uintptr_t)object;
+	trace->record.correlation = MinkCom_getCorrelationId();
+	trace->record.op = op;
+	trace->record.counts = counts;
+	trace->record.flags = trace_buffers ? INVOKE_TRACE_F_BUFFERS : 0;
+
+	for (size_t i = 0; i < ObjectCounts_numBuffers(counts); i++)
+		trace->size[i] = args[i].b.size;
+
+	memset(trace->kind, INVOKE_TRACE_OBJECT_NULL, sizeof(trace->kind));
+	trace->tee_start = 0;
+
+	/* Start the clock last, recording is not part of the invocation. */
+	trace->record.start_ns = trace_now();
+}
+
+void invoke_trace_tee_begin(struct invoke_trace *trace,
+			    struct qcomtee_param *params)
+{
+	ObjectCounts counts = trace->record.counts;
+	size_t oi = ObjectCounts_indexOI(counts);
+
+	for (size_t i = 0; i < ObjectCounts_numOI(counts); i++) {
+		switch (qcomtee_object_typeof(params[oi + i].object)) {
+		case QCOMTEE_OBJECT_TYPE_NULL:
+			trace->kind[i] = INVOKE_TRACE_OBJECT_NULL;
+			break;
+		case QCOMTEE_OBJECT_TYPE_CB:
+			trace->kind[i] = INVOKE_TRACE_OBJECT_LOCAL;
+			break;
+		default:
+			trace->kind[i] = INVOKE_TRACE_OBJECT_REMOTE;
+			break;
+		}
+	}
+
+	trace->tee_start = trace_now();
+}
+
+void invoke_trace_tee_end(struct invoke_trace *trace)
+{
+	trace->record.tee_ns = trace_now() - trace->tee_start;
+}
+
+void invoke_trace_end(struct invoke_trace *trace, ObjectArg *args,
+		      int32_t result)
+{
+	struct invoke_trace_record *record = &trace->record;
+	ObjectCounts counts = record->counts;
+	uint64_t size_out[ObjectCounts_maxBO];
+	uint64_t end = trace_now();
+
+	record->total_ns = end - record->start_ns;
+	record->start_ns -= trace_epoch;
+	record->result = result;
+
+	for (size_t i = 0; i < ObjectCounts_numBO(counts); i++)
+		size_out[i] = args[ObjectCounts_indexBO(counts) + i].b.size;
+
+	pthread_mutex_lock(&trace_lock);
+
+	if (!trace_file)
+		goto out;
+
+	fwrite(record, sizeof(*record), 1, trace_file);
+	fwrite(trace->size, sizeof(uint64_t), ObjectCounts_numBuffers(counts),
+	       trace_file);
+	fwrite(size_out, sizeof(uint64_t), ObjectCounts_numBO(counts),
+	       trace_file);
+	fwrite(trace->kind, sizeof(uint8_t), ObjectCounts_numOI(counts),
+	       trace_file);
+
+	if (record->flags & INVOKE_TRACE_F_BUFFERS) {
+		for (size_t i = 0; i < ObjectCounts_numBI(counts); i++)
+			fwrite(args[i].b.ptr, 1, trace->size[i], trace_file);
+	}
+
+out:
+	pthread_mutex_unlock(&trace_lock);
+}
@@ -0,0 +1,118 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef _INVOKE_TRACE_H_
+#define _INVOKE_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <qcomtee_object_types.h>
+#include "object.h"
+
+/* Invocation trace.
+ *
+ * When the MINKCOM_TRACE environment variable names a file, every outbound
+ * invocation made through the Mink Adaptor is appended to it. A "%p" in the
+ * name is replaced by the process ID. Setting MINKCOM_TRACE_BUFFERS=1 also
+ * records the contents of the input buffers.
+ *
+ * The trace starts with a struct invoke_trace_header. Each invocation is a
+ * struct invoke_trace_record followed by:
+ *
+ *   uint64_t size[numBI + numBO]  BI sizes, then BO sizes as passed in,
+ *   uint64_t size_out[numBO]      BO sizes as returned,
+ *   uint8_t  kind[numOI]          INVOKE_TRACE_OBJECT_* of each OI,
+ *   uint8_t  data[]               BI contents, if INVOKE_TRACE_F_BUFFERS.
+ *
+ * All fields are in host byte order.
+ */
+
+#define INVOKE_TRACE_MAGIC 0x4352544dU /* "MTRC" */
+#define INVOKE_TRACE_VERSION 2
+
+/* invoke_trace_record.flags */
+#define INVOKE_TRACE_F_BUFFERS 0x1U
+
+/* Kind of objects sent to QTEE. */
+#define INVOKE_TRACE_OBJECT_NULL 0
+#define INVOKE_TRACE_OBJECT_REMOTE 1
+#define INVOKE_TRACE_OBJECT_LOCAL 2
+
+struct invoke_trace_header {
+	uint32_t magic;
+	uint32_t version;
+};
+
+struct invoke_trace_record {
+	uint64_t start_ns; /* Since the trace was opened. */
+	uint64_t total_ns; /* Time in invoke_over_tee(). */
+	uint64_t tee_ns; /* Time in qcomtee_object_invoke(). */
+	uint64_t object; /* Identity of the invoked QCOMTEE object. */
+	uint64_t correlation; /* MinkCom_getCorrelationId() of the caller. */
+	uint32_t op;
+	uint32_t counts;
+	int32_t result;
+	uint32_t flags;
+};
+
+#define INVOKE_TRACE_MAX_BUFS (ObjectCounts_maxBI + ObjectCounts_maxBO)
+
+/* An invocation being traced. */
+struct invoke_trace {
+	struct invoke_trace_record record;
+	uint64_t tee_start;
+	uint64_t size[INVOKE_TRACE_MAX_BUFS];
+	uint8_t kind[ObjectCounts_maxOI];
+};
+
+extern bool invoke_trace_on;
+
+/**
+ * @brief Check if invocations are being traced.
+ */
+static inline bool invoke_trace_enabled(void)
+{
+	return __builtin_expect(invoke_trace_on, 0);
+}
+
+/**
+ * @brief Start tracing an invocation, before its arguments are marshalled.
+ *
+ * @param trace The invocation trace.
+ * @param object The QCOMTEE object being invoked.
+ * @param op Operation being invoked.
+ * @param args List of MINK arguments.
+ * @param counts Mask encoding the number and type of arguments in args.
+ */
+void invoke_trace_begin(struct invoke_trace *trace,
+			struct qcomtee_object *object, ObjectOp op,
+			ObjectArg *args, ObjectCounts counts);
+
+/**
+ * @brief Mark the start of the call into QCOMTEE.
+ *
+ * @param trace The invocation trace.
+ * @param params List of marshalled QCOMTEE parameters.
+ */
+void invoke_trace_tee_begin(struct invoke_trace *trace,
+			    struct qcomtee_param *params);
+
+/**
+ * @brief Mark the end of the call into QCOMTEE.
+ *
+ * @param trace The invocation trace.
+ */
+void invoke_trace_tee_end(struct invoke_trace *trace);
+
+/**
+ * @brief Finish tracing an invocation and append it to the trace.
+ *
+ * @param trace The invocation trace.
+ * @param args List of MINK arguments.
+ * @param result Result of the invocation.
+ */
+void invoke_trace_end(struct invoke_trace *trace, ObjectArg *args,
+		      int32_t result);
+
+#endif // _INVOKE_TRACE_H_
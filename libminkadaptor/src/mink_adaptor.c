@@ -1,10 +1,15 @@
 // Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
+#include "invoke_trace.h"
 #include "mink_adaptor_priv.h"
+#include "object_profile.h"
+#include "probes.h"
 #include "supplicant.h"
 
 #include "MinkCom.h"
@@ -27,6 +32,70 @@ static struct qcomtee_object_ops ops = {
 	.release = qcomtee_callback_obj_release,
 };
 
+/* Correlation ID of the request the calling thread is serving. */
+static __thread uint64_t correlation_id;
+
+/* Sequence numbers of correlation IDs are handed out to threads in blocks of
+ * CORRELATION_BLOCK, so that threads starting requests concurrently do not
+ * contend for them.
+ */
+#define CORRELATION_BLOCK 1024
+
+static atomic_uint correlation_next;
+static __thread uint32_t correlation_cur;
+static __thread uint32_t correlation_end;
+
+/* Outbound invocations with a correlation ID, and the last one started.
+ * QTEE does not say which invocation a callback request is made for, so it is
+ * attributed only if a single one is outstanding.
+ */
+static atomic_uint outstanding_num;
+static _Atomic uint64_t outstanding_id;
+
+/**
+ * @brief Account for an outbound invocation of the calling thread.
+ */
+static void correlation_invoke_begin(void)
+{
+	if (!correlation_id)
+		return;
+
+	atomic_store_explicit(&outstanding_id, correlation_id,
+			      memory_order_relaxed);
+	atomic_fetch_add_explicit(&outstanding_num, 1, memory_order_relaxed);
+}
+
+static void correlation_invoke_end(void)
+{
+	if (correlation_id)
+		atomic_fetch_sub_explicit(&outstanding_num, 1,
+					  memory_order_relaxed);
+}
+
+/**
+ * @brief Set the correlation ID of a thread serving a callback request.
+ *
+ * The callback request inherits the correlation ID of the outbound invocation
+ * it is made for if that can be told, and gets a new one otherwise.
+ *
+ * @return The previous correlation ID of the thread, to be restored.
+ */
+static uint64_t correlation_callback_begin(void)
+{
+	uint64_t prev = correlation_id;
+
+	if (prev)
+		return prev;
+
+	if (atomic_load_explicit(&outstanding_num, memory_order_relaxed) == 1)
+		correlation_id = atomic_load_explicit(&outstanding_id,
+						      memory_order_relaxed);
+	else
+		correlation_id = MinkCom_newCorrelationId();
+
+	return prev;
+}
+
 /**
  * @brief Get a QCOMTEE object from a MINK object.
  *
@@ -62,6 +131,8 @@ qcomtee_obj_from_mink_obj(struct qcomtee_object *root_object, Object obj,
 
 		qcomtee_cbo->mink_obj = obj;
 		*object = &qcomtee_cbo->object;
+
+		object_profile_get(*object, obj.invoke);
 		return Object_OK;
 	}
 }
@@ -267,14 +338,20 @@ qcomtee_callback_obj_dispatch(struct qcomtee_object *object, qcomtee_op_t op,
 
 	ObjectArg objArgs[MAX_OBJ_ARG_COUNT] = { { { 0, 0 } } };
 	ObjectCounts counts = get_obj_counts(params, num);
+	uint64_t prev_id = correlation_callback_begin();
+
+	PROBE(callback_entry, object, op, counts, correlation_id);
 
 	ret = object_args_from_tee_params_cb(params, num, objArgs,
 					     qcomtee_cbo->allocated_bo);
 	if (ret)
-		return ret;
+		goto out;
 
 	ret = Object_invoke(qcomtee_cbo->mink_obj, op, objArgs, counts);
 	if (!ret) {
+		/* Objects returned to QTEE are attributed to this callback. */
+		object_profile_site((void *)qcomtee_cbo->mink_obj.invoke);
+
 		ret = object_args_to_tee_params_cb(objArgs, counts, params,
 						   root);
 		if (ret) {
@@ -286,6 +363,11 @@ qcomtee_callback_obj_dispatch(struct qcomtee_object *object, qcomtee_op_t op,
 		}
 	}
 
+out:
+	PROBE(callback_exit, object, op, ret, correlation_id);
+
+	correlation_id = prev_id;
+
 	return ret;
 }
 
@@ -323,6 +405,8 @@ static void qcomtee_callback_obj_release(struct qcomtee_object *object)
 {
 	struct qcomtee_callback_obj *qcomtee_cbo = CALLBACKOBJ(object);
 
+	object_profile_put(object);
+
 	Object_release(qcomtee_cbo->mink_obj);
 	free(qcomtee_cbo);
 }
@@ -397,6 +481,9 @@ static int32_t object_args_from_tee_params(struct qcomtee_param *params,
 			break;
 		case QCOMTEE_OBJREF_OUTPUT:
 			args[i].o = mink_obj_from_qcomtee_obj(params[i].object);
+			if (qcomtee_object_typeof(params[i].object) !=
+			    QCOMTEE_OBJECT_TYPE_CB)
+				object_profile_get(params[i].object, NULL);
 			break;
 		default:
 			return Object_ERROR_INVALID;
@@ -429,14 +516,23 @@ static int invoke_over_tee(ObjectCxt cxt, ObjectOp op, ObjectArg *args,
 		return Object_ERROR_BADOBJ;
 	}
 
+	object_profile_site(__builtin_return_address(0));
+
 	ObjectOp method = ObjectOp_methodID(op);
 	if (ObjectOp_isLocal(op)) {
 		switch (method) {
 		case Object_OP_retain:
+			object_profile_get(object, NULL);
 
 			qcomtee_object_refs_inc(object);
 			return Object_OK;
 		case Object_OP_release:
+#ifdef MINKIPC_USDT
+			if (qcomtee_object_typeof(object) ==
+			    QCOMTEE_OBJECT_TYPE_MEMORY)
+				PROBE(memobj_release, object);
+#endif
+			object_profile_put(object);
 
 			qcomtee_object_refs_dec(object);
 			return Object_OK;
@@ -445,10 +541,23 @@ static int invoke_over_tee(ObjectCxt cxt, ObjectOp op, ObjectArg *args,
 		}
 	}
 
+	bool traced = invoke_trace_enabled();
+	struct invoke_trace trace;
+
+	if (traced)
+		invoke_trace_begin(&trace, object, op, args, counts);
+
+	PROBE(invoke_entry, object, op, counts, correlation_id);
+
+	correlation_invoke_begin();
+
 	ret = object_args_to_tee_params(args, counts, params, object->root);
 	if (ret)
 		goto err_marshal_in;
 
+	if (traced)
+		invoke_trace_tee_begin(&trace, params);
+
 	if (qcomtee_object_invoke(object, op, params,
 				  ObjectCounts_total(counts), &result)) {
 		MSGE("Failed qcomtee_object_invoke\n");
@@ -456,6 +565,9 @@ static int invoke_over_tee(ObjectCxt cxt, ObjectOp op, ObjectArg *args,
 		goto err_marshal_in;
 	}
 
+	if (traced)
+		invoke_trace_tee_end(&trace);
+
 	if (result) {
 		MSGE("Failed qcomtee_object_invoke. result = 0x%x\n", result);
 		ret = result;
@@ -467,12 +579,26 @@ static int invoke_over_tee(ObjectCxt cxt, ObjectOp op, ObjectArg *args,
 err_result:
 	/* qcomtee_object_invoke was successful; QTEE releases OI. */
 
+	correlation_invoke_end();
+
+	if (traced)
+		invoke_trace_end(&trace, args, ret);
+
+	PROBE(invoke_exit, object, op, ret, correlation_id);
+
 	return ret;
 
 err_marshal_in:
 	release_qcomtee_objs(params, ObjectCounts_total(counts),
 			     QCOMTEE_OBJREF_INPUT);
 
+	correlation_invoke_end();
+
+	if (traced)
+		invoke_trace_end(&trace, args, ret);
+
+	PROBE(invoke_exit, object, op, ret, correlation_id);
+
 	return ret;
 }
 
@@ -484,6 +610,9 @@ int MinkCom_getRootEnvObject(Object *obj)
 		return Object_ERROR;
 	}
 
+	object_profile_site(__builtin_return_address(0));
+	object_profile_get(sup->root, NULL);
+
 	*obj = mink_obj_from_qcomtee_obj(sup->root);
 	return Object_OK;
 }
@@ -519,6 +648,9 @@ int MinkCom_getClientEnvObject(Object rootObj, Object *clientEnvObj)
 		goto err_result;
 	}
 
+	object_profile_site(__builtin_return_address(0));
+	object_profile_get(params[1].object, NULL);
+
 	*clientEnvObj = mink_obj_from_qcomtee_obj(params[1].object);
 
 err_result:
@@ -542,6 +674,8 @@ int MinkCom_getClientEnvObjectWithCreds(Object rootObj, Object creds,
 	struct qcomtee_param params[2];
 	qcomtee_result_t result;
 
+	object_profile_site(__builtin_return_address(0));
+
 	ret = qcomtee_obj_from_mink_obj(root, creds, &creds_object);
 	if (ret)
 		return ret;
@@ -563,6 +697,8 @@ int MinkCom_getClientEnvObjectWithCreds(Object rootObj, Object creds,
 		goto err_result;
 	}
 
+	object_profile_get(params[1].object, NULL);
+
 	*obj = mink_obj_from_qcomtee_obj(params[1].object);
 
 err_result:
@@ -592,11 +728,46 @@ int MinkCom_getMemoryObject(Object rootObj, size_t size, Object *memObj)
 		goto err;
 	}
 
+	PROBE(memobj_alloc, memory_object, size);
+
+	object_profile_site(__builtin_return_address(0));
+	object_profile_get(memory_object, NULL);
+
 	*memObj = mink_obj_from_qcomtee_obj(memory_object);
 err:
 	return ret;
 }
 
+int MinkCom_registerMemoryObject(Object rootObj, void *addr, size_t size,
+				 Object *memObj)
+{
+#ifdef HAVE_QCOMTEE_MEMORY_OBJECT_REGISTER
+	struct qcomtee_object *memory_object = NULL;
+	struct qcomtee_object *root = (struct qcomtee_object *)rootObj.context;
+	if (!root)
+		return Object_ERROR;
+
+	if (qcomtee_memory_object_register(addr, size, root, &memory_object))
+		return Object_ERROR;
+
+	PROBE(memobj_alloc, memory_object, size);
+
+	object_profile_site(__builtin_return_address(0));
+	object_profile_get(memory_object, NULL);
+
+	*memObj = mink_obj_from_qcomtee_obj(memory_object);
+
+	return Object_OK;
+#else
+	(void)rootObj;
+	(void)addr;
+	(void)size;
+	(void)memObj;
+
+	return Object_ERROR_UNAVAIL;
+#endif
+}
+
 int MinkCom_getMemoryObjectInfo(Object memObj, void **address, size_t *size)
 {
 	int ret = Object_OK;
@@ -626,3 +797,31 @@ int MinkCom_getMemoryObjectInfo(Object memObj, void **address, size_t *size)
 err:
 	return ret;
 }
+
+uint64_t MinkCom_newCorrelationId(void)
+{
+	uint32_t seq = 0;
+
+	while (!seq) {
+		if (correlation_cur == correlation_end) {
+			correlation_cur = atomic_fetch_add_explicit(
+				&correlation_next, CORRELATION_BLOCK,
+				memory_order_relaxed);
+			correlation_end = correlation_cur + CORRELATION_BLOCK;
+		}
+
+		seq = correlation_cur++;
+	}
+
+	return ((uint64_t)getpid() << 32) | seq;
+}
+
+void MinkCom_setCorrelationId(uint64_t id)
+{
+	correlation_id = id;
+}
+
+uint64_t MinkCom_getCorrelationId(void)
+{
+	return correlation_id;
+}
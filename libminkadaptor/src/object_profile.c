@@ -0,0 +1,404 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define _GNU_SOURCE /* dladdr(), secure_getenv() */
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "object_profile.h"
+
+#include "MinkCom.h"
+
+#ifdef MINKIPC_OBJECT_PROFILE
+
+#define PROFILE_SIGNAL_ENV "MINKCOM_PROFILE_SIGNAL"
+#define PROFILE_FILE_ENV "MINKCOM_PROFILE_FILE"
+
+#define PROFILE_BUCKETS 1024
+
+enum profile_kind {
+	PROFILE_CALLBACK,
+	PROFILE_REMOTE,
+	PROFILE_MEMORY,
+	PROFILE_ROOT,
+};
+
+static const char *const profile_kind_name[] = {
+	[PROFILE_CALLBACK] = "callback",
+	[PROFILE_REMOTE] = "remote",
+	[PROFILE_MEMORY] = "memory",
+	[PROFILE_ROOT] = "root",
+};
+
+struct profile_entry {
+	struct profile_entry *next;
+	struct qcomtee_object *object;
+	ObjectInvoke invoke;
+	void *site;
+	size_t size;
+	uint32_t refs;
+	enum profile_kind kind;
+};
+
+/* A type or call site in the report. */
+struct profile_row {
+	enum profile_kind kind;
+	const void *key;
+	size_t live;
+	size_t bytes;
+};
+
+static struct profile_entry *profile_table[PROFILE_BUCKETS];
+static size_t profile_live;
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread void *profile_site_tls;
+
+static int profile_pipe[2] = { -1, -1 };
+
+static size_t profile_hash(struct qcomtee_object *object)
+{
+	uintptr_t p = (uintptr_t)object;
+
+	return ((p >> 4) ^ (p >> 14)) % PROFILE_BUCKETS;
+}
+
+static enum profile_kind profile_kind_of(struct qcomtee_object *object)
+{
+	switch (qcomtee_object_typeof(object)) {
+	case QCOMTEE_OBJECT_TYPE_CB:
+		return PROFILE_CALLBACK;
+	case QCOMTEE_OBJECT_TYPE_MEMORY:
+		return PROFILE_MEMORY;
+	case QCOMTEE_OBJECT_TYPE_ROOT:
+		return PROFILE_ROOT;
+	default:
+		return PROFILE_REMOTE;
+	}
+}
+
+void object_profile_site(void *site)
+{
+	profile_site_tls = site;
+}
+
+void object_profile_get(struct qcomtee_object *object, ObjectInvoke invoke)
+{
+	struct profile_entry **slot = &profile_table[profile_hash(object)];
+	struct profile_entry *entry;
+
+	if (object == QCOMTEE_OBJECT_NULL)
+		return;
+
+	pthread_mutex_lock(&profile_lock);
+
+	for (entry = *slot; entry; entry = entry->next) {
+		if (entry->object == object) {
+			entry->refs++;
+			goto out;
+		}
+	}
+
+	/* Profiling is best effort; an object we fail to record is missed. */
+	entry = malloc(sizeof(*entry));
+	if (!entry)
+		goto out;
+
+	entry->object = object;
+	entry->invoke = invoke;
+	entry->site = profile_site_tls;
+	entry->kind = profile_kind_of(object);
+	entry->size = entry->kind == PROFILE_MEMORY ?
+			      qcomtee_memory_object_size(object) : 0;
+	entry->refs = 1;
+	entry->next = *slot;
+	*slot = entry;
+	profile_live++;
+
+out:
+	pthread_mutex_unlock(&profile_lock);
+}
+
+void object_profile_put(struct qcomtee_object *object)
+{
+	struct profile_entry **slot = &profile_table[profile_hash(object)];
+	struct profile_entry *entry;
+
+	pthread_mutex_lock(&profile_lock);
+
+	for (; (entry = *slot); slot = &entry->next) {
+		if (entry->object != object)
+			continue;
+
+		if (--entry->refs == 0) {
+			*slot = entry->next;
+			profile_live--;
+			free(entry);
+		}
+
+		break;
+	}
+
+	pthread_mutex_unlock(&profile_lock);
+}
+
+static int profile_row_cmp_key(const void *a, const void *b)
+{
+	const struct profile_row *x = a, *y = b;
+
+	if (x->kind != y->kind)
+		return x->kind < y->kind ? -1 : 1;
+
+	return (x->key > y->key) - (x->key < y->key);
+}
+
+/* Most live objects first, then most bytes. */
+static int profile_row_cmp_live(const void *a, const void *b)
+{
+	const struct profile_row *x = a, *y = b;
+
+	if (x->live != y->live)
+		return x->live > y->live ? -1 : 1;
+
+	return (x->bytes < y->bytes) - (x->bytes > y->bytes);
+}
+
+/**
+ * @brief Merge rows with the same kind and key, and sort the result.
+ *
+ * @return The number of rows left.
+ */
+static size_t profile_merge(struct profile_row *rows, size_t num)
+{
+	size_t n = 0;
+
+	if (!num)
+		return 0;
+
+	qsort(rows, num, sizeof(*rows), profile_row_cmp_key);
+
+	for (size_t i = 1; i < num; i++) {
+		if (!profile_row_cmp_key(&rows[n], &rows[i])) {
+			rows[n].live += rows[i].live;
+			rows[n].bytes += rows[i].bytes;
+		} else {
+			rows[++n] = rows[i];
+		}
+	}
+
+	qsort(rows, ++n, sizeof(*rows), profile_row_cmp_live);
+
+	return n;
+}
+
+/**
+ * @brief Describe a code address as symbol+offset, or module+offset for
+ * symbols which are not exported.
+ */
+static void profile_symbol(const void *addr, char *buf, size_t size)
+{
+	Dl_info info;
+
+	if (!addr) {
+		snprintf(buf, size, "-");
+	} else if (!dladdr(addr, &info)) {
+		snprintf(buf, size, "%p", addr);
+	} else if (info.dli_sname) {
+		size_t off = (uintptr_t)addr - (uintptr_t)info.dli_saddr;
+
+		if (off)
+			snprintf(buf, size, "%s+0x%zx", info.dli_sname, off);
+		else
+			snprintf(buf, size, "%s", info.dli_sname);
+	} else {
+		const char *name = strrchr(info.dli_fname, '/');
+
+		snprintf(buf, size, "%s+0x%zx",
+			 name ? name + 1 : info.dli_fname,
+			 (size_t)((uintptr_t)addr - (uintptr_t)info.dli_fbase));
+	}
+}
+
+static void profile_print(int fd, const char *title,
+			  struct profile_row *rows, size_t num)
+{
+	char name[256];
+
+	dprintf(fd, "\n%8s %12s  %-9s %s\n", "live", "bytes", "kind", title);
+
+	for (size_t i = 0; i < num; i++) {
+		profile_symbol(rows[i].key, name, sizeof(name));
+		dprintf(fd, "%8zu %12zu  %-9s %s\n", rows[i].live, rows[i].bytes,
+			profile_kind_name[rows[i].kind], name);
+	}
+}
+
+int MinkCom_dumpObjectProfile(int fd)
+{
+	struct profile_row *types = NULL, *sites = NULL;
+	size_t num = 0, bytes = 0;
+
+	pthread_mutex_lock(&profile_lock);
+
+	if (profile_live) {
+		types = calloc(profile_live, sizeof(*types));
+		sites = calloc(profile_live, sizeof(*sites));
+		if (!types || !sites) {
+			pthread_mutex_unlock(&profile_lock);
+			free(types);
+			free(sites);
+			return Object_ERROR_MEM;
+		}
+	}
+
+	for (size_t i = 0; i < PROFILE_BUCKETS; i++) {
+		for (struct profile_entry *entry = profile_table[i]; entry;
+		     entry = entry->next) {
+			types[num].kind = entry->kind;
+			types[num].key = (const void *)entry->invoke;
+			types[num].live = 1;
+			types[num].bytes = entry->size;
+
+			sites[num] = types[num];
+			sites[num].key = entry->site;
+
+			bytes += entry->size;
+			num++;
+		}
+	}
+
+	pthread_mutex_unlock(&profile_lock);
+
+	dprintf(fd, "MINK objects, pid %d: %zu live, %zu bytes\n",
+		(int)getpid(), num, bytes);
+
+	profile_print(fd, "type", types, profile_merge(types, num));
+	profile_print(fd, "site", sites, profile_merge(sites, num));
+
+	free(types);
+	free(sites);
+
+	return Object_OK;
+}
+
+static void profile_dump_file(void)
+{
+	const char *path = secure_getenv(PROFILE_FILE_ENV);
+	int fd = STDERR_FILENO;
+
+	if (path && *path) {
+		fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+		if (fd < 0) {
+			MSGE("Failed to open object profile %s\n", path);
+			return;
+		}
+	}
+
+	MinkCom_dumpObjectProfile(fd);
+
+	if (fd != STDERR_FILENO)
+		close(fd);
+}
+
+/* The report is not async-signal-safe; hand it to the dumper thread. */
+static void profile_signal(int sig)
+{
+	int err = errno;
+	char c = 0;
+
+	(void)sig;
+
+	if (write(profile_pipe[1], &c, 1) < 0) {
+		/* A dump is already pending. */
+	}
+
+	errno = err;
+}
+
+static void *profile_dumper(void *arg)
+{
+	char c;
+
+	(void)arg;
+
+	for (;;) {
+		ssize_t n = read(profile_pipe[0], &c, 1);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+
+		if (n <= 0)
+			break;
+
+		profile_dump_file();
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Dump the object profile on the signal named by
+ * MINKCOM_PROFILE_SIGNAL.
+ */
+__attribute__((constructor)) static void object_profile_init(void)
+{
+	const char *env = secure_getenv(PROFILE_SIGNAL_ENV);
+	struct sigaction sa;
+	pthread_attr_t attr;
+	pthread_t thread;
+	int sig;
+
+	if (!env || !*env)
+		return;
+
+	sig = atoi(env);
+	if (sig <= 0 || sig >= NSIG) {
+		MSGE("Invalid %s=%s\n", PROFILE_SIGNAL_ENV, env);
+		return;
+	}
+
+	if (pipe2(profile_pipe, O_CLOEXEC)) {
+		MSGE("Failed to create object profile pipe\n");
+		return;
+	}
+
+	fcntl(profile_pipe[1], F_SETFL, O_NONBLOCK);
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+	if (pthread_create(&thread, &attr, profile_dumper, NULL)) {
+		MSGE("Failed to start object profile dumper\n");
+		pthread_attr_destroy(&attr);
+		return;
+	}
+
+	pthread_attr_destroy(&attr);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = profile_signal;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(sig, &sa, NULL))
+		MSGE("Failed to install object profile signal %d\n", sig);
+}
+
+#else
+
+int MinkCom_dumpObjectProfile(int fd)
+{
+	(void)fd;
+
+	return Object_ERROR;
+}
+
+#endif // MINKIPC_OBJECT_PROFILE
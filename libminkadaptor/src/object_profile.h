@@ -0,0 +1,69 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef _OBJECT_PROFILE_H_
+#define _OBJECT_PROFILE_H_
+
+#include <qcomtee_object_types.h>
+#include "object.h"
+
+/* Live object profiler.
+ *
+ * Built with MINKIPC_OBJECT_PROFILE, the Mink Adaptor keeps a table of the
+ * objects it hands out: callback object wrappers sent to QTEE, and remote
+ * and memory objects returned to clients. Each entry holds the number of
+ * references taken through the Mink Adaptor, the call site that first took
+ * one and, for memory objects, the size. MinkCom_dumpObjectProfile() prints
+ * the live objects by type and by call site.
+ *
+ * Without MINKIPC_OBJECT_PROFILE the hooks compile to nothing.
+ */
+
+#ifdef MINKIPC_OBJECT_PROFILE
+
+/**
+ * @brief Set the call site of objects the calling thread takes references to.
+ *
+ * @param site Return address of the client function, or the invoke function
+ *             of the callback object being served.
+ */
+void object_profile_site(void *site);
+
+/**
+ * @brief Account for a reference to an object.
+ *
+ * @param object The QCOMTEE object.
+ * @param invoke For callback object wrappers, the invoke function of the
+ *               wrapped MINK object; NULL otherwise.
+ */
+void object_profile_get(struct qcomtee_object *object, ObjectInvoke invoke);
+
+/**
+ * @brief Account for a reference released; forget the object with the last.
+ *
+ * @param object The QCOMTEE object.
+ */
+void object_profile_put(struct qcomtee_object *object);
+
+#else
+
+static inline void object_profile_site(void *site)
+{
+	(void)site;
+}
+
+static inline void object_profile_get(struct qcomtee_object *object,
+				      ObjectInvoke invoke)
+{
+	(void)object;
+	(void)invoke;
+}
+
+static inline void object_profile_put(struct qcomtee_object *object)
+{
+	(void)object;
+}
+
+#endif // MINKIPC_OBJECT_PROFILE
+
+#endif // _OBJECT_PROFILE_H_
@@ -264,6 +264,16 @@ typedef struct  {
 		Object root_obj;
 		Object app_client;
 		Object waiter_cbo;
+		struct bounce_pool *bounce_pool;
+		struct shm_cache *shm_cache;
+		struct session_pool *session_pool;
+		struct invoke_timer *invoke_timer;
+		uint32_t invoke_timeout;
+		struct inflight_set *inflight;
+		uint32_t cancel_gen;
+		struct session_recovery *recovery;
+		/* Commands counted apart in new sessions, 0 for none */
+		uint32_t stats_commands;
 	} imp;
 } TEEC_Context;
 
@@ -273,6 +283,16 @@ typedef struct  {
 	struct {
 		TEEC_Context *ctx;
 		Object session_obj;
+		/* The key of the session in the session pool */
+		TEEC_UUID uuid;
+		uint32_t login;
+		uint32_t conn_data;
+		uint8_t poolable;
+		uint8_t broken;
+		uint32_t cancel_gen;
+		/* The number of times the session was re-opened */
+		uint32_t epoch;
+		struct invoke_stats *stats;
 	} imp;
 } TEEC_Session;
 
@@ -296,7 +316,11 @@ typedef struct {
 		TEEC_Context *ctx;
 		uint8_t type;
 		uint8_t converted;
+		uint8_t in_place;
 		Object mem_obj;
+		size_t offset;
+		/* The memfd backing a shareable memory, or -1 */
+		int fd;
 	} imp;
 } TEEC_SharedMemory;
 
@@ -419,6 +443,10 @@ typedef struct  {
 	struct {
 		TEEC_Session *session;
 		uint32_t cancel_code;
+		struct completion_queue *cq;
+		/* The cancel_gen of the session and context when bound */
+		uint32_t session_gen;
+		uint32_t context_gen;
 	} imp;
 } TEEC_Operation;
 
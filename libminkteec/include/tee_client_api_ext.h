@@ -0,0 +1,947 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __TEE_CLIENT_API_EXT_H_
+#define __TEE_CLIENT_API_EXT_H_
+
+#include <sys/types.h>
+
+#include "tee_client_api.h"
+
+/* Extensions to the Global Platform TEE Client API.
+ *
+ * These are not part of the Global Platform specification. Client
+ * Applications using them are not portable to other TEE Client API
+ * implementations.
+ */
+
+/*----------------------------------------------------------------------------
+ *  Data Structures
+ * -------------------------------------------------------------------------*/
+
+/* This type reports the reuse of the memory objects which the large
+ * Temporary Memory References of a Context are copied through.
+ * hits: the memory objects reused.
+ * misses: the memory objects allocated as none could be reused.
+ * drops: the memory objects released after use as the pool was full or
+ *      they were too large to keep.
+ * cached: the memory objects kept for reuse now.
+ * cachedBytes: the size, in bytes, of the memory objects kept now.
+ */
+typedef struct {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t drops;
+	uint64_t cached;
+	uint64_t cachedBytes;
+} TEEC_BounceBufferStats;
+
+/* This type denotes an Operation validated and converted once, to be invoked
+ * many times with TEEC_InvokePrepared.
+ */
+typedef struct {
+	/* <Implementation-Defined Type> */
+	struct {
+		struct prepared_op *prep;
+	} imp;
+} TEEC_PreparedOperation;
+
+/* Session pool flags.
+ * TEEC_SESSION_POOL_HEALTH_CHECK: invoke healthCheckCommand in a pooled
+ *      Session before handing it out, and close it if this fails or does
+ *      not complete within TEEC_SESSION_POOL_HEALTH_CHECK_TIMEOUT.
+ */
+#define TEEC_SESSION_POOL_HEALTH_CHECK 0x00000001
+
+/* The time, in milliseconds, after which a health check is cancelled. */
+#define TEEC_SESSION_POOL_HEALTH_CHECK_TIMEOUT 1000
+
+/* This type configures the pool of Sessions of a Context.
+ * maxSessions: the number of idle Sessions the pool keeps. The Sessions idle
+ *      the longest are closed to make room for others. 0 disables the pool.
+ * maxIdleTime: the time, in milliseconds, an idle Session is kept, or
+ *      TEEC_TIMEOUT_INFINITE to keep it until it makes room for others.
+ * flags: a combination of the session pool flags.
+ * healthCheckCommand: the identifier of a Command, taking no parameters,
+ *      which a healthy Trusted Application completes with TEEC_SUCCESS.
+ */
+typedef struct {
+	uint32_t maxSessions;
+	uint32_t maxIdleTime;
+	uint32_t flags;
+	uint32_t healthCheckCommand;
+} TEEC_SessionPoolConfig;
+
+/* This type reports the use of the pool of Sessions of a Context since it
+ * was configured.
+ * hits: the Sessions handed out from the pool.
+ * misses: the Sessions opened as the pool had none to hand out.
+ * evictions: the Sessions closed as they had been idle too long or the pool
+ *      was full.
+ * failedChecks: the Sessions closed as they failed the health check.
+ * idle: the Sessions the pool holds now.
+ */
+typedef struct {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	uint64_t failedChecks;
+	uint64_t idle;
+} TEEC_SessionPoolStats;
+
+/* The maximum number of Contexts the context pool keeps. */
+#define TEEC_CONFIG_CONTEXT_POOL_MAX 16
+
+/* Context pool flags.
+ * TEEC_CONTEXT_POOL_WARM: initialize Contexts for the pool in the
+ *      background, so that it is full before the first TEEC_InitializeContext.
+ */
+#define TEEC_CONTEXT_POOL_WARM 0x00000001
+
+/* This type configures the process-wide pool of Contexts.
+ * maxContexts: the number of finalized Contexts the pool keeps, up to
+ *      TEEC_CONFIG_CONTEXT_POOL_MAX. 0 disables the pool.
+ * flags: a combination of the context pool flags.
+ */
+typedef struct {
+	uint32_t maxContexts;
+	uint32_t flags;
+} TEEC_ContextPoolConfig;
+
+/* This type reports the use of the process-wide pool of Contexts.
+ * hits: the Contexts initialized with a pooled connection.
+ * misses: the Contexts initialized with a new connection.
+ * drops: the connections closed as the pool was full.
+ * failedChecks: the pooled connections closed as QTEE no longer answered
+ *      through them.
+ * idle: the connections the pool holds now.
+ */
+typedef struct {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t drops;
+	uint64_t failedChecks;
+	uint64_t idle;
+} TEEC_ContextPoolStats;
+
+/* This type configures the recovery of the Sessions of a Context.
+ * maxRetries: the number of times a Command is retried in a recovered Session.
+ * holdOff: the time, in milliseconds, during which a Session found defunct is
+ *      not opened again after it failed to.
+ * idempotentCommands: the identifiers of the Commands which are retried,
+ *      which must have the same effect when invoked again. NULL if
+ *      numIdempotentCommands is 0.
+ * numIdempotentCommands: the number of entries in idempotentCommands.
+ */
+typedef struct {
+	uint32_t maxRetries;
+	uint32_t holdOff;
+	const uint32_t *idempotentCommands;
+	uint32_t numIdempotentCommands;
+} TEEC_SessionRecoveryConfig;
+
+/* This type reports the recovery of the Sessions of a Context.
+ * recoveries: the Sessions opened again after they were found defunct.
+ * failedRecoveries: the Sessions which failed to open again.
+ * coalesced: the times a Session was found defunct while, or after, another
+ *      thread opened it again, and was not opened again for it.
+ * retries: the Commands retried in a recovered Session.
+ * recoveryTimeTotal: the time, in microseconds, spent opening Sessions again.
+ * recoveryTimeMax: the longest time, in microseconds, spent opening a Session
+ *      again.
+ */
+typedef struct {
+	uint64_t recoveries;
+	uint64_t failedRecoveries;
+	uint64_t coalesced;
+	uint64_t retries;
+	uint64_t recoveryTimeTotal;
+	uint64_t recoveryTimeMax;
+} TEEC_SessionRecoveryStats;
+
+/* The maximum number of Commands counted apart in each Session. */
+#define TEEC_CONFIG_STATS_MAX_COMMANDS 1024
+
+/* The commandID of the counters of the Commands of a Session beyond its
+ * first maxCommands.
+ */
+#define TEEC_STATS_OTHER_COMMANDS 0xFFFFFFFF
+
+/* The number of buckets of the latency histogram. Bucket 0 counts the
+ * Commands taking less than 1 microsecond, bucket i those taking from 2^(i-1)
+ * up to 2^i microseconds, and the last bucket the Commands taking longer.
+ */
+#define TEEC_STATS_LATENCY_BUCKETS 24
+
+/* The classes of parameters whose bytes are counted apart. Registered
+ * memory references count as TEEC_STATS_PARAM_WHOLE or
+ * TEEC_STATS_PARAM_PARTIAL after their type.
+ */
+#define TEEC_STATS_PARAM_VALUE   0
+#define TEEC_STATS_PARAM_TEMP    1
+#define TEEC_STATS_PARAM_WHOLE   2
+#define TEEC_STATS_PARAM_PARTIAL 3
+#define TEEC_STATS_PARAM_CLASSES 4
+
+/* This type configures the counters of the Sessions of a Context.
+ * maxCommands: the number of Commands counted apart in each Session, up to
+ *      TEEC_CONFIG_STATS_MAX_COMMANDS. The Commands invoked after the first
+ *      maxCommands are counted together, as TEEC_STATS_OTHER_COMMANDS.
+ */
+typedef struct {
+	uint32_t maxCommands;
+} TEEC_StatisticsConfig;
+
+/* This type reports the counters of a Command in a Session.
+ * commandID: the identifier of the Command, or TEEC_STATS_OTHER_COMMANDS.
+ * invocations: the times the Command was invoked.
+ * failures: the invocations which did not return TEEC_SUCCESS.
+ * totalTime: the time, in microseconds, spent invoking the Command, from
+ *      converting its parameters to updating them with the results.
+ * maxTime: the longest time, in microseconds, an invocation took.
+ * latency: the histogram of the time invocations took.
+ * bytesIn: the bytes passed to the Trusted Application, by parameter class.
+ * bytesOut: the bytes returned by the Trusted Application on success, by
+ *      parameter class.
+ * memoryObjects: the memory objects allocated or registered with QTEE for
+ *      the Command.
+ * copyBytes: the bytes copied between registered Shared Memory and the
+ *      memory objects backing it.
+ */
+typedef struct {
+	uint32_t commandID;
+	uint64_t invocations;
+	uint64_t failures;
+	uint64_t totalTime;
+	uint64_t maxTime;
+	uint64_t latency[TEEC_STATS_LATENCY_BUCKETS];
+	uint64_t bytesIn[TEEC_STATS_PARAM_CLASSES];
+	uint64_t bytesOut[TEEC_STATS_PARAM_CLASSES];
+	uint64_t memoryObjects;
+	uint64_t copyBytes;
+} TEEC_CommandStatistics;
+
+/* The maximum number of threads of a completion queue. */
+#define TEEC_CONFIG_COMPLETION_QUEUE_MAX_THREADS 64
+
+/* Timeout of TEEC_WaitCompletions waiting until a command completes, and of
+ * Commands which are never cancelled for taking too long.
+ */
+#define TEEC_TIMEOUT_INFINITE 0xFFFFFFFF
+
+/* This type denotes a queue of Commands submitted with TEEC_SubmitCommand,
+ * invoked by threads of the queue and reaped with TEEC_WaitCompletions.
+ */
+typedef struct {
+	/* <Implementation-Defined Type> */
+	struct {
+		struct completion_queue *cq;
+	} imp;
+} TEEC_CompletionQueue;
+
+/* This type describes a completed Command.
+ * handle: the handle returned by TEEC_SubmitCommand.
+ * userData: the userData given to TEEC_SubmitCommand.
+ * operation: the Operation given to TEEC_SubmitCommand. Its output values and
+ *      sizes are updated as by TEEC_InvokeCommand.
+ * result: the return code of the Command, as returned by TEEC_InvokeCommand.
+ * returnOrigin: the return origin of the Command.
+ */
+typedef struct {
+	uint64_t handle;
+	void *userData;
+	TEEC_Operation *operation;
+	TEEC_Result result;
+	uint32_t returnOrigin;
+} TEEC_Completion;
+
+/* The maximum number of buffers of a stream. */
+#define TEEC_CONFIG_STREAM_MAX_BUFFERS 8
+
+/* Stream chunk flags, passed to the Trusted Application with each chunk.
+ * TEEC_STREAM_FINAL: the chunk is the last of the payload. It is empty if the
+ *      payload is a multiple of chunkSize long.
+ */
+#define TEEC_STREAM_FINAL 0x00000001
+
+/* This type reads the next bytes of a streamed payload.
+ * userData: the userData of the stream.
+ * buffer: the buffer to read into.
+ * size: the maximum number of bytes to read.
+ * Returns the number of bytes read, 0 at the end of the payload, or -1 if
+ * the payload cannot be read.
+ */
+typedef ssize_t (*TEEC_StreamReadFunction)(void *userData, void *buffer,
+					   size_t size);
+
+/* This type describes a payload streamed to a Trusted Application with
+ * TEEC_InvokeStream.
+ * commandID: the identifier of the Command invoked for each chunk.
+ * numBuffers: the number of chunks in flight, from 2 to
+ *      TEEC_CONFIG_STREAM_MAX_BUFFERS.
+ * chunkSize: the size, in bytes, of each chunk but the last.
+ * read: the function reading the payload, or NULL to read it from fd.
+ * userData: passed to read.
+ * fd: the file descriptor the payload is read from when read is NULL.
+ */
+typedef struct {
+	uint32_t commandID;
+	uint32_t numBuffers;
+	size_t chunkSize;
+	TEEC_StreamReadFunction read;
+	void *userData;
+	int fd;
+} TEEC_StreamConfig;
+
+/* The Commands of the local reference TA, which Sessions are opened with,
+ * whatever their UUID, when the library is built with ENABLE_LOCAL_TA, unless
+ * run with MINKTEEC_LOCAL_TA=0.
+ * TEEC_LOCAL_TA_CMD_ECHO: returns its parameters unchanged, and copies
+ *      parameter 0, a value or memory reference input, into each output-only
+ *      parameter of the same kind. An output memory reference too small for
+ *      it fails with TEEC_ERROR_SHORT_BUFFER and the size required.
+ * TEEC_LOCAL_TA_CMD_MEMFILL: fills the memory reference output in parameter
+ *      0 with the byte in the a member of the value input in parameter 1.
+ * TEEC_LOCAL_TA_CMD_CHECKSUM: returns, in the a member of the value output in
+ *      parameter 1, the 32-bit FNV-1a hash of the memory reference input in
+ *      parameter 0.
+ * TEEC_LOCAL_TA_CMD_SLEEP: waits for the milliseconds in the a member of the
+ *      value input in parameter 0, and fails with TEEC_ERROR_CANCEL if the
+ *      Command is cancelled, or times out, first.
+ * TEEC_LOCAL_TA_CMD_STREAM: hashes the chunks of a payload streamed with
+ *      TEEC_InvokeStream, with FNV-1a. A chunk other than the first of a
+ *      stream, of index 0, or the one after the last fails with
+ *      TEEC_ERROR_BAD_STATE.
+ * TEEC_LOCAL_TA_CMD_STREAM_HASH: returns, in the value output in parameter
+ *      0, the hash of the last stream of the Session whose final chunk was
+ *      processed in the a member, and its number of chunks in the b member.
+ * TEEC_LOCAL_TA_CMD_CRASH: makes the Session defunct, as if the TA crashed:
+ *      the other Commands of the Session which return from then on fail with
+ *      TEEC_ERROR_TARGET_DEAD and origin TEEC_ORIGIN_TEE.
+ */
+#define TEEC_LOCAL_TA_CMD_ECHO        0x00000000
+#define TEEC_LOCAL_TA_CMD_MEMFILL     0x00000001
+#define TEEC_LOCAL_TA_CMD_CHECKSUM    0x00000002
+#define TEEC_LOCAL_TA_CMD_SLEEP       0x00000003
+#define TEEC_LOCAL_TA_CMD_STREAM      0x00000004
+#define TEEC_LOCAL_TA_CMD_STREAM_HASH 0x00000005
+#define TEEC_LOCAL_TA_CMD_CRASH       0x00000006
+
+/* Flag of TEEC_AllocateSharedMemory to back the Shared Memory with a sealed
+ * memfd, which TEEC_ExportSharedMemory hands out for other processes to
+ * import with TEEC_ImportSharedMemory.
+ */
+#define TEEC_MEM_SHAREABLE 0x00000004
+
+/*----------------------------------------------------------------------------
+ * FUNCTION DECLARATIONS AND DOCUMENTATION
+ * -------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Get the statistics of the memory objects which the large Temporary
+ * Memory References of a Context are copied through, when QCOMTEE cannot
+ * share the client's pages in place.
+ *
+ * @param[in] context: the initialized Context.
+ * @param[out] stats: the statistics.
+ * @return: TEEC_SUCCESS: the statistics were returned.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ */
+TEEC_Result TEEC_GetBounceBufferStats(TEEC_Context *context,
+				      TEEC_BounceBufferStats *stats);
+
+/**
+ * @brief Prepare an Operation for repeated Command invocations.
+ *
+ * This function validates the parameter types and parameters of an Operation,
+ * and does the work TEEC_InvokeCommand repeats on every invocation once:
+ * temporary memory references larger than a page are bound to a memory
+ * object, and memory references sharing a memory object are identified.
+ *
+ * The prepared operation keeps a pointer to the Operation. Before each
+ * TEEC_InvokePrepared, the Client Application MAY change:
+ *    the value fields of Value parameters.
+ *    the offset and size fields of Registered Memory References.
+ *    the size field of Temporary Memory References, up to the size it had
+ *       when the Operation was prepared.
+ * Any other change to the Operation makes TEEC_InvokePrepared fail with
+ * TEEC_ERROR_BAD_PARAMETERS. Prepare the Operation with the largest size of
+ * each Temporary Memory Reference.
+ *
+ * @param[in] session: the open Session in which the Operation is invoked.
+ * @param[in] operation: the Operation to prepare. It MUST stay valid until
+ *       the prepared operation is released, as MUST the Shared Memory and
+ *       temporary buffers it refers to.
+ * @param[out] prepared: the prepared operation.
+ * @return: TEEC_SUCCESS: the Operation was prepared.
+ *       TEEC_ERROR_BAD_PARAMETERS: the Operation is not valid.
+ *       Another error code: the Operation could not be prepared.
+ *
+ * Programmer Error: The following usage of the API is a programmer error:
+ *    Closing the Session before releasing the prepared operation.
+ */
+TEEC_Result TEEC_PrepareOperation(TEEC_Session *session,
+				  TEEC_Operation *operation,
+				  TEEC_PreparedOperation *prepared);
+
+/**
+ * @brief Invoke a Command with a prepared Operation.
+ *
+ * This function behaves as TEEC_InvokeCommand with the Operation the prepared
+ * operation was prepared from, and returns output values and sizes in it.
+ * The Operation can be cancelled with TEEC_RequestCancellation.
+ *
+ * @param[in] prepared: the prepared operation.
+ * @param[in] commandID: the identifier of the Command within the Trusted
+ *       Application to invoke.
+ * @param[out] returnOrigin: pointer to a variable which will contain the
+ *       return origin. This field may be NULL if the return origin is not
+ *       needed.
+ * @return: As TEEC_InvokeCommand.
+ *       TEEC_ERROR_BAD_PARAMETERS with return origin TEEC_ORIGIN_API if the
+ *       Operation changed in a way it may not.
+ *
+ * Programmer Error: The following usage of the API is a programmer error:
+ *    Invoking the same prepared operation concurrently from multiple threads.
+ */
+TEEC_Result TEEC_InvokePrepared(TEEC_PreparedOperation *prepared,
+				uint32_t commandID, uint32_t *returnOrigin);
+
+/**
+ * @brief Release a prepared operation.
+ *
+ * The function does nothing if prepared is NULL or was not prepared.
+ *
+ * @param[in] prepared: the prepared operation to release.
+ */
+void TEEC_ReleasePreparedOperation(TEEC_PreparedOperation *prepared);
+
+/**
+ * @brief Invoke a sequence of Commands in a Session.
+ *
+ * This function validates all Operations before invoking any Command, then
+ * has a thread of the library invoke the Commands in order, as
+ * TEEC_InvokeCommand, under one correlation ID, and waits for them. If a
+ * Command fails, the Commands after it are not invoked: their result is
+ * TEEC_ERROR_CANCEL with return origin TEEC_ORIGIN_API.
+ *
+ * Each Command is still a separate invocation of QTEE; the Trusted
+ * Application sees no difference from TEEC_InvokeCommand.
+ *
+ * @param[in] session: the open Session in which the Commands are invoked.
+ * @param[in] numCommands: the number of Commands.
+ * @param[in] commandIDs: the identifiers of the Commands.
+ * @param[in] operations: the optional Operation of each Command. This field
+ *       may be NULL if no Command has one.
+ * @param[out] results: the result of each Command.
+ * @param[out] returnOrigins: the return origin of each Command. This field
+ *       may be NULL if the return origins are not needed.
+ * @return: TEEC_SUCCESS: all Commands completed successfully.
+ *       TEEC_ERROR_BAD_PARAMETERS: an Operation is not valid. No Command was
+ *       invoked.
+ *       Another error code: the result of the Command which failed.
+ */
+TEEC_Result TEEC_InvokeCommandBatch(TEEC_Session *session,
+				    uint32_t numCommands,
+				    const uint32_t *commandIDs,
+				    TEEC_Operation **operations,
+				    TEEC_Result *results,
+				    uint32_t *returnOrigins);
+
+/**
+ * @brief Invoke a Command in several Sessions concurrently.
+ *
+ * This function invokes commandID in each Session, as TEEC_InvokeCommand
+ * with the matching Operation, on threads of a worker pool managed by the
+ * implementation, and returns once all the Commands have completed. The
+ * Sessions may belong to different Contexts.
+ *
+ * Temporary memory references of type TEEC_MEMREF_TEMP_INPUT to the same
+ * buffer and size in several Operations are shared with the Trusted
+ * Applications once, rather than once per Command. The Trusted Applications
+ * MUST NOT rely on such inputs being distinct.
+ *
+ * @param[in] sessions: the open Sessions in which the Command is invoked.
+ * @param[in] num: the number of Sessions.
+ * @param[in] commandID: the identifier of the Command within the Trusted
+ *       Applications to invoke.
+ * @param[in,out] operations: the Operation of each Command, or NULL to
+ *       invoke all of them without an Operation. Entries may be NULL, and
+ *       other entries MUST be distinct.
+ * @param[in] timeout: the time, in milliseconds, the Commands may take
+ *       together. Commands still in flight once it expires are cancelled as
+ *       by TEEC_RequestCancellation, and Commands not yet started complete
+ *       with TEEC_ERROR_CANCEL and return origin TEEC_ORIGIN_API. The
+ *       function returns once the Commands in flight have returned: a
+ *       Trusted Application which ignores the cancellation still holds it,
+ *       as the Operation of its Command is in use.
+ *       TEEC_TIMEOUT_INFINITE never cancels them.
+ * @param[out] results: the result of each Command.
+ * @param[out] returnOrigins: the return origin of each Command. This field
+ *       may be NULL if the return origins are not needed.
+ * @return: TEEC_SUCCESS: every Command completed with TEEC_SUCCESS.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid; no Command
+ *          was invoked.
+ *       Another error code: the result of the first Command, in the order
+ *          of sessions, which failed.
+ */
+TEEC_Result TEEC_InvokeCommandMulti(TEEC_Session **sessions, uint32_t num,
+				    uint32_t commandID,
+				    TEEC_Operation **operations,
+				    uint32_t timeout, TEEC_Result *results,
+				    uint32_t *returnOrigins);
+
+/**
+ * @brief Set the timeout of the Commands invoked in a Context.
+ *
+ * The timeout applies to TEEC_InvokeCommand, TEEC_InvokePrepared,
+ * TEEC_InvokeCommandBatch and TEEC_SubmitCommand in the Sessions of the
+ * Context. It is passed to QTEE with each Command, and once it expires the
+ * Command is cancelled as by TEEC_RequestCancellation: a Trusted Application
+ * waiting for a cancellation, or checking for one, sees it. A Trusted
+ * Application which ignores cancellations still runs the Command to
+ * completion.
+ *
+ * The timeout of a Command starts when it is invoked; for
+ * TEEC_SubmitCommand, when a thread of the queue picks it up. Commands
+ * already invoked keep the timeout they were invoked with. Contexts start
+ * with TEEC_TIMEOUT_INFINITE.
+ *
+ * @param[in] context: the initialized Context.
+ * @param[in] timeout: the time, in milliseconds, a Command may take before it
+ *       is cancelled, or TEEC_TIMEOUT_INFINITE never to cancel it.
+ * @return: TEEC_SUCCESS: the timeout was set.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ */
+TEEC_Result TEEC_SetInvokeTimeout(TEEC_Context *context, uint32_t timeout);
+
+/**
+ * @brief Invoke a Command in a Session with a timeout of its own.
+ *
+ * This function behaves as TEEC_InvokeCommand, with the Command cancelled
+ * once timeout expires as described for TEEC_SetInvokeTimeout, whatever the
+ * timeout of the Context. A Command without an Operation can time out, but
+ * cannot be cancelled with TEEC_RequestCancellation.
+ *
+ * @param[in] session: the open Session in which the Command is invoked.
+ * @param[in] commandID: the identifier of the Command within the Trusted
+ *       Application to invoke.
+ * @param[in,out] operation: the optional Operation, as for
+ *       TEEC_InvokeCommand.
+ * @param[in] timeout: the time, in milliseconds, the Command may take before
+ *       it is cancelled, or TEEC_TIMEOUT_INFINITE never to cancel it.
+ * @param[out] returnOrigin: pointer to a variable which will contain the
+ *       return origin. This field may be NULL if the return origin is not
+ *       needed.
+ * @return: As TEEC_InvokeCommand. A Trusted Application which honours the
+ *       cancellation typically returns TEEC_ERROR_CANCEL.
+ */
+TEEC_Result TEEC_InvokeCommandWithTimeout(TEEC_Session *session,
+					  uint32_t commandID,
+					  TEEC_Operation *operation,
+					  uint32_t timeout,
+					  uint32_t *returnOrigin);
+
+/**
+ * @brief Cancel all outstanding Commands of a Session.
+ *
+ * This function requests the cancellation, as TEEC_RequestCancellation, of
+ * every Command being invoked in the Session, including Commands without an
+ * Operation. Commands submitted to a completion queue in the Session and not
+ * yet started complete with TEEC_ERROR_CANCEL and return origin
+ * TEEC_ORIGIN_API without being invoked. Commands invoked after this
+ * function returns are not affected.
+ *
+ * As for TEEC_RequestCancellation, the function returns without waiting for
+ * the Commands to complete, and the Trusted Application may ignore the
+ * cancellation.
+ *
+ * @param[in] session: the open Session.
+ */
+void TEEC_CancelSession(TEEC_Session *session);
+
+/**
+ * @brief Cancel all outstanding Commands of a Context.
+ *
+ * This function behaves as TEEC_CancelSession for every Session of the
+ * Context, and also cancels the TEEC_OpenSession calls in progress in it.
+ *
+ * @param[in] context: the initialized Context.
+ */
+void TEEC_CancelContext(TEEC_Context *context);
+
+/**
+ * @brief Configure the pool of Sessions of a Context.
+ *
+ * Without a pool, TEEC_CloseSession closes the Session and TEEC_OpenSession
+ * opens a new one with the Trusted Application. With a pool,
+ * TEEC_CloseSession keeps Sessions opened without parameters idle in the
+ * pool, and TEEC_OpenSession without parameters hands out an idle Session
+ * to the same Trusted Application, with the same connection method and
+ * connection data, before opening a new one.
+ *
+ * A pooled Session is the same Session of the Trusted Application: any state
+ * the Trusted Application keeps for it is kept from one use to the next.
+ * Sessions in which a Command failed with a return origin other than
+ * TEEC_ORIGIN_TRUSTED_APP are not pooled.
+ *
+ * Configuring the pool closes the Sessions it holds.
+ *
+ * @param[in] context: the initialized Context.
+ * @param[in] config: the configuration of the pool, NULL to disable it.
+ * @return: TEEC_SUCCESS: the pool was configured.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ *       TEEC_ERROR_OUT_OF_MEMORY: the pool could not be allocated.
+ *
+ * Programmer Error: The following usage of the API is a programmer error:
+ *    Calling this function concurrently with TEEC_OpenSession or
+ *       TEEC_CloseSession in the Context.
+ */
+TEEC_Result TEEC_ConfigureSessionPool(TEEC_Context *context,
+				      const TEEC_SessionPoolConfig *config);
+
+/**
+ * @brief Get the statistics of the pool of Sessions of a Context.
+ *
+ * @param[in] context: the initialized Context.
+ * @param[out] stats: the statistics, all zero if the pool is disabled.
+ * @return: TEEC_SUCCESS: the statistics were returned.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ *
+ * Programmer Error: The following usage of the API is a programmer error:
+ *    Calling this function concurrently with TEEC_ConfigureSessionPool in
+ *       the Context.
+ */
+TEEC_Result TEEC_GetSessionPoolStats(TEEC_Context *context,
+				     TEEC_SessionPoolStats *stats);
+
+/**
+ * @brief Configure the process-wide pool of Contexts.
+ *
+ * Without a pool, TEEC_InitializeContext connects to QTEE anew and
+ * TEEC_FinalizeContext closes the connection. With a pool,
+ * TEEC_FinalizeContext keeps the connection of the Context in the pool, and
+ * TEEC_InitializeContext hands it out to the next Context initialized, in
+ * any thread, before connecting anew.
+ *
+ * Only the connection to QTEE is pooled: Sessions, Shared Memory and the
+ * settings of a Context are not kept from one Context to the next. Before
+ * handing out a connection, the pool checks with one round trip that QTEE
+ * still answers through it, and closes it otherwise.
+ *
+ * The pool can also be configured before the first TEEC_InitializeContext
+ * by setting MINKTEEC_CONTEXT_POOL to the number of Contexts to warm, from 1
+ * to TEEC_CONFIG_CONTEXT_POOL_MAX, in the environment of the process.
+ *
+ * Shrinking the pool closes the connections it no longer has room for.
+ *
+ * @param[in] config: the configuration of the pool, NULL to disable it.
+ * @return: TEEC_SUCCESS: the pool was configured.
+ *       TEEC_ERROR_BAD_PARAMETERS: the configuration is not valid.
+ *       Another error code: the pool could not be warmed.
+ */
+TEEC_Result TEEC_ConfigureContextPool(const TEEC_ContextPoolConfig *config);
+
+/**
+ * @brief Get the statistics of the process-wide pool of Contexts.
+ *
+ * The statistics are counted from when the library is loaded, whether or
+ * not the pool is enabled.
+ *
+ * @param[out] stats: the statistics.
+ * @return: TEEC_SUCCESS: the statistics were retrieved.
+ *       TEEC_ERROR_BAD_PARAMETERS: stats is NULL.
+ */
+TEEC_Result TEEC_GetContextPoolStats(TEEC_ContextPoolStats *stats);
+
+/**
+ * @brief Configure the recovery of the Sessions of a Context.
+ *
+ * Without recovery, a Session whose Trusted Application dies fails every
+ * Command with TEEC_ERROR_TARGET_DEAD and origin TEEC_ORIGIN_TEE until it is
+ * closed, and each thread using it opens a new one. With recovery, the first
+ * Command to find the Session defunct opens it again in place, with the
+ * Trusted Application, connection method and connection data it was opened
+ * with. Commands finding it defunct meanwhile wait for it to be opened
+ * again rather than opening it themselves.
+ *
+ * A Command found in idempotentCommands is then invoked again in the
+ * recovered Session, up to maxRetries times. Other Commands still return
+ * TEEC_ERROR_TARGET_DEAD, and the next Commands are invoked in the recovered
+ * Session.
+ *
+ * Only Sessions opened without an Operation are recovered. The recovered
+ * Session is a new Session of the Trusted Application: any state the Trusted
+ * Application kept for the defunct one is lost.
+ *
+ * Configuring the recovery resets its statistics.
+ *
+ * @param[in] context: the initialized Context.
+ * @param[in] config: the configuration of the recovery, NULL to disable it.
+ * @return: TEEC_SUCCESS: the recovery was configured.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ *       TEEC_ERROR_OUT_OF_MEMORY: the recovery could not be allocated.
+ *
+ * Programmer Error: The following usage of the API is a programmer error:
+ *    Calling this function concurrently with any other function of the
+ *       Context or its Sessions.
+ */
+TEEC_Result
+TEEC_ConfigureSessionRecovery(TEEC_Context *context,
+			      const TEEC_SessionRecoveryConfig *config);
+
+/**
+ * @brief Get the statistics of the recovery of the Sessions of a Context.
+ *
+ * @param[in] context: the initialized Context.
+ * @param[out] stats: the statistics, all zero if recovery is disabled.
+ * @return: TEEC_SUCCESS: the statistics were returned.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ */
+TEEC_Result TEEC_GetSessionRecoveryStats(TEEC_Context *context,
+					 TEEC_SessionRecoveryStats *stats);
+
+/**
+ * @brief Configure the counters of the Sessions of a Context.
+ *
+ * Sessions opened in a Context with counters count, for each Command they
+ * invoke, the invocations, their latency, the bytes passed each way, and
+ * the memory objects and copies they needed. TEEC_GetStatistics returns the
+ * counters of a Session until it is closed.
+ *
+ * Counters can also be enabled in every Context by setting MINKTEEC_STATS
+ * to a signal number in the environment of the process; see
+ * TEEC_DumpStatisticsOnSignal.
+ *
+ * The configuration applies to the Sessions opened afterwards.
+ *
+ * @param[in] context: the initialized Context.
+ * @param[in] config: the configuration of the counters, NULL to disable them.
+ * @return: TEEC_SUCCESS: the counters were configured.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ */
+TEEC_Result TEEC_ConfigureStatistics(TEEC_Context *context,
+				     const TEEC_StatisticsConfig *config);
+
+/**
+ * @brief Get the counters of the Commands of a Session.
+ *
+ * The counters are returned costliest Command first, by totalTime.
+ *
+ * @param[in] session: the open Session.
+ * @param[out] stats: the counters of up to *numStats Commands.
+ * @param[inout] numStats: the number of entries in stats. Set to the number
+ *       of Commands counted in the Session.
+ * @return: TEEC_SUCCESS: the counters of every Command were returned.
+ *       TEEC_ERROR_SHORT_BUFFER: stats is too small; the costliest
+ *          Commands were returned.
+ *       TEEC_ERROR_BAD_STATE: the Session has no counters.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ */
+TEEC_Result TEEC_GetStatistics(TEEC_Session *session,
+			       TEEC_CommandStatistics *stats,
+			       uint32_t *numStats);
+
+/**
+ * @brief Dump the counters of every Session on a signal.
+ *
+ * Once signum is delivered to the process, a thread of the library writes
+ * the counters of the open Sessions with counters to fd, one line per
+ * Command. The signal handler only wakes the thread up.
+ *
+ * Setting MINKTEEC_STATS to a signal number in the environment of the
+ * process enables counters in every Context, and dumps them to the standard
+ * error on that signal.
+ *
+ * @param[in] signum: the signal, e.g. SIGUSR1, replacing its disposition.
+ * @param[in] fd: the file descriptor to write the counters to.
+ * @return: TEEC_SUCCESS: the signal was set up.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ *       TEEC_ERROR_GENERIC: the signal could not be set up.
+ */
+TEEC_Result TEEC_DumpStatisticsOnSignal(int signum, int fd);
+
+/**
+ * @brief Initialize a completion queue.
+ *
+ * The queue starts numThreads threads which invoke the Commands submitted to
+ * it, in the order they are submitted. At most numThreads Commands of the
+ * queue are in flight in QTEE at a time; the others wait in the queue.
+ *
+ * @param[in] numThreads: the number of Commands the queue invokes
+ *       concurrently, from 1 to TEEC_CONFIG_COMPLETION_QUEUE_MAX_THREADS.
+ * @param[out] queue: the completion queue to initialize.
+ * @return: TEEC_SUCCESS: the queue was initialized.
+ *       TEEC_ERROR_BAD_PARAMETERS: numThreads is not valid.
+ *       Another error code: the queue could not be initialized.
+ */
+TEEC_Result TEEC_InitializeCompletionQueue(uint32_t numThreads,
+					   TEEC_CompletionQueue *queue);
+
+/**
+ * @brief Finalize a completion queue.
+ *
+ * Commands which have not started are discarded without being invoked. The
+ * function waits for the Commands being invoked to complete, then discards
+ * the completions not reaped.
+ *
+ * The function does nothing if queue is NULL or was not initialized.
+ *
+ * Programmer Error: The following usage of the API is a programmer error:
+ *    Calling TEEC_SubmitCommand or TEEC_WaitCompletions on the queue
+ *       concurrently with this function.
+ *
+ * @param[in] queue: the completion queue to finalize.
+ */
+void TEEC_FinalizeCompletionQueue(TEEC_CompletionQueue *queue);
+
+/**
+ * @brief Submit a Command to a completion queue.
+ *
+ * This function validates the Operation as TEEC_InvokeCommand and returns
+ * without waiting for the Command. Its completion is reaped with
+ * TEEC_WaitCompletions. The Command can be cancelled with
+ * TEEC_RequestCancellation on the Operation: if it has not started, it
+ * completes with TEEC_ERROR_CANCEL and return origin TEEC_ORIGIN_API without
+ * being invoked.
+ *
+ * @param[in] queue: the completion queue.
+ * @param[in] session: the open Session in which the Command is invoked.
+ * @param[in] commandID: the identifier of the Command within the Trusted
+ *       Application to invoke.
+ * @param[in] operation: the optional Operation. It MUST stay valid until the
+ *       Command is reaped, as MUST the Shared Memory and temporary buffers it
+ *       refers to.
+ * @param[in] userData: returned with the completion of the Command.
+ * @param[out] handle: the handle of the Command, returned with its
+ *       completion. This field may be NULL if not needed.
+ * @return: TEEC_SUCCESS: the Command was submitted.
+ *       TEEC_ERROR_BAD_PARAMETERS: the Operation is not valid.
+ *       Another error code: the Command could not be submitted.
+ *
+ * Programmer Error: The following usage of the API is a programmer error:
+ *    Submitting an Operation which has been submitted and not reaped.
+ *    Closing the Session before the Commands submitted in it are reaped.
+ */
+TEEC_Result TEEC_SubmitCommand(TEEC_CompletionQueue *queue,
+			       TEEC_Session *session, uint32_t commandID,
+			       TEEC_Operation *operation, void *userData,
+			       uint64_t *handle);
+
+/**
+ * @brief Reap completed Commands from a completion queue.
+ *
+ * Completions are returned in the order the Commands complete.
+ *
+ * @param[in] queue: the completion queue.
+ * @param[out] completions: the array to return completions in.
+ * @param[in] maxCompletions: the number of entries of completions.
+ * @param[in] timeout: the time, in milliseconds, to wait for a Command to
+ *       complete if none has. 0 returns at once, TEEC_TIMEOUT_INFINITE waits
+ *       until one does.
+ * @param[out] numCompletions: the number of completions returned, 0 if the
+ *       timeout expired.
+ * @return: TEEC_SUCCESS: numCompletions completions were returned.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid.
+ */
+TEEC_Result TEEC_WaitCompletions(TEEC_CompletionQueue *queue,
+				 TEEC_Completion *completions,
+				 uint32_t maxCompletions, uint32_t timeout,
+				 uint32_t *numCompletions);
+
+/**
+ * @brief Get a file descriptor signalling completions.
+ *
+ * The file descriptor is readable, as reported by poll(), select() and epoll,
+ * while the queue holds completions not reaped. Reap them with
+ * TEEC_WaitCompletions; do not read from or close the file descriptor.
+ *
+ * @param[in] queue: the completion queue.
+ * @return: The file descriptor, or -1 if queue is not valid.
+ */
+int TEEC_GetCompletionQueueFd(TEEC_CompletionQueue *queue);
+
+/**
+ * @brief Stream a payload to a Trusted Application.
+ *
+ * This function reads the payload in chunks of chunkSize bytes into
+ * numBuffers Shared Memory buffers, and invokes commandID once for each
+ * chunk, in order, with the parameters:
+ *    params[0]: TEEC_MEMREF_PARTIAL_INPUT, the chunk.
+ *    params[1]: TEEC_VALUE_INPUT, a is the index of the chunk and b the
+ *       stream chunk flags.
+ * The next chunks are read while the Trusted Application processes the
+ * current one, up to numBuffers chunks in flight.
+ *
+ * The stream stops at the first Command which fails; the chunks already
+ * read are then not invoked.
+ *
+ * @param[in] session: the open Session in which the Commands are invoked.
+ * @param[in] config: the payload and how to stream it.
+ * @param[out] returnOrigin: pointer to a variable which will contain the
+ *       return origin. This field may be NULL if the return origin is not
+ *       needed.
+ * @return: TEEC_SUCCESS: every chunk was processed.
+ *       TEEC_ERROR_BAD_PARAMETERS: the configuration is not valid.
+ *       TEEC_ERROR_GENERIC with origin TEEC_ORIGIN_API: the payload could
+ *          not be read.
+ *       Another error code: the result of the Command which failed.
+ */
+TEEC_Result TEEC_InvokeStream(TEEC_Session *session,
+			      const TEEC_StreamConfig *config,
+			      uint32_t *returnOrigin);
+
+/**
+ * @brief Get a file descriptor to share a Shared Memory with another process.
+ *
+ * The Shared Memory MUST have been allocated with the TEEC_MEM_SHAREABLE
+ * flag. Its memory is a memfd sealed against shrinking, growing and further
+ * sealing, which the returned file descriptor refers to. Pass it to the
+ * other process, e.g. over a UNIX socket with SCM_RIGHTS, to import with
+ * TEEC_ImportSharedMemory: both processes then reference the same pages.
+ *
+ * The Shared Memory MUST NOT be released before the other process imported
+ * it if it is to see the data already written.
+ *
+ * @param[in] sharedMem: the Shared Memory to export.
+ * @param[out] fd: the file descriptor, close-on-exec. The caller closes it.
+ * @return: TEEC_SUCCESS: fd refers to the memory of the Shared Memory.
+ *       TEEC_ERROR_BAD_PARAMETERS: the Shared Memory is not shareable.
+ *       TEEC_ERROR_GENERIC: the file descriptor could not be duplicated.
+ */
+TEEC_Result TEEC_ExportSharedMemory(TEEC_SharedMemory *sharedMem, int *fd);
+
+/**
+ * @brief Register the memory another process exported with
+ * TEEC_ExportSharedMemory as a Shared Memory.
+ *
+ * This function maps the memfd, which MUST be sealed against shrinking, and
+ * registers it as TEEC_RegisterSharedMemory registers client memory: the
+ * Trusted Application accesses the same pages as the exporting process if
+ * QTEE supports it. The Shared Memory is released with
+ * TEEC_ReleaseSharedMemory, which unmaps it.
+ *
+ * @param[in] context: a pointer to an initialized TEE Context.
+ * @param[in,out] sharedMem: the Shared Memory. The flags field is set as for
+ *       TEEC_RegisterSharedMemory, and the size field to the size to map from
+ *       the start of the memfd, or 0 for all of it. The buffer and size
+ *       fields are set to the memory mapped on success.
+ * @param[in] fd: the file descriptor. The function does not close it.
+ * @return: TEEC_SUCCESS: the memory was imported.
+ *       TEEC_ERROR_BAD_PARAMETERS: the arguments are not valid, or fd is not
+ *          a memfd sealed against shrinking.
+ *       TEEC_ERROR_OUT_OF_MEMORY: the memory is too large.
+ *       Another error code: the memory could not be imported.
+ */
+TEEC_Result TEEC_ImportSharedMemory(TEEC_Context *context,
+				    TEEC_SharedMemory *sharedMem, int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TEE_CLIENT_API_EXT_H_
@@ -0,0 +1,562 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mink_teec.h"
+#include "MinkCom.h"
+
+#include "CGPLocal_open.h"
+#include "IGPAppClient.h"
+#include "IGPAppClient_invoke.h"
+#include "IGPSession_invoke.h"
+#include "IWait.h"
+
+#define FNV1A_OFFSET_BASIS 0x811C9DC5U
+#define FNV1A_PRIME        0x01000193U
+
+#define TEE_PARAM_TYPE_VALUE_INPUT  1
+#define TEE_PARAM_TYPE_VALUE_OUTPUT 2
+#define TEE_PARAM_TYPE_VALUE_INOUT  3
+
+/* A parameter of a command, as the TA sees it: the memory of memory
+ * references passed as memory objects is accessed in place.
+ */
+struct local_param {
+	uint32_t type;
+	/* The contents sent by the client, NULL for outputs */
+	const void *in;
+	size_t in_len;
+	/* The room for the contents returned, NULL for inputs */
+	void *out;
+	size_t out_len;
+	/* The size of the contents returned */
+	size_t *out_lenout;
+	uint32_t *mem_sz_out;
+};
+
+typedef struct {
+	atomic_int refs;
+} CGPLocalAppClient;
+
+typedef struct {
+	atomic_int refs;
+	/* The CWait object of the context, to wait for cancellations on */
+	Object waiter_cbo;
+	/* Set by TEEC_LOCAL_TA_CMD_CRASH */
+	atomic_bool crashed;
+	/* The stream being hashed, whose chunks come one at a time */
+	uint32_t next_chunk;
+	uint32_t stream_hash;
+	/* The last stream whose final chunk was hashed */
+	uint32_t last_hash;
+	uint32_t last_chunks;
+} CGPLocalSession;
+
+static bool is_value(const struct local_param *p)
+{
+	return p->type >= TEE_PARAM_TYPE_VALUE_INPUT &&
+	       p->type <= TEE_PARAM_TYPE_VALUE_INOUT;
+}
+
+static bool is_memref(const struct local_param *p)
+{
+	return p->type >= TEE_PARAM_TYPE_MEMREF_INPUT &&
+	       p->type <= TEE_PARAM_TYPE_MEMREF_INOUT;
+}
+
+/**
+ * @brief Return the size of the contents of an output parameter.
+ *
+ * A size larger than the room of a memory reference reports the size
+ * required to the client.
+ */
+static void set_out_size(struct local_param *p, size_t size)
+{
+	*p->out_lenout = size < p->out_len ? size : p->out_len;
+
+	if (is_memref(p))
+		*p->mem_sz_out = (uint32_t)size;
+}
+
+/**
+ * @brief Set up a parameter of a command from the buffers and memory object
+ * the skeleton unmarshalled.
+ *
+ * @param params The parameters, of which those before i are set up.
+ * @param imem The memory objects of the parameters.
+ * @param i The index of the parameter.
+ * @param ex_type The extended type of the parameter.
+ * @return TEEC_SUCCESS on success.
+ *         TEEC_ERROR_BAD_PARAMETERS if the parameter is malformed.
+ */
+static TEEC_Result local_param_init(struct local_param *params,
+				   const Object *imem, size_t i,
+				   uint32_t ex_type)
+{
+	struct local_param *p = &params[i];
+	const MemoryObjectParams *mop = p->in;
+	Object mo = imem[i];
+	uint8_t *addr = NULL;
+	size_t size = 0;
+
+	/* Buffers the type does not use are ignored */
+	if (!is_value(p) && !is_memref(p)) {
+		p->in = NULL;
+		p->in_len = 0;
+	}
+
+	if (p->type == TEE_PARAM_TYPE_VALUE_INPUT ||
+	    p->type == TEE_PARAM_TYPE_MEMREF_INPUT || !p->out) {
+		p->out = NULL;
+		p->out_len = 0;
+	}
+
+	if (is_value(p)) {
+		if (p->type == TEE_PARAM_TYPE_VALUE_OUTPUT) {
+			p->in = NULL;
+			p->in_len = 0;
+		}
+
+		if (p->type != TEE_PARAM_TYPE_VALUE_OUTPUT &&
+		    (!p->in || p->in_len != sizeof(TEEC_Value)))
+			return TEEC_ERROR_BAD_PARAMETERS;
+
+		if (p->type != TEE_PARAM_TYPE_VALUE_INPUT &&
+		    (!p->out || p->out_len != sizeof(TEEC_Value)))
+			return TEEC_ERROR_BAD_PARAMETERS;
+
+		return TEEC_SUCCESS;
+	}
+
+	if (!is_memref(p) || Object_isNull(mo) ||
+	    ex_type == TEE_EX_PARAM_TYPE_MEMREF_NULL) {
+		if (p->type == TEE_PARAM_TYPE_MEMREF_OUTPUT ||
+		    ex_type == TEE_EX_PARAM_TYPE_MEMREF_NULL) {
+			p->in = NULL;
+			p->in_len = 0;
+		}
+
+		return TEEC_SUCCESS;
+	}
+
+	/* The buffer holds where the memory reference is in the memory object.
+	 * The library passes the memory object of an earlier parameter again
+	 * with the TEE_EX_PARAM_TYPE_MEMREF_DUP references reusing it.
+	 */
+	if (p->in_len != sizeof(*mop))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (MinkCom_getMemoryObjectInfo(mo, (void **)&addr, &size))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (mop->offset > size || mop->size > size - mop->offset)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	addr += mop->offset;
+	size = (size_t)mop->size;
+
+	p->in = p->type == TEE_PARAM_TYPE_MEMREF_OUTPUT ? NULL : addr;
+	p->in_len = size;
+	p->out = p->type == TEE_PARAM_TYPE_MEMREF_INPUT ? NULL : addr;
+	p->out_len = size;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Return the parameters unchanged, and copy parameter 0 into each
+ * output-only parameter of its kind.
+ */
+static TEEC_Result local_echo(struct local_param *params)
+{
+	struct local_param *src = &params[0];
+	struct local_param *p = NULL;
+	TEEC_Result ret = TEEC_SUCCESS;
+	size_t len = 0;
+
+	for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+		p = &params[i];
+		if (!p->out)
+			continue;
+
+		/* In place, or through separate buffers */
+		if (p->in) {
+			len = p->in_len < p->out_len ? p->in_len : p->out_len;
+			if (p->out != p->in)
+				memmove(p->out, p->in, len);
+			set_out_size(p, p->in_len);
+			continue;
+		}
+
+		if (i == 0 || !src->in || is_value(p) != is_value(src)) {
+			set_out_size(p, 0);
+			continue;
+		}
+
+		if (src->in_len > p->out_len)
+			ret = TEEC_ERROR_SHORT_BUFFER;
+		else
+			memmove(p->out, src->in, src->in_len);
+
+		set_out_size(p, src->in_len);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Fill the memory reference output in parameter 0 with the byte in
+ * the value input in parameter 1.
+ */
+static TEEC_Result local_memfill(struct local_param *params)
+{
+	const TEEC_Value *fill = params[1].in;
+
+	if (!is_memref(&params[0]) || !params[0].out ||
+	    params[1].type != TEE_PARAM_TYPE_VALUE_INPUT)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	memset(params[0].out, (uint8_t)fill->a, params[0].out_len);
+	set_out_size(&params[0], params[0].out_len);
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Return in the value output in parameter 1 the FNV-1a hash of the
+ * memory reference input in parameter 0.
+ */
+static TEEC_Result local_checksum(struct local_param *params)
+{
+	const uint8_t *data = params[0].in;
+	TEEC_Value *sum = params[1].out;
+	uint32_t hash = FNV1A_OFFSET_BASIS;
+
+	if (params[0].type != TEE_PARAM_TYPE_MEMREF_INPUT ||
+	    params[1].type != TEE_PARAM_TYPE_VALUE_OUTPUT)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	for (size_t i = 0; data && i < params[0].in_len; i++) {
+		hash ^= data[i];
+		hash *= FNV1A_PRIME;
+	}
+
+	sum->a = hash;
+	sum->b = 0;
+	set_out_size(&params[1], sizeof(*sum));
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Wait for the milliseconds in the value input in parameter 0, as
+ * TEE_Wait() does, unless the command is cancelled first.
+ */
+static TEEC_Result local_sleep(CGPLocalSession *me, uint32_t cancel_code,
+			       uint32_t timeout, struct local_param *params)
+{
+	const TEEC_Value *msec = params[0].in;
+	uint32_t wait = 0;
+	uint32_t events = 0;
+
+	if (params[0].type != TEE_PARAM_TYPE_VALUE_INPUT)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	/* QTEE cancels the command itself once its timeout expires */
+	wait = msec->a < timeout ? msec->a : timeout;
+
+	if (IWait_wait(me->waiter_cbo, wait, cancel_code, IWait_EVENT_CANCEL,
+		       &events))
+		return TEEC_ERROR_GENERIC;
+
+	if ((events & IWait_EVENT_CANCEL) || wait < msec->a)
+		return TEEC_ERROR_CANCEL;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Hash the chunk of a stream in parameter 0, whose index and flags are
+ * in the value input in parameter 1, into the stream of the session.
+ */
+static TEEC_Result local_stream(CGPLocalSession *me,
+				struct local_param *params)
+{
+	const uint8_t *data = params[0].in;
+	const TEEC_Value *chunk = params[1].in;
+
+	if (params[0].type != TEE_PARAM_TYPE_MEMREF_INPUT ||
+	    params[1].type != TEE_PARAM_TYPE_VALUE_INPUT)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	/* The first chunk starts a new stream, the others continue it */
+	if (!chunk->a)
+		me->stream_hash = FNV1A_OFFSET_BASIS;
+	else if (chunk->a != me->next_chunk)
+		return TEEC_ERROR_BAD_STATE;
+
+	for (size_t i = 0; data && i < params[0].in_len; i++) {
+		me->stream_hash ^= data[i];
+		me->stream_hash *= FNV1A_PRIME;
+	}
+
+	me->next_chunk = chunk->a + 1;
+
+	if (chunk->b & TEEC_STREAM_FINAL) {
+		me->last_hash = me->stream_hash;
+		me->last_chunks = me->next_chunk;
+		me->next_chunk = 0;
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Return in the value output in parameter 0 the hash and number of
+ * chunks of the last stream of the session.
+ */
+static TEEC_Result local_stream_hash(CGPLocalSession *me,
+				     struct local_param *params)
+{
+	TEEC_Value *hash = params[0].out;
+
+	if (params[0].type != TEE_PARAM_TYPE_VALUE_OUTPUT)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	hash->a = me->last_hash;
+	hash->b = me->last_chunks;
+	set_out_size(&params[0], sizeof(*hash));
+
+	return TEEC_SUCCESS;
+}
+
+static int32_t CGPLocalSession_retain(CGPLocalSession *me)
+{
+	atomic_fetch_add(&me->refs, 1);
+	return Object_OK;
+}
+
+static int32_t CGPLocalSession_release(CGPLocalSession *me)
+{
+	if (atomic_fetch_sub(&me->refs, 1) == 1) {
+		Object_ASSIGN_NULL(me->waiter_cbo);
+		free(me);
+	}
+
+	return Object_OK;
+}
+
+static int32_t CGPLocalSession_close(CGPLocalSession *me)
+{
+	(void)me;
+
+	return Object_OK;
+}
+
+static int32_t CGPLocalSession_invokeCommand(
+	CGPLocalSession *me, uint32_t commandID, uint32_t cancelCode,
+	uint32_t cancellationRequestTimeout, uint32_t paramTypes,
+	uint32_t exParamTypes, const void *i1, size_t i1_len, const void *i2,
+	size_t i2_len, const void *i3, size_t i3_len, const void *i4,
+	size_t i4_len, void *o1, size_t o1_len, size_t *o1_lenout, void *o2,
+	size_t o2_len, size_t *o2_lenout, void *o3, size_t o3_len,
+	size_t *o3_lenout, void *o4, size_t o4_len, size_t *o4_lenout,
+	Object imem1, Object imem2, Object imem3, Object imem4,
+	uint32_t *memrefOutSz1, uint32_t *memrefOutSz2,
+	uint32_t *memrefOutSz3, uint32_t *memrefOutSz4, uint32_t *retValue,
+	uint32_t *retOrigin)
+{
+	struct local_param params[MAX_NUM_PARAMS] = {
+		{ 0, i1, i1_len, o1, o1_len, o1_lenout, memrefOutSz1 },
+		{ 0, i2, i2_len, o2, o2_len, o2_lenout, memrefOutSz2 },
+		{ 0, i3, i3_len, o3, o3_len, o3_lenout, memrefOutSz3 },
+		{ 0, i4, i4_len, o4, o4_len, o4_lenout, memrefOutSz4 },
+	};
+	const Object imem[MAX_NUM_PARAMS] = { imem1, imem2, imem3, imem4 };
+	TEEC_Result ret = TEEC_SUCCESS;
+
+	for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+		params[i].type = TEEC_PARAM_TYPE_GET(paramTypes, i);
+		*params[i].out_lenout = 0;
+
+		ret = local_param_init(params, imem, i,
+				       TEEC_PARAM_TYPE_GET(exParamTypes, i));
+		if (ret)
+			goto out;
+	}
+
+	switch (commandID) {
+	case TEEC_LOCAL_TA_CMD_ECHO:
+		ret = local_echo(params);
+		break;
+	case TEEC_LOCAL_TA_CMD_MEMFILL:
+		ret = local_memfill(params);
+		break;
+	case TEEC_LOCAL_TA_CMD_CHECKSUM:
+		ret = local_checksum(params);
+		break;
+	case TEEC_LOCAL_TA_CMD_SLEEP:
+		ret = local_sleep(me, cancelCode, cancellationRequestTimeout,
+				  params);
+		break;
+	case TEEC_LOCAL_TA_CMD_STREAM:
+		ret = local_stream(me, params);
+		break;
+	case TEEC_LOCAL_TA_CMD_STREAM_HASH:
+		ret = local_stream_hash(me, params);
+		break;
+	case TEEC_LOCAL_TA_CMD_CRASH:
+		atomic_store(&me->crashed, true);
+		*retValue = TEEC_SUCCESS;
+		*retOrigin = TEEC_ORIGIN_TRUSTED_APP;
+		return Object_OK;
+	default:
+		ret = TEEC_ERROR_NOT_SUPPORTED;
+		break;
+	}
+
+out:
+	/* QTEE fails the commands of a crashed TA itself */
+	if (atomic_load(&me->crashed))
+		return Object_ERROR_DEFUNCT;
+
+	*retValue = ret;
+	*retOrigin = TEEC_ORIGIN_TRUSTED_APP;
+
+	return Object_OK;
+}
+
+static IGPSession_DEFINE_INVOKE(CGPLocalSession_invoke, CGPLocalSession_,
+				CGPLocalSession *)
+
+static int32_t CGPLocalAppClient_retain(CGPLocalAppClient *me)
+{
+	atomic_fetch_add(&me->refs, 1);
+	return Object_OK;
+}
+
+static int32_t CGPLocalAppClient_release(CGPLocalAppClient *me)
+{
+	if (atomic_fetch_sub(&me->refs, 1) == 1)
+		free(me);
+
+	return Object_OK;
+}
+
+static int32_t CGPLocalAppClient_openSessionV2(
+	CGPLocalAppClient *me, const void *uuid, size_t uuid_len,
+	Object waitCBO, uint32_t cancelCode,
+	uint32_t cancellationRequestTimeout, uint32_t connectionMethod,
+	uint32_t connectionData, uint32_t paramTypes, uint32_t exParamTypes,
+	const void *i1, size_t i1_len, const void *i2, size_t i2_len,
+	const void *i3, size_t i3_len, const void *i4, size_t i4_len,
+	void *o1, size_t o1_len, size_t *o1_lenout, void *o2, size_t o2_len,
+	size_t *o2_lenout, void *o3, size_t o3_len, size_t *o3_lenout,
+	void *o4, size_t o4_len, size_t *o4_lenout, Object imem1,
+	Object imem2, Object imem3, Object imem4, uint32_t *memrefOutSz1,
+	uint32_t *memrefOutSz2, uint32_t *memrefOutSz3,
+	uint32_t *memrefOutSz4, Object *session, uint32_t *retValue,
+	uint32_t *retOrigin)
+{
+	CGPLocalSession *s = NULL;
+
+	/* The local TA takes no parameters to open a session */
+	(void)me;
+	(void)uuid;
+	(void)cancelCode;
+	(void)cancellationRequestTimeout;
+	(void)connectionMethod;
+	(void)connectionData;
+	(void)paramTypes;
+	(void)exParamTypes;
+	(void)i1;
+	(void)i1_len;
+	(void)i2;
+	(void)i2_len;
+	(void)i3;
+	(void)i3_len;
+	(void)i4;
+	(void)i4_len;
+	(void)o1;
+	(void)o1_len;
+	(void)o2;
+	(void)o2_len;
+	(void)o3;
+	(void)o3_len;
+	(void)o4;
+	(void)o4_len;
+	(void)imem1;
+	(void)imem2;
+	(void)imem3;
+	(void)imem4;
+	(void)memrefOutSz1;
+	(void)memrefOutSz2;
+	(void)memrefOutSz3;
+	(void)memrefOutSz4;
+
+	if (uuid_len != sizeof(TEEC_UUID))
+		return IGPAppClient_ERROR_INVALID_UUID_LEN;
+
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return Object_ERROR_KMEM;
+
+	s->refs = 1;
+	Object_INIT(s->waiter_cbo, waitCBO);
+
+	*o1_lenout = 0;
+	*o2_lenout = 0;
+	*o3_lenout = 0;
+	*o4_lenout = 0;
+
+	*session = (Object){ CGPLocalSession_invoke, s };
+	*retValue = TEEC_SUCCESS;
+	*retOrigin = TEEC_ORIGIN_TRUSTED_APP;
+
+	return Object_OK;
+}
+
+static int32_t CGPLocalAppClient_openSession(
+	CGPLocalAppClient *me, const void *uuid, size_t uuid_len,
+	Object waitCBO, uint32_t cancelCode, uint32_t connectionMethod,
+	uint32_t connectionData, uint32_t paramTypes, uint32_t exParamTypes,
+	const void *i1, size_t i1_len, const void *i2, size_t i2_len,
+	const void *i3, size_t i3_len, const void *i4, size_t i4_len,
+	void *o1, size_t o1_len, size_t *o1_lenout, void *o2, size_t o2_len,
+	size_t *o2_lenout, void *o3, size_t o3_len, size_t *o3_lenout,
+	void *o4, size_t o4_len, size_t *o4_lenout, Object imem1,
+	Object imem2, Object imem3, Object imem4, uint32_t *memrefOutSz1,
+	uint32_t *memrefOutSz2, uint32_t *memrefOutSz3,
+	uint32_t *memrefOutSz4, Object *session, uint32_t *retValue,
+	uint32_t *retOrigin)
+{
+	return CGPLocalAppClient_openSessionV2(
+		me, uuid, uuid_len, waitCBO, cancelCode,
+		MINK_TEEC_TIMEOUT_INFINITE, connectionMethod, connectionData,
+		paramTypes, exParamTypes, i1, i1_len, i2, i2_len, i3, i3_len,
+		i4, i4_len, o1, o1_len, o1_lenout, o2, o2_len, o2_lenout, o3,
+		o3_len, o3_lenout, o4, o4_len, o4_lenout, imem1, imem2, imem3,
+		imem4, memrefOutSz1, memrefOutSz2, memrefOutSz3, memrefOutSz4,
+		session, retValue, retOrigin);
+}
+
+static IGPAppClient_DEFINE_INVOKE(CGPLocalAppClient_invoke,
+				  CGPLocalAppClient_, CGPLocalAppClient *)
+
+int32_t CGPLocal_open(Object *objOut)
+{
+	CGPLocalAppClient *me = calloc(1, sizeof(*me));
+
+	if (!me)
+		return Object_ERROR_KMEM;
+
+	me->refs = 1;
+
+	*objOut = (Object){ CGPLocalAppClient_invoke, me };
+	return Object_OK;
+}
@@ -0,0 +1,28 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "object.h"
+
+/* Local reference TA.
+ *
+ * An IGPAppClient implemented in the library itself, whose IGPSession objects
+ * implement the TEEC_LOCAL_TA_CMD_* commands in the calling process. It is
+ * only built into libraries built with ENABLE_LOCAL_TA, which define
+ * MINKTEEC_LOCAL_TA to whether sessions are opened with it by default. Sessions
+ * are then opened with it, whatever their UUID, rather than with QTEE unless
+ * run with MINKTEEC_LOCAL_TA=0, so clients and the library can be exercised
+ * without a TA.
+ *
+ * Memory objects are still allocated and registered through QCOMTEE.
+ */
+
+/**
+ * @brief Create the AppClient object of the local reference TA.
+ *
+ * @param objOut The AppClient object.
+ * @return Object_OK on success.
+ *         Object_ERROR_KMEM if out of memory.
+ */
+int32_t CGPLocal_open(Object *objOut);
@@ -2,11 +2,13 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include <errno.h>
+#include <linux/futex.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/syscall.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -18,43 +20,55 @@
 
 #include "qlist.h"
 
-#define TYPE_WAITER_ITEM 0
-#define TYPE_SIGNAL_ITEM 1
-
 #define MSEC_PER_SEC (1000L)
 
-typedef struct {
-	uint32_t events;
-	uint32_t code;
-	bool signaled;
-	/* Protect the CV */
-	pthread_mutex_t mutex;
-	pthread_cond_t condition;
-} waiter_item;
+/* Waiter and signal items are hashed by code into CWAIT_BUCKETS buckets, so
+ * that finding the item for a code does not scan the items of every
+ * outstanding operation, and operations with different cancel codes do not
+ * contend for one lock. Items with code 0, which match any code, are kept in
+ * a bucket of their own.
+ */
+#define CWAIT_BUCKETS  256
+#define CWAIT_WILDCARD CWAIT_BUCKETS
+
+/* Items freed are kept for reuse, up to CWAIT_BUCKET_FREE per bucket. */
+#define CWAIT_BUCKET_FREE 4
 
 typedef struct {
+	QNode qn;
+
 	uint32_t events;
 	uint32_t code;
-} signal_item;
+	/* Waiter items only: the futex word, set to 1 once signalled */
+	atomic_uint signaled;
+} wait_item;
 
 typedef struct {
-	QNode qn;
-
-	uint8_t type;
-	union {
-		waiter_item w_item;
-		signal_item s_item;
-	} item;
-} list_item;
+	QList waiters;
+	QList signals;
+	QList free;
+	size_t num_free;
+	/* Protect the QLists and the waiter items in them */
+	pthread_mutex_t lock;
+} wait_bucket;
 
 typedef struct {
 	atomic_int refs;
 
-	QList list;
-	/* Protect the QList */
-	pthread_mutex_t lock;
+	/* Signals lock the wildcard bucket while holding the lock of the bucket
+	 * of their code, never the other way round.
+	 */
+	wait_bucket buckets[CWAIT_BUCKETS + 1];
 } CWait;
 
+static wait_bucket *bucket_of(CWait *me, uint32_t code)
+{
+	if (!code)
+		return &me->buckets[CWAIT_WILDCARD];
+
+	return &me->buckets[code & (CWAIT_BUCKETS - 1)];
+}
+
 static int32_t CWait_retain(CWait *me)
 {
 	atomic_fetch_add(&me->refs, 1);
@@ -73,263 +87,219 @@ static void QList_free(QList *list)
 static int32_t CWait_release(CWait *me)
 {
 	if (atomic_fetch_sub(&me->refs, 1) == 1) {
-		QList_free(&me->list);
-		pthread_mutex_destroy(&me->lock);
+		for (size_t i = 0; i <= CWAIT_BUCKETS; i++) {
+			QList_free(&me->buckets[i].waiters);
+			QList_free(&me->buckets[i].signals);
+			QList_free(&me->buckets[i].free);
+			pthread_mutex_destroy(&me->buckets[i].lock);
+		}
 		free(me);
 	}
 
 	return Object_OK;
 }
 
+/**
+ * @brief Get an item from the free items of a bucket, or allocate one.
+ * Called with the lock of the bucket held.
+ *
+ * @param bucket The bucket.
+ * @param code The unique identifier code of the item.
+ * @param events The type of event of the item.
+ * @return wait_item The item.
+ *         NULL on failure.
+ */
+static wait_item *get_item(wait_bucket *bucket, uint32_t code, uint32_t events)
+{
+	wait_item *item = (wait_item *)QList_pop(&bucket->free);
+
+	if (item) {
+		bucket->num_free--;
+	} else {
+		item = (wait_item *)malloc(sizeof(wait_item));
+		if (!item)
+			return NULL;
+	}
+
+	QNode_construct(&item->qn);
+	item->events = events;
+	item->code = code;
+	atomic_init(&item->signaled, 0);
+
+	return item;
+}
+
+/**
+ * @brief Dequeue an item and return it to the free items of a bucket, or free
+ * it. Called with the lock of the bucket held.
+ *
+ * @param bucket The bucket.
+ * @param item The item.
+ */
+static void put_item(wait_bucket *bucket, wait_item *item)
+{
+	QNode_dequeue(&item->qn);
+
+	if (bucket->num_free == CWAIT_BUCKET_FREE) {
+		free(item);
+		return;
+	}
+
+	QList_appendNode(&bucket->free, &item->qn);
+	bucket->num_free++;
+}
+
+static long futex_wait(atomic_uint *word, uint32_t val,
+		       const struct timespec *deadline)
+{
+	/* FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline */
+	return syscall(SYS_futex, word, FUTEX_WAIT_BITSET_PRIVATE, val,
+		       deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+}
+
+static void futex_wake(atomic_uint *word)
+{
+	syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
 /**
  * @brief Signal the waiter with the specified event(s).
  *
- * @param list A pointer to the list of waiter/signal items.
+ * @param bucket The bucket of waiter items.
  * @param code The unique identifier code for the event to signal.
  * @param events The type of event to signal.
  * @return bool TRUE if the waiter was signalled.
  *              FALSE if the waiter wasn't signalled.
  */
-static bool signal_waiter_item(QList *list, uint32_t code, uint32_t events)
+static bool signal_waiter_item(wait_bucket *bucket, uint32_t code,
+			       uint32_t events)
 {
 	QNode *node = NULL;
-	list_item *l_item = NULL;
-	waiter_item *w_item = NULL;
-	bool signaled = false;
+	wait_item *w_item = NULL;
 
-	QLIST_FOR_ALL(list, node)
+	QLIST_FOR_ALL(&bucket->waiters, node)
 	{
-		l_item = (list_item *)node;
-		if (l_item->type != TYPE_WAITER_ITEM)
+		w_item = (wait_item *)node;
+		if (atomic_load(&w_item->signaled))
 			continue;
 
-		w_item = &l_item->item.w_item;
 		if ((w_item->events & events) &&
 		    ((w_item->code == 0 || w_item->code == code))) {
-			pthread_mutex_lock(&w_item->mutex);
-
-			w_item->signaled = true;
 			w_item->events &= events;
 
-			/* Match, wake up the waiter! */
-			pthread_cond_signal(&w_item->condition);
-			signaled = true;
-
-			pthread_mutex_unlock(&w_item->mutex);
+			/* Match, wake up the waiter! The waiter dequeues the
+			 * item under the lock of the bucket, so it is still
+			 * there for the wake up.
+			 */
+			atomic_store(&w_item->signaled, 1);
+			futex_wake(&w_item->signaled);
 
 			/* Multiple (event, code) pairs not possible */
-			break;
+			return true;
 		}
 	}
 
-	return signaled;
+	return false;
 }
 
 /**
- * @brief Find a signal item in the waiter/signal list.
+ * @brief Find a signal item in a bucket and consume it.
  *
- * @param list A pointer to the list of waiter/signal items.
+ * @param bucket The bucket of signal items.
  * @param code The unique identifier code for the event to signal.
  * @param events The type of event to signal.
  * @param events_out The type of event returned to QTEE.
  * @return bool TRUE if the signal item was found.
  *              FALSE if the signal item was not found.
  */
-static bool get_signal_item(QList *list, uint32_t code, uint32_t events,
-			    uint32_t *events_out)
+static bool get_signal_item(wait_bucket *bucket, uint32_t code,
+			    uint32_t events, uint32_t *events_out)
 {
 	QNode *node = NULL;
-	list_item *l_item = NULL;
-	signal_item *s_item = NULL;
-	bool found = false;
+	wait_item *s_item = NULL;
 
-	QLIST_FOR_ALL(list, node)
+	QLIST_FOR_ALL(&bucket->signals, node)
 	{
-		l_item = (list_item *)node;
-		if (l_item->type != TYPE_SIGNAL_ITEM)
-			continue;
-
-		s_item = &l_item->item.s_item;
+		s_item = (wait_item *)node;
 		if ((s_item->events & events) &&
 		    ((s_item->code == code || s_item->code == 0))) {
 			*events_out = (s_item->events & events);
 
-			found = true;
-			break;
+			put_item(bucket, s_item);
+			return true;
 		}
 	}
 
-	if (found) {
-		QNode_dequeue(node);
-		free(l_item);
-	}
-
-	return found;
-}
-
-/**
- * @brief Adds a signal item to the waiter/signal list.
- *
- * @param list A pointer to the list of waiter/signal items.
- * @param code The unique identifier code for the event to signal.
- * @param events The type of event to signal.
- * @return list_item The newly queued signal item.
- *         NULL on failure.
- */
-static list_item *queue_signal_item(QList *list, uint32_t code, uint32_t events)
-{
-	list_item *l_item = (list_item *)malloc(sizeof(list_item));
-	if (!l_item)
-		return NULL;
-
-	l_item->type = TYPE_SIGNAL_ITEM;
-	l_item->item.s_item.events = events;
-	l_item->item.s_item.code = code;
-
-	QList_appendNode(list, (QNode *)l_item);
-
-	return l_item;
-}
-
-/**
- * @brief Adds a waiter item to the waiter/signal list.
- *
- * @param list A pointer to the list of waiter/signal items.
- * @param code The unique identifier code for the event to wait for.
- * @param events The type of event to wait for.
- * @return list_item The newly queued waiter item.
- *         NULL on failure.
- */
-static list_item *queue_waiter_item(QList *list, uint32_t code, uint32_t events)
-{
-	list_item *l_item = (list_item *)malloc(sizeof(list_item));
-	if (!l_item)
-		return NULL;
-
-	l_item->type = TYPE_WAITER_ITEM;
-
-	waiter_item *w_item = &(l_item->item.w_item);
-	w_item->events = events;
-	w_item->code = code;
-	w_item->signaled = false;
-	pthread_mutex_init(&w_item->mutex, NULL);
-	pthread_cond_init(&w_item->condition, NULL);
-
-	QList_appendNode(list, (QNode *)l_item);
-
-	return l_item;
-}
-
-/**
- * @brief Dequeue and clear the waiter item from the list.
- *
- * @param l_item The waiter item to be cleared.
- */
-static void clear_waiter_item(list_item *l_item)
-{
-	QNode_dequeue(&l_item->qn);
-
-	waiter_item *w_item = &(l_item->item.w_item);
-	pthread_mutex_destroy(&w_item->mutex);
-	pthread_cond_destroy(&w_item->condition);
-
-	free(l_item);
+	return false;
 }
 
 /**
  * @brief Compute the wakeup time in terms of timespec from milliseconds.
  *
  * @param msec Time in milliseconds before we wake up.
- * @param wakeup wakeup time in terms of timespec.
+ * @param wakeup wakeup time in terms of timespec, on CLOCK_MONOTONIC so that
+ *               changes to the system time do not shorten or extend waits.
  */
 static void compute_wakeup_time(uint32_t msec, struct timespec *wakeup)
 {
 	struct timespec start;
-	clock_gettime(CLOCK_REALTIME, &start);
+	clock_gettime(CLOCK_MONOTONIC, &start);
 
-	/* pthread_cond_timedwait() resolves to the system clock, which
-	 * has OS tick resolution. We account for this by waiting at
-	 * least that long to guarantee TEE_Wait() times.
+	/* Timed futex waits have OS tick resolution. We account for this by
+	 * waiting at least that long to guarantee TEE_Wait() times.
 	 */
 	long tick_sec = sysconf(_SC_CLK_TCK);
 	if ((tick_sec > 0) && (msec < (uint32_t)(MSEC_PER_SEC / tick_sec)))
 		msec = (uint32_t)(MSEC_PER_SEC / tick_sec);
 
-	/* We don't consider the case of tv_sec overflowing (it's UTC
-	 * and that's a time and date quite a bit in the future), and
-	 * tv_nsec cannot overflow, since it comes as the sum of number
+	/* tv_nsec cannot overflow, since it comes as the sum of number
 	 * from a system API (start.tv_nsec), therefore < 1e9, and a
 	 * number which is at most 1e9-1 (999 ms)
 	 */
 	wakeup->tv_sec = start.tv_sec + (time_t)(msec / 1000);
 	wakeup->tv_nsec = start.tv_nsec + (long)((msec % 1000) * 1000000);
-	if (wakeup->tv_nsec > 1000000000) {
+	if (wakeup->tv_nsec >= 1000000000) {
 		wakeup->tv_sec += (wakeup->tv_nsec / 1000000000);
 		wakeup->tv_nsec %= 1000000000;
 	}
 }
 
 /**
- * @brief Wait for the specified amount of milliseconds for an event to occur.
+ * @brief Wait until a waiter item is signalled or the wakeup time passes.
  *
  * @param w_item The waiter item representing this wait request.
- * @param wakeup Time until wakeup from the waiting request.
- * @param msec Time in milliseconds for which to wait.
- * @param events_out The event signalled to the waiter item.
+ * @param wakeup Time until wakeup from the waiting request, or NULL to wait
+ *               without a timeout.
  * @return Object_OK on success.
  *         Object_ERROR* on failure.
  */
-static int32_t wait_for_signal(waiter_item *w_item, struct timespec wakeup,
-			       uint32_t msec, uint32_t *events_out)
+static int32_t wait_for_signal(wait_item *w_item, const struct timespec *wakeup)
 {
-	int32_t rv = Object_OK;
-	int wait_ret = 0;
-
-	pthread_mutex_lock(&w_item->mutex);
-	while (!w_item->signaled) {
-		if (msec != IWait_WAIT_INFINITE) {
-			/* We use pthread_cond_timedwait() to sleep.
-			* If the specified time is in the past, then we will
-			* get an ETIMEDOUT return. If it returns with 0, and
-			* the condition wasn't signaled, then it was a spurious
-			* wake up, and we simply sleep again.
-			*/
-			wait_ret = pthread_cond_timedwait(
-				&w_item->condition, &w_item->mutex, &wakeup);
-			if (wait_ret == ETIMEDOUT)
-				break;
-		} else {
-			wait_ret = pthread_cond_wait(&w_item->condition,
-						     &w_item->mutex);
-		}
+	while (!atomic_load(&w_item->signaled)) {
+		if (!futex_wait(&w_item->signaled, 0, wakeup))
+			continue;
+
+		/* EAGAIN is the waiter item signalled before we slept, and
+		 * EINTR a spurious wake up; either way, check again.
+		 */
+		if (errno == EAGAIN || errno == EINTR)
+			continue;
 
-		if (wait_ret) {
-			rv = Object_ERROR;
+		if (errno == ETIMEDOUT)
 			break;
-		}
 
-		/* If wait_ret is 0, it's still possible that we suffered a
-		 * spurious wake-up. To ensure that we were correctly woken up,
-		 * we check the w_item->signaled variable at the top of the
-		 * loop. If this was in-fact a spurious wakeup call,
-		 * we would sleep less this time around.
-		 */
+		return Object_ERROR;
 	}
-	pthread_mutex_unlock(&w_item->mutex);
-
-	if (w_item->signaled)
-		/* Report the event that was signaled */
-		*events_out = w_item->events;
 
-	return rv;
+	return Object_OK;
 }
 
 static int32_t CWait_wait(CWait *me, uint32_t msec, uint32_t code,
 			  uint32_t events, uint32_t *events_out)
 {
 	int32_t rv = Object_OK;
-	list_item *l_item = NULL;
-	waiter_item *w_item = NULL;
+	wait_item *w_item = NULL;
+	wait_bucket *bucket = bucket_of(me, code);
 	struct timespec wakeup;
 
 	if (events == IWait_EVENT_NONE || msec == 0) {
@@ -337,61 +307,117 @@ static int32_t CWait_wait(CWait *me, uint32_t msec, uint32_t code,
 		return Object_OK;
 	}
 
-	pthread_mutex_lock(&me->lock);
+	pthread_mutex_lock(&bucket->lock);
 	/* We are being asked to wait with a non-zero millisecond timeout.
 	 * But first, let's check if there is a signal pending for us, if so
 	 * we'll return early!
 	 */
-	if (get_signal_item(&me->list, code, events, events_out)) {
-		pthread_mutex_unlock(&me->lock);
+	if (get_signal_item(bucket, code, events, events_out)) {
+		pthread_mutex_unlock(&bucket->lock);
 		return Object_OK;
 	}
 
 	/* Nobody queued a signal for this wait request, so now we have to
 	 * queue a waiter item (to receive the signal) and wait.
 	 */
-	l_item = queue_waiter_item(&me->list, code, events);
-	w_item = &(l_item->item.w_item);
-	pthread_mutex_unlock(&me->lock);
+	w_item = get_item(bucket, code, events);
+	if (!w_item) {
+		pthread_mutex_unlock(&bucket->lock);
+		return Object_ERROR_KMEM;
+	}
+
+	QList_appendNode(&bucket->waiters, &w_item->qn);
+	pthread_mutex_unlock(&bucket->lock);
 
 	/* Compute our wakeup/wait time in preparation of signal wait */
-	if (msec != IWait_WAIT_INFINITE)
+	if (msec != IWait_WAIT_INFINITE) {
 		compute_wakeup_time(msec, &wakeup);
+		rv = wait_for_signal(w_item, &wakeup);
+	} else {
+		rv = wait_for_signal(w_item, NULL);
+	}
 
-	rv = wait_for_signal(w_item, wakeup, msec, events_out);
+	/* Clear the waiter item. A signal which arrived after the timeout but
+	 * before this is still reported.
+	 */
+	pthread_mutex_lock(&bucket->lock);
+	/* Report the event that was signaled, if any */
+	*events_out = atomic_load(&w_item->signaled) ? w_item->events : 0;
 
-	/* Clear the waiter item */
-	pthread_mutex_lock(&me->lock);
-	clear_waiter_item(l_item);
-	pthread_mutex_unlock(&me->lock);
+	put_item(bucket, w_item);
+	pthread_mutex_unlock(&bucket->lock);
 
 	return rv;
 }
 
 static int32_t CWait_signal(CWait *me, uint32_t code, uint32_t events)
 {
+	wait_bucket *bucket = bucket_of(me, code);
+	wait_bucket *wildcard = &me->buckets[CWAIT_WILDCARD];
+	wait_item *s_item = NULL;
 	bool signaled = false;
 
-	pthread_mutex_lock(&me->lock);
+	pthread_mutex_lock(&bucket->lock);
 
-	signaled = signal_waiter_item(&me->list, code, events);
+	signaled = signal_waiter_item(bucket, code, events);
+
+	if (!signaled && bucket != wildcard) {
+		/* Then try the waiters for any code */
+		pthread_mutex_lock(&wildcard->lock);
+		signaled = signal_waiter_item(wildcard, code, events);
+		pthread_mutex_unlock(&wildcard->lock);
+	}
 
-	if (!signaled && code)
+	if (!signaled && code) {
 		/* If nobody was waiting on this signal, we queue it to the
-		 * list, since the TA can attempt to wait on it later.
+		 * bucket, since the TA can attempt to wait on it later.
 		 * Note that we do this only if a cancel code is passed, i.e.
 		 * signals with no cancel code that don't find a matching waiter
 		 * are ignored.
 		 */
-		queue_signal_item(&me->list, code, events);
+		s_item = get_item(bucket, code, events);
+		if (s_item)
+			QList_appendNode(&bucket->signals, &s_item->qn);
+	}
 
-	pthread_mutex_unlock(&me->lock);
+	pthread_mutex_unlock(&bucket->lock);
 
 	return Object_OK;
 }
 
 static IWait_DEFINE_INVOKE(IWait_invoke, CWait_, CWait *);
 
+void CWait_cancel(Object wait, uint32_t code)
+{
+	if (wait.invoke != IWait_invoke)
+		return;
+
+	CWait_signal((CWait *)wait.context, code, IWait_EVENT_CANCEL);
+}
+
+void CWait_clear(Object wait, uint32_t code)
+{
+	CWait *me = (CWait *)wait.context;
+	wait_bucket *bucket = NULL;
+	QNode *node = NULL;
+	QNode *next = NULL;
+
+	if (wait.invoke != IWait_invoke || !code)
+		return;
+
+	bucket = bucket_of(me, code);
+
+	pthread_mutex_lock(&bucket->lock);
+
+	QLIST_NEXTSAFE_FOR_ALL(&bucket->signals, node, next)
+	{
+		if (((wait_item *)node)->code == code)
+			put_item(bucket, (wait_item *)node);
+	}
+
+	pthread_mutex_unlock(&bucket->lock);
+}
+
 int32_t CWait_open(Object *objOut)
 {
 	CWait *me = (CWait *)malloc(sizeof(CWait));
@@ -399,8 +425,13 @@ int32_t CWait_open(Object *objOut)
 		return Object_ERROR;
 
 	atomic_init(&me->refs, 1);
-	QList_construct(&me->list);
-	pthread_mutex_init(&me->lock, NULL);
+	for (size_t i = 0; i <= CWAIT_BUCKETS; i++) {
+		QList_construct(&me->buckets[i].waiters);
+		QList_construct(&me->buckets[i].signals);
+		QList_construct(&me->buckets[i].free);
+		me->buckets[i].num_free = 0;
+		pthread_mutex_init(&me->buckets[i].lock, NULL);
+	}
 
 	*objOut = (Object){ IWait_invoke, me };
 
@@ -6,3 +6,23 @@
 #include "object.h"
 
 int32_t CWait_open(Object *objOut);
+
+/**
+ * @brief Signal a cancellation for a code, as IWait_signal() with
+ * IWait_EVENT_CANCEL without going through the object's invoke function.
+ *
+ * @param wait The CWait object, as returned by CWait_open().
+ * @param code The cancel code of the command to cancel.
+ */
+void CWait_cancel(Object wait, uint32_t code);
+
+/**
+ * @brief Drop the signals queued for a code, which nobody waited for.
+ *
+ * Cancelling a command which completes without waiting for the cancellation
+ * leaves its signal queued; drop it once the command has completed.
+ *
+ * @param wait The CWait object, as returned by CWait_open().
+ * @param code The cancel code of the completed command.
+ */
+void CWait_clear(Object wait, uint32_t code);
@@ -0,0 +1,173 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bounce_pool.h"
+#include "invoke_stats.h"
+#include "MinkCom.h"
+
+#define CLASS_SIZE(c) ((size_t)1 << (BOUNCE_POOL_MIN_SHIFT + (c)))
+
+struct bounce_pool {
+	Object free[BOUNCE_POOL_CLASSES][BOUNCE_POOL_DEPTH];
+	size_t num[BOUNCE_POOL_CLASSES];
+	TEEC_BounceBufferStats stats;
+	/* Protect the free lists and the statistics */
+	pthread_mutex_t mutex;
+};
+
+/**
+ * @brief Allocate a memory object, counting it for the invocation.
+ */
+static int32_t alloc_mem_obj(Object root_obj, size_t size, Object *mo)
+{
+	int32_t rv = MinkCom_getMemoryObject(root_obj, size, mo);
+
+	if (!Object_isERROR(rv))
+		invoke_stats_count_mem_obj();
+
+	return rv;
+}
+
+/**
+ * @brief Get the smallest size class which fits a size.
+ *
+ * @return The size class, or -1 if the size is larger than the largest one.
+ */
+static int class_fit(size_t size)
+{
+	for (int c = 0; c < BOUNCE_POOL_CLASSES; c++) {
+		if (size <= CLASS_SIZE(c))
+			return c;
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Get the largest size class a memory object of a size can serve.
+ *
+ * Memory objects are rounded up to pages, so on systems with pages larger
+ * than the smallest size class they land in a larger class than requested.
+ *
+ * @return The size class, or -1 if the memory object is not to be cached.
+ */
+static int class_serve(size_t size)
+{
+	if (size < CLASS_SIZE(0) || size > CLASS_SIZE(BOUNCE_POOL_CLASSES - 1))
+		return -1;
+
+	for (int c = BOUNCE_POOL_CLASSES - 1; c > 0; c--) {
+		if (size >= CLASS_SIZE(c))
+			return c;
+	}
+
+	return 0;
+}
+
+struct bounce_pool *bounce_pool_new(void)
+{
+	struct bounce_pool *pool = calloc(1, sizeof(*pool));
+
+	if (!pool)
+		return NULL;
+
+	pthread_mutex_init(&pool->mutex, NULL);
+
+	return pool;
+}
+
+void bounce_pool_free(struct bounce_pool *pool)
+{
+	if (!pool)
+		return;
+
+	for (int c = 0; c < BOUNCE_POOL_CLASSES; c++) {
+		for (size_t i = 0; i < pool->num[c]; i++)
+			Object_ASSIGN_NULL(pool->free[c][i]);
+	}
+
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool);
+}
+
+int32_t bounce_pool_get(struct bounce_pool *pool, Object root_obj,
+			size_t size, Object *mo)
+{
+	int c = class_fit(size);
+
+	if (!pool || c < 0)
+		return alloc_mem_obj(root_obj, size, mo);
+
+	pthread_mutex_lock(&pool->mutex);
+
+	if (pool->num[c]) {
+		*mo = pool->free[c][--pool->num[c]];
+		pool->free[c][pool->num[c]] = Object_NULL;
+
+		pool->stats.hits++;
+		pool->stats.cached--;
+		pool->stats.cachedBytes -= CLASS_SIZE(c);
+
+		pthread_mutex_unlock(&pool->mutex);
+		return Object_OK;
+	}
+
+	pool->stats.misses++;
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	/* Allocate the whole class so the memory object can be reused. */
+	return alloc_mem_obj(root_obj, CLASS_SIZE(c), mo);
+}
+
+void bounce_pool_put(struct bounce_pool *pool, Object mo)
+{
+	void *addr;
+	size_t size;
+	int c = -1;
+
+	if (!pool) {
+		Object_RELEASE_IF(mo);
+		return;
+	}
+
+	if (!MinkCom_getMemoryObjectInfo(mo, &addr, &size))
+		c = class_serve(size);
+
+	/* The next command, possibly for another TA, must not see the data of
+	 * this one. QTEE has access to the whole memory object, not only the
+	 * range the command used, so clear all of it. At most half of it was
+	 * unused, so this costs at most twice the copy the command made.
+	 */
+	if (c >= 0)
+		memset(addr, 0, size);
+
+	pthread_mutex_lock(&pool->mutex);
+
+	if (c < 0 || pool->num[c] == BOUNCE_POOL_DEPTH ||
+	    pool->stats.cachedBytes + CLASS_SIZE(c) > BOUNCE_POOL_MAX_BYTES) {
+		pool->stats.drops++;
+
+		pthread_mutex_unlock(&pool->mutex);
+		Object_RELEASE_IF(mo);
+		return;
+	}
+
+	pool->free[c][pool->num[c]++] = mo;
+	pool->stats.cached++;
+	pool->stats.cachedBytes += CLASS_SIZE(c);
+
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+void bounce_pool_get_stats(struct bounce_pool *pool,
+			   TEEC_BounceBufferStats *stats)
+{
+	pthread_mutex_lock(&pool->mutex);
+	*stats = pool->stats;
+	pthread_mutex_unlock(&pool->mutex);
+}
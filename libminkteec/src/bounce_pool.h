@@ -0,0 +1,83 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __BOUNCE_POOL_H_
+#define __BOUNCE_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "object.h"
+#include "tee_client_api_ext.h"
+
+/* Bounce buffer pool.
+ *
+ * Temporary memory references larger than TEEC_SHM_MAX_HEAP_SZ, which cannot
+ * be registered in place, are copied through a memory object. Rather than
+ * allocating a memory object for every invocation, each TEE context keeps the
+ * memory objects it is done with, by power-of-two size class, and hands them
+ * out again.
+ *
+ * The pool caches at most BOUNCE_POOL_DEPTH memory objects per size class and
+ * BOUNCE_POOL_MAX_BYTES in total. Memory objects larger than the largest size
+ * class are not cached. Memory objects are cleared as they are returned, so
+ * that they never carry the data of a command to the next one.
+ */
+
+/* Size classes are 8 KiB, 16 KiB, ..., 2 MiB. */
+#define BOUNCE_POOL_MIN_SHIFT 13
+#define BOUNCE_POOL_CLASSES   9
+
+#define BOUNCE_POOL_DEPTH     4
+#define BOUNCE_POOL_MAX_BYTES (8 * 1024 * 1024)
+
+struct bounce_pool;
+
+/**
+ * @brief Create an empty bounce buffer pool.
+ *
+ * @return The pool, or NULL if out of memory.
+ */
+struct bounce_pool *bounce_pool_new(void);
+
+/**
+ * @brief Release the memory objects held by a pool and free it.
+ *
+ * @param pool The pool, or NULL.
+ */
+void bounce_pool_free(struct bounce_pool *pool);
+
+/**
+ * @brief Get a memory object of at least the requested size.
+ *
+ * @param pool The pool, or NULL to always allocate a new memory object.
+ * @param root_obj The root object to allocate memory objects from.
+ * @param size The minimum size of the memory object.
+ * @param mo The memory object.
+ * @return Object_OK on success.
+ *         Object_ERROR_* on failure.
+ */
+int32_t bounce_pool_get(struct bounce_pool *pool, Object root_obj,
+			size_t size, Object *mo);
+
+/**
+ * @brief Return a memory object to a pool, or release it.
+ *
+ * The caller's reference is transferred to the pool, which clears the memory
+ * of the memory object if it keeps it.
+ *
+ * @param pool The pool, or NULL to release the memory object.
+ * @param mo The memory object obtained with bounce_pool_get().
+ */
+void bounce_pool_put(struct bounce_pool *pool, Object mo);
+
+/**
+ * @brief Get the statistics of a pool.
+ *
+ * @param pool The pool.
+ * @param stats The statistics.
+ */
+void bounce_pool_get_stats(struct bounce_pool *pool,
+			   TEEC_BounceBufferStats *stats);
+
+#endif // __BOUNCE_POOL_H_
@@ -0,0 +1,319 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "completion_queue.h"
+#include "mink_teec.h"
+#include "MinkCom.h"
+
+#include "qlist.h"
+
+typedef struct {
+	QNode qn;
+
+	TEEC_Session *session;
+	uint32_t command_id;
+	uint32_t timeout;
+	uint64_t correlation_id;
+	TEEC_Completion completion;
+} queued_command;
+
+struct completion_queue {
+	QList submitted;
+	QList completed;
+	uint64_t next_handle;
+	bool stopping;
+	/* Cancel the queued commands once one fails */
+	bool stop_on_error;
+	bool failed;
+	/* Readable while completed is not empty */
+	int efd;
+	/* Protect the lists and stopping */
+	pthread_mutex_t lock;
+	pthread_cond_t submit_cond;
+	pthread_cond_t complete_cond;
+
+	uint32_t num_threads;
+	pthread_t threads[];
+};
+
+/**
+ * @brief Queue a completed command, signalling the eventfd if it is the only
+ * one. Called with the lock held.
+ */
+static void post_completion(struct completion_queue *cq, queued_command *cmd)
+{
+	uint64_t one = 1;
+
+	if (QList_isEmpty(&cq->completed) &&
+	    write(cq->efd, &one, sizeof(one)) != sizeof(one))
+		MSGE("Failed to signal completion: %d\n", errno);
+
+	QList_appendNode(&cq->completed, &cmd->qn);
+	pthread_cond_broadcast(&cq->complete_cond);
+}
+
+static void *completion_queue_thread(void *arg)
+{
+	struct completion_queue *cq = arg;
+	queued_command *cmd = NULL;
+	TEEC_Completion *c = NULL;
+
+	pthread_mutex_lock(&cq->lock);
+
+	for (;;) {
+		while (!cq->stopping && QList_isEmpty(&cq->submitted))
+			pthread_cond_wait(&cq->submit_cond, &cq->lock);
+
+		if (cq->stopping)
+			break;
+
+		cmd = (queued_command *)QList_pop(&cq->submitted);
+		c = &cmd->completion;
+
+		/* Commands submitted after one which failed are not invoked,
+		 * even those submitted once it failed.
+		 */
+		if (cq->failed) {
+			c->result = TEEC_ERROR_CANCEL;
+			c->returnOrigin = TEEC_ORIGIN_API;
+			post_completion(cq, cmd);
+			continue;
+		}
+
+		pthread_mutex_unlock(&cq->lock);
+
+		/* Invoke the command on behalf of the client request */
+		MinkCom_setCorrelationId(cmd->correlation_id);
+		c->result = invoke_operation(cmd->session, cmd->command_id,
+					     c->operation, cmd->timeout,
+					     &c->returnOrigin);
+		MinkCom_setCorrelationId(0);
+
+		pthread_mutex_lock(&cq->lock);
+		post_completion(cq, cmd);
+
+		if (cq->stop_on_error && c->result != TEEC_SUCCESS)
+			cq->failed = true;
+	}
+
+	pthread_mutex_unlock(&cq->lock);
+
+	return NULL;
+}
+
+TEEC_Result completion_queue_new(uint32_t num_threads,
+				 struct completion_queue **cq_out)
+{
+	struct completion_queue *cq = NULL;
+	pthread_condattr_t attr;
+	uint32_t i = 0;
+
+	cq = calloc(1, sizeof(*cq) + num_threads * sizeof(pthread_t));
+	if (!cq)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	cq->efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (cq->efd < 0) {
+		MSGE("eventfd failed: %d\n", errno);
+		free(cq);
+		return TEEC_ERROR_GENERIC;
+	}
+
+	QList_construct(&cq->submitted);
+	QList_construct(&cq->completed);
+	pthread_mutex_init(&cq->lock, NULL);
+	pthread_cond_init(&cq->submit_cond, NULL);
+
+	/* Timeouts are not to jump with the system clock */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&cq->complete_cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	for (i = 0; i < num_threads; i++) {
+		if (pthread_create(&cq->threads[i], NULL,
+				   completion_queue_thread, cq)) {
+			MSGE("pthread_create failed for thread %u\n", i);
+			break;
+		}
+	}
+
+	cq->num_threads = i;
+	if (i < num_threads) {
+		completion_queue_free(cq);
+		return TEEC_ERROR_GENERIC;
+	}
+
+	*cq_out = cq;
+
+	return TEEC_SUCCESS;
+}
+
+void completion_queue_free(struct completion_queue *cq)
+{
+	QNode *node = NULL;
+
+	pthread_mutex_lock(&cq->lock);
+	cq->stopping = true;
+	pthread_cond_broadcast(&cq->submit_cond);
+	pthread_mutex_unlock(&cq->lock);
+
+	for (uint32_t i = 0; i < cq->num_threads; i++)
+		pthread_join(cq->threads[i], NULL);
+
+	while ((node = QList_pop(&cq->submitted)))
+		free(node);
+
+	while ((node = QList_pop(&cq->completed)))
+		free(node);
+
+	close(cq->efd);
+	pthread_cond_destroy(&cq->complete_cond);
+	pthread_cond_destroy(&cq->submit_cond);
+	pthread_mutex_destroy(&cq->lock);
+	free(cq);
+}
+
+TEEC_Result completion_queue_submit(struct completion_queue *cq,
+				    TEEC_Session *session, uint32_t command_id,
+				    TEEC_Operation *op, void *user_data,
+				    uint64_t *handle)
+{
+	queued_command *cmd = malloc(sizeof(*cmd));
+
+	if (!cmd)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	QNode_construct(&cmd->qn);
+	cmd->session = session;
+	cmd->command_id = command_id;
+	cmd->timeout = session->imp.ctx->imp.invoke_timeout;
+	cmd->correlation_id = MinkCom_getCorrelationId();
+	cmd->completion.userData = user_data;
+	cmd->completion.operation = op;
+	cmd->completion.result = TEEC_SUCCESS;
+	cmd->completion.returnOrigin = TEEC_ORIGIN_COMMS;
+
+	/* Bind the operation now, so that it can be cancelled while queued */
+	if (op)
+		bind_operation(session->imp.ctx, session, op, cq);
+
+	pthread_mutex_lock(&cq->lock);
+
+	cmd->completion.handle = ++cq->next_handle;
+	if (handle)
+		*handle = cmd->completion.handle;
+
+	QList_appendNode(&cq->submitted, &cmd->qn);
+	pthread_cond_signal(&cq->submit_cond);
+
+	pthread_mutex_unlock(&cq->lock);
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Wait for the completed list not to be empty. Called with the lock
+ * held.
+ */
+static void wait_completion(struct completion_queue *cq, uint32_t msec)
+{
+	struct timespec wakeup;
+
+	if (msec == MINK_TEEC_TIMEOUT_INFINITE) {
+		while (QList_isEmpty(&cq->completed))
+			pthread_cond_wait(&cq->complete_cond, &cq->lock);
+		return;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &wakeup);
+	wakeup.tv_sec += (time_t)(msec / 1000);
+	wakeup.tv_nsec += (long)((msec % 1000) * 1000000);
+	if (wakeup.tv_nsec >= 1000000000) {
+		wakeup.tv_sec++;
+		wakeup.tv_nsec -= 1000000000;
+	}
+
+	while (QList_isEmpty(&cq->completed)) {
+		if (pthread_cond_timedwait(&cq->complete_cond, &cq->lock,
+					   &wakeup) == ETIMEDOUT)
+			break;
+	}
+}
+
+uint32_t completion_queue_wait(struct completion_queue *cq,
+			       TEEC_Completion *completions, uint32_t max,
+			       uint32_t msec)
+{
+	queued_command *cmd = NULL;
+	uint64_t count = 0;
+	uint32_t n = 0;
+
+	pthread_mutex_lock(&cq->lock);
+
+	if (msec)
+		wait_completion(cq, msec);
+
+	while (n < max && !QList_isEmpty(&cq->completed)) {
+		cmd = (queued_command *)QList_pop(&cq->completed);
+		completions[n++] = cmd->completion;
+		free(cmd);
+	}
+
+	/* Nothing left to reap, so the eventfd is no longer readable */
+	if (n && QList_isEmpty(&cq->completed) &&
+	    read(cq->efd, &count, sizeof(count)) != sizeof(count))
+		MSGE("Failed to clear completion signal: %d\n", errno);
+
+	pthread_mutex_unlock(&cq->lock);
+
+	return n;
+}
+
+int completion_queue_fd(struct completion_queue *cq)
+{
+	return cq->efd;
+}
+
+void completion_queue_stop_on_error(struct completion_queue *cq)
+{
+	pthread_mutex_lock(&cq->lock);
+	cq->stop_on_error = true;
+	pthread_mutex_unlock(&cq->lock);
+}
+
+bool completion_queue_cancel(struct completion_queue *cq, TEEC_Operation *op)
+{
+	QNode *node = NULL;
+	QNode *next = NULL;
+	queued_command *cmd = NULL;
+	bool cancelled = false;
+
+	pthread_mutex_lock(&cq->lock);
+
+	QLIST_NEXTSAFE_FOR_ALL(&cq->submitted, node, next)
+	{
+		cmd = (queued_command *)node;
+		if (cmd->completion.operation != op)
+			continue;
+
+		QNode_dequeue(node);
+		cmd->completion.result = TEEC_ERROR_CANCEL;
+		cmd->completion.returnOrigin = TEEC_ORIGIN_API;
+		post_completion(cq, cmd);
+
+		cancelled = true;
+		break;
+	}
+
+	pthread_mutex_unlock(&cq->lock);
+
+	return cancelled;
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __COMPLETION_QUEUE_H_
+#define __COMPLETION_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tee_client_api_ext.h"
+
+/* Completion queue.
+ *
+ * Invocations of QTEE block the calling thread until the command completes.
+ * A completion queue owns a fixed number of threads which invoke the commands
+ * submitted to it, so that a client with a few threads of its own can keep
+ * many commands in flight. Completed commands are queued until the client
+ * reaps them; an eventfd is readable while completions are queued, to wait
+ * for them in an event loop.
+ *
+ * A command can be cancelled before one of the threads picks it up, in which
+ * case it completes without being invoked. Once invoked it is cancelled
+ * through the CWait object of its TEE context, as a synchronous command.
+ */
+
+struct completion_queue;
+
+/**
+ * @brief Create a completion queue and start its threads.
+ *
+ * @param num_threads The number of threads invoking commands.
+ * @param cq The completion queue.
+ * @return TEEC_SUCCESS if the queue was created.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result completion_queue_new(uint32_t num_threads,
+				 struct completion_queue **cq);
+
+/**
+ * @brief Stop the threads of a completion queue and free it.
+ *
+ * Commands not yet invoked are discarded. Commands being invoked are waited
+ * for.
+ *
+ * @param cq The completion queue.
+ */
+void completion_queue_free(struct completion_queue *cq);
+
+/**
+ * @brief Queue a command for invocation.
+ *
+ * @param cq The completion queue.
+ * @param session The session over which to invoke the command.
+ * @param command_id Identifier for the command to invoke.
+ * @param op The optional operation payload, validated by the caller.
+ * @param user_data Returned with the completion.
+ * @param handle The handle of the command.
+ * @return TEEC_SUCCESS if the command was queued.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result completion_queue_submit(struct completion_queue *cq,
+				    TEEC_Session *session, uint32_t command_id,
+				    TEEC_Operation *op, void *user_data,
+				    uint64_t *handle);
+
+/**
+ * @brief Reap completed commands.
+ *
+ * @param cq The completion queue.
+ * @param completions The completions.
+ * @param max The maximum number of completions to reap.
+ * @param msec Time in milliseconds to wait for a completion, 0 not to wait or
+ *             MINK_TEEC_TIMEOUT_INFINITE to wait without a timeout.
+ * @return The number of completions reaped.
+ */
+uint32_t completion_queue_wait(struct completion_queue *cq,
+			       TEEC_Completion *completions, uint32_t max,
+			       uint32_t msec);
+
+/**
+ * @brief Get the eventfd which is readable while completions are queued.
+ *
+ * @param cq The completion queue.
+ * @return The file descriptor.
+ */
+int completion_queue_fd(struct completion_queue *cq);
+
+/**
+ * @brief Stop invoking commands once one fails.
+ *
+ * The commands queued after a command which fails, including those submitted
+ * once it failed, complete as cancelled without being invoked, so that the
+ * commands of a session which depend on each other do not run after one of
+ * them failed.
+ *
+ * @param cq The completion queue.
+ */
+void completion_queue_stop_on_error(struct completion_queue *cq);
+
+/**
+ * @brief Complete a queued command which has not been invoked yet as
+ * cancelled.
+ *
+ * @param cq The completion queue the operation was submitted to.
+ * @param op The operation of the command.
+ * @return true if the command was cancelled.
+ *         false if it is being invoked, or has completed.
+ */
+bool completion_queue_cancel(struct completion_queue *cq, TEEC_Operation *op);
+
+#endif // __COMPLETION_QUEUE_H_
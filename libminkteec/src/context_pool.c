@@ -0,0 +1,193 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define _GNU_SOURCE /* secure_getenv() */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "context_pool.h"
+#include "mink_teec.h"
+
+#define CONTEXT_POOL_ENV "MINKTEEC_CONTEXT_POOL"
+
+static struct {
+	/* Most recently returned last */
+	struct context_conn idle[TEEC_CONFIG_CONTEXT_POOL_MAX];
+	uint32_t max;
+	/* Connections the warming thread is opening */
+	uint32_t opening;
+	bool warming;
+	TEEC_ContextPoolStats stats;
+	/* Protect all of the above */
+	pthread_mutex_t lock;
+} pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/**
+ * @brief Open connections until the pool is full, then exit.
+ */
+static void *context_pool_warm(void *arg)
+{
+	struct context_conn conn;
+
+	(void)arg;
+
+	pthread_mutex_lock(&pool.lock);
+
+	while (pool.stats.idle + pool.opening < pool.max) {
+		pool.opening++;
+		pthread_mutex_unlock(&pool.lock);
+
+		if (open_connection(&conn)) {
+			pthread_mutex_lock(&pool.lock);
+			pool.opening--;
+			break;
+		}
+
+		pthread_mutex_lock(&pool.lock);
+		pool.opening--;
+
+		if (pool.stats.idle < pool.max) {
+			pool.idle[pool.stats.idle++] = conn;
+		} else {
+			/* The pool shrank while opening */
+			pthread_mutex_unlock(&pool.lock);
+			close_connection(&conn);
+			pthread_mutex_lock(&pool.lock);
+		}
+	}
+
+	pool.warming = false;
+
+	pthread_mutex_unlock(&pool.lock);
+
+	return NULL;
+}
+
+TEEC_Result context_pool_configure(const TEEC_ContextPoolConfig *config)
+{
+	struct context_conn evicted[TEEC_CONFIG_CONTEXT_POOL_MAX];
+	size_t num_evicted = 0;
+	pthread_attr_t attr;
+	pthread_t thread;
+	TEEC_Result ret = TEEC_SUCCESS;
+
+	pthread_mutex_lock(&pool.lock);
+
+	pool.max = config ? config->maxContexts : 0;
+
+	/* Close the connections idle the longest */
+	while (pool.stats.idle > pool.max) {
+		evicted[num_evicted++] = pool.idle[0];
+		pool.stats.idle--;
+		for (size_t i = 0; i < pool.stats.idle; i++)
+			pool.idle[i] = pool.idle[i + 1];
+	}
+
+	if (config && (config->flags & TEEC_CONTEXT_POOL_WARM) &&
+	    !pool.warming && pool.stats.idle < pool.max) {
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+		if (pthread_create(&thread, &attr, context_pool_warm, NULL)) {
+			MSGE("pthread_create failed for the context pool\n");
+			ret = TEEC_ERROR_GENERIC;
+		} else {
+			pool.warming = true;
+		}
+
+		pthread_attr_destroy(&attr);
+	}
+
+	pthread_mutex_unlock(&pool.lock);
+
+	for (size_t i = 0; i < num_evicted; i++)
+		close_connection(&evicted[i]);
+
+	return ret;
+}
+
+bool context_pool_get(struct context_conn *conn)
+{
+	bool found = false;
+
+	pthread_mutex_lock(&pool.lock);
+
+	while (pool.stats.idle) {
+		*conn = pool.idle[--pool.stats.idle];
+
+		/* QTEE or the supplicant may have gone since it was pooled */
+		pthread_mutex_unlock(&pool.lock);
+		found = connection_healthy(conn);
+		if (!found)
+			close_connection(conn);
+		pthread_mutex_lock(&pool.lock);
+
+		if (found)
+			break;
+
+		pool.stats.failedChecks++;
+	}
+
+	if (found)
+		pool.stats.hits++;
+	else if (pool.max)
+		pool.stats.misses++;
+
+	pthread_mutex_unlock(&pool.lock);
+
+	return found;
+}
+
+bool context_pool_put(const struct context_conn *conn)
+{
+	bool kept = false;
+
+	pthread_mutex_lock(&pool.lock);
+
+	if (pool.stats.idle < pool.max) {
+		pool.idle[pool.stats.idle++] = *conn;
+		kept = true;
+	} else if (pool.max) {
+		pool.stats.drops++;
+	}
+
+	pthread_mutex_unlock(&pool.lock);
+
+	return kept;
+}
+
+void context_pool_get_stats(TEEC_ContextPoolStats *stats)
+{
+	pthread_mutex_lock(&pool.lock);
+	*stats = pool.stats;
+	pthread_mutex_unlock(&pool.lock);
+}
+
+/**
+ * @brief Warm the number of connections given by MINKTEEC_CONTEXT_POOL when
+ * the library is loaded, unless in a setuid program.
+ */
+__attribute__((constructor)) static void context_pool_init(void)
+{
+	TEEC_ContextPoolConfig config = { 0 };
+	const char *env = secure_getenv(CONTEXT_POOL_ENV);
+	char *end = NULL;
+	unsigned long num = 0;
+
+	if (!env || !*env)
+		return;
+
+	num = strtoul(env, &end, 0);
+	if (*end || !num || num > TEEC_CONFIG_CONTEXT_POOL_MAX) {
+		MSGE("Invalid %s=%s\n", CONTEXT_POOL_ENV, env);
+		return;
+	}
+
+	config.maxContexts = (uint32_t)num;
+	config.flags = TEEC_CONTEXT_POOL_WARM;
+
+	context_pool_configure(&config);
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __CONTEXT_POOL_H_
+#define __CONTEXT_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "object.h"
+#include "tee_client_api_ext.h"
+
+/* Context pool.
+ *
+ * Initializing a TEE context starts a supplicant, takes two round trips to
+ * QTEE to get the GP AppClient object, and creates a CWait object. The pool
+ * keeps these connections once their context is finalized, process-wide,
+ * and hands them to the contexts initialized next, once checked that QTEE
+ * still answers through them. It can also be warmed by a background thread
+ * opening connections ahead of time.
+ *
+ * The pool is disabled until configured with context_pool_configure(), or
+ * with MINKTEEC_CONTEXT_POOL set to the number of connections to warm when
+ * the library is loaded.
+ */
+
+struct context_conn {
+	Object root_obj;
+	Object app_client;
+	Object waiter_cbo;
+};
+
+/**
+ * @brief Configure the process-wide context pool.
+ *
+ * Shrinking the pool closes the connections it no longer has room for.
+ *
+ * @param config The configuration of the pool, or NULL to disable it.
+ * @return TEEC_SUCCESS if the pool was configured.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result context_pool_configure(const TEEC_ContextPoolConfig *config);
+
+/**
+ * @brief Take a connection from the pool.
+ *
+ * Pooled connections failing connection_healthy() are closed, and the next
+ * one is tried.
+ *
+ * @param conn The connection.
+ * @return true if a pooled connection was handed out.
+ *         false if a new connection is to be opened.
+ */
+bool context_pool_get(struct context_conn *conn);
+
+/**
+ * @brief Return the connection of a finalized context to the pool.
+ *
+ * @param conn The connection. The pool takes over its references.
+ * @return true if the pool kept the connection.
+ *         false if the caller is to close it.
+ */
+bool context_pool_put(const struct context_conn *conn);
+
+/**
+ * @brief Get the statistics of the pool.
+ *
+ * @param stats The statistics.
+ */
+void context_pool_get_stats(TEEC_ContextPoolStats *stats);
+
+#endif // __CONTEXT_POOL_H_
@@ -0,0 +1,114 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "inflight.h"
+
+#include "CWait_open.h"
+
+typedef struct {
+	QList cmds;
+	/* Protect the list and the cancelled flag of its commands */
+	pthread_mutex_t lock;
+} inflight_shard;
+
+struct inflight_set {
+	Object waiter_cbo;
+	inflight_shard shards[INFLIGHT_SHARDS];
+};
+
+static inflight_shard *shard_of(struct inflight_set *set, uint32_t code)
+{
+	return &set->shards[code % INFLIGHT_SHARDS];
+}
+
+struct inflight_set *inflight_new(Object waiter_cbo)
+{
+	struct inflight_set *set = calloc(1, sizeof(*set));
+
+	if (!set)
+		return NULL;
+
+	set->waiter_cbo = waiter_cbo;
+	for (size_t i = 0; i < INFLIGHT_SHARDS; i++) {
+		QList_construct(&set->shards[i].cmds);
+		pthread_mutex_init(&set->shards[i].lock, NULL);
+	}
+
+	return set;
+}
+
+void inflight_free(struct inflight_set *set)
+{
+	if (!set)
+		return;
+
+	for (size_t i = 0; i < INFLIGHT_SHARDS; i++)
+		pthread_mutex_destroy(&set->shards[i].lock);
+
+	free(set);
+}
+
+void inflight_add(struct inflight_set *set, struct inflight_cmd *cmd,
+		  TEEC_Session *session, uint32_t cancel_code)
+{
+	inflight_shard *shard = shard_of(set, cancel_code);
+
+	QNode_construct(&cmd->qn);
+	cmd->session = session;
+	cmd->cancel_code = cancel_code;
+	cmd->cancelled = false;
+
+	pthread_mutex_lock(&shard->lock);
+	QList_appendNode(&shard->cmds, &cmd->qn);
+	pthread_mutex_unlock(&shard->lock);
+}
+
+bool inflight_remove(struct inflight_set *set, struct inflight_cmd *cmd)
+{
+	inflight_shard *shard = shard_of(set, cmd->cancel_code);
+	bool cancelled = false;
+
+	pthread_mutex_lock(&shard->lock);
+	QNode_dequeue(&cmd->qn);
+	cancelled = cmd->cancelled;
+	pthread_mutex_unlock(&shard->lock);
+
+	/* The TA may have completed without waiting for the cancellation */
+	if (cancelled)
+		CWait_clear(set->waiter_cbo, cmd->cancel_code);
+
+	return cancelled;
+}
+
+uint32_t inflight_cancel(struct inflight_set *set, TEEC_Session *session)
+{
+	inflight_shard *shard = NULL;
+	struct inflight_cmd *cmd = NULL;
+	QNode *node = NULL;
+	uint32_t num = 0;
+
+	for (size_t i = 0; i < INFLIGHT_SHARDS; i++) {
+		shard = &set->shards[i];
+
+		pthread_mutex_lock(&shard->lock);
+
+		QLIST_FOR_ALL(&shard->cmds, node)
+		{
+			cmd = (struct inflight_cmd *)node;
+			if (cmd->cancelled ||
+			    (session && cmd->session != session))
+				continue;
+
+			cmd->cancelled = true;
+			CWait_cancel(set->waiter_cbo, cmd->cancel_code);
+			num++;
+		}
+
+		pthread_mutex_unlock(&shard->lock);
+	}
+
+	return num;
+}
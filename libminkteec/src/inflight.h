@@ -0,0 +1,81 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __INFLIGHT_H_
+#define __INFLIGHT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "object.h"
+#include "qlist.h"
+#include "tee_client_api.h"
+
+/* In-flight commands.
+ *
+ * Each TEE context keeps the commands being invoked in its sessions, with
+ * their cancel code, so that all of them, or those of one session, can be
+ * cancelled at once. Commands are kept in INFLIGHT_SHARDS lists by cancel
+ * code, so that threads invoking concurrently do not contend for one lock.
+ *
+ * Entries are owned by the invoking thread, on its stack.
+ */
+
+#define INFLIGHT_SHARDS 16
+
+struct inflight_set;
+
+struct inflight_cmd {
+	QNode qn;
+
+	TEEC_Session *session;
+	uint32_t cancel_code;
+	bool cancelled;
+};
+
+/**
+ * @brief Create the set of in-flight commands of a TEE context.
+ *
+ * @param waiter_cbo The CWait object of the context, which must outlive the
+ *                   set.
+ * @return The set, or NULL if out of memory.
+ */
+struct inflight_set *inflight_new(Object waiter_cbo);
+
+/**
+ * @brief Free a set of in-flight commands.
+ *
+ * @param set The set, or NULL.
+ */
+void inflight_free(struct inflight_set *set);
+
+/**
+ * @brief Add a command about to be invoked to a set.
+ *
+ * @param set The set.
+ * @param cmd The entry of the command, valid until removed.
+ * @param session The session of the command.
+ * @param cancel_code The cancel code of the command.
+ */
+void inflight_add(struct inflight_set *set, struct inflight_cmd *cmd,
+		  TEEC_Session *session, uint32_t cancel_code);
+
+/**
+ * @brief Remove a completed command from a set.
+ *
+ * @param set The set.
+ * @param cmd The entry added with inflight_add().
+ * @return true if the command was cancelled with inflight_cancel().
+ */
+bool inflight_remove(struct inflight_set *set, struct inflight_cmd *cmd);
+
+/**
+ * @brief Cancel the commands of a set.
+ *
+ * @param set The set.
+ * @param session The session whose commands to cancel, or NULL for all.
+ * @return The number of commands cancelled.
+ */
+uint32_t inflight_cancel(struct inflight_set *set, TEEC_Session *session);
+
+#endif // __INFLIGHT_H_
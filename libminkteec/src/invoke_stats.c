@@ -0,0 +1,513 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define _GNU_SOURCE /* secure_getenv() */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "invoke_stats.h"
+#include "mink_teec.h"
+
+#include "qlist.h"
+
+#define STATS_ENV "MINKTEEC_STATS"
+/* Commands counted apart in each session with MINKTEEC_STATS */
+#define STATS_ENV_COMMANDS 64
+
+#define NSEC_PER_USEC 1000ULL
+#define NSEC_PER_SEC  1000000000ULL
+
+struct invoke_stats {
+	/* In the list of all counters */
+	QNode qn;
+
+	TEEC_Session *session;
+	TEEC_UUID uuid;
+
+	/* Up to max commands counted apart, then the other commands */
+	uint32_t max;
+	uint32_t num;
+	TEEC_CommandStatistics *entries;
+	/* Index of each command in entries, plus one, by hash of its ID */
+	uint32_t *slots;
+	uint32_t num_slots;
+
+	/* Protect the entries and slots */
+	pthread_mutex_t lock;
+};
+
+static struct {
+	QList stats;
+	/* Protect the list */
+	pthread_mutex_t lock;
+
+	int fd;
+	bool started;
+	sem_t wake;
+} dump = {
+	.stats = { { &dump.stats.n, &dump.stats.n } },
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.fd = -1,
+};
+
+static uint32_t default_commands;
+
+/* Memory objects and copies of the invocations of this thread, so far */
+static __thread uint64_t thread_mem_objs;
+static __thread uint64_t thread_copy_bytes;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t slot_of(const struct invoke_stats *stats, uint32_t command_id)
+{
+	return (command_id * 0x9E3779B1U) & (stats->num_slots - 1);
+}
+
+/**
+ * @brief Find the counters of a command, adding them if new.
+ *
+ * @param stats The counters of the session, locked.
+ * @param command_id The command.
+ * @return The counters of the command, or of the other commands once max
+ *         commands are counted apart.
+ */
+static TEEC_CommandStatistics *entry_of(struct invoke_stats *stats,
+					uint32_t command_id)
+{
+	TEEC_CommandStatistics *e = NULL;
+	uint32_t slot = 0;
+
+	/* Twice as many slots as entries, so there is always a free one */
+	for (;;) {
+		slot = slot_of(stats, command_id);
+
+		while (stats->slots[slot]) {
+			e = &stats->entries[stats->slots[slot] - 1];
+			if (e->commandID == command_id)
+				return e;
+
+			slot = (slot + 1) & (stats->num_slots - 1);
+		}
+
+		if (stats->num < stats->max ||
+		    command_id == TEEC_STATS_OTHER_COMMANDS)
+			break;
+
+		command_id = TEEC_STATS_OTHER_COMMANDS;
+	}
+
+	e = &stats->entries[stats->num++];
+	e->commandID = command_id;
+	stats->slots[slot] = stats->num;
+
+	return e;
+}
+
+/**
+ * @brief Get the class and the bytes each way of a parameter.
+ *
+ * @param op The operation.
+ * @param i The index of the parameter.
+ * @param in The bytes passed to the TA.
+ * @param out The bytes returned by the TA.
+ * @return The class of the parameter, or TEEC_STATS_PARAM_CLASSES if none.
+ */
+static uint32_t param_bytes(const TEEC_Operation *op, size_t i, size_t *in,
+			    size_t *out)
+{
+	const TEEC_Parameter *param = &op->params[i];
+	uint32_t type = TEEC_PARAM_TYPE_GET(op->paramTypes, i);
+
+	*in = 0;
+	*out = 0;
+
+	switch (type) {
+	case TEEC_VALUE_INPUT:
+	case TEEC_VALUE_OUTPUT:
+	case TEEC_VALUE_INOUT:
+		if (type != TEEC_VALUE_OUTPUT)
+			*in = sizeof(TEEC_Value);
+		if (type != TEEC_VALUE_INPUT)
+			*out = sizeof(TEEC_Value);
+
+		return TEEC_STATS_PARAM_VALUE;
+	case TEEC_MEMREF_TEMP_INPUT:
+	case TEEC_MEMREF_TEMP_OUTPUT:
+	case TEEC_MEMREF_TEMP_INOUT:
+		if (type != TEEC_MEMREF_TEMP_OUTPUT)
+			*in = param->tmpref.size;
+		if (type != TEEC_MEMREF_TEMP_INPUT)
+			*out = param->tmpref.size;
+
+		return TEEC_STATS_PARAM_TEMP;
+	case TEEC_MEMREF_WHOLE:
+		if (param->memref.parent->flags & TEEC_MEM_INPUT)
+			*in = param->memref.parent->size;
+		if (param->memref.parent->flags & TEEC_MEM_OUTPUT)
+			*out = param->memref.size;
+
+		return TEEC_STATS_PARAM_WHOLE;
+	case TEEC_MEMREF_PARTIAL_INPUT:
+	case TEEC_MEMREF_PARTIAL_OUTPUT:
+	case TEEC_MEMREF_PARTIAL_INOUT:
+		if (type != TEEC_MEMREF_PARTIAL_OUTPUT)
+			*in = param->memref.size;
+		if (type != TEEC_MEMREF_PARTIAL_INPUT)
+			*out = param->memref.size;
+
+		return TEEC_STATS_PARAM_PARTIAL;
+	default:
+		return TEEC_STATS_PARAM_CLASSES;
+	}
+}
+
+struct invoke_stats *invoke_stats_new(TEEC_Session *session,
+				      uint32_t max_commands)
+{
+	struct invoke_stats *stats = calloc(1, sizeof(*stats));
+
+	if (!stats)
+		return NULL;
+
+	stats->session = session;
+	stats->uuid = session->imp.uuid;
+	stats->max = max_commands;
+
+	stats->num_slots = 2;
+	while (stats->num_slots < 2 * (max_commands + 1))
+		stats->num_slots <<= 1;
+
+	/* One more entry for the other commands */
+	stats->entries = calloc(max_commands + 1, sizeof(*stats->entries));
+	stats->slots = calloc(stats->num_slots, sizeof(*stats->slots));
+	if (!stats->entries || !stats->slots) {
+		free(stats->entries);
+		free(stats->slots);
+		free(stats);
+		return NULL;
+	}
+
+	pthread_mutex_init(&stats->lock, NULL);
+
+	pthread_mutex_lock(&dump.lock);
+	QList_appendNode(&dump.stats, &stats->qn);
+	pthread_mutex_unlock(&dump.lock);
+
+	return stats;
+}
+
+void invoke_stats_free(struct invoke_stats *stats)
+{
+	if (!stats)
+		return;
+
+	pthread_mutex_lock(&dump.lock);
+	QNode_dequeue(&stats->qn);
+	pthread_mutex_unlock(&dump.lock);
+
+	pthread_mutex_destroy(&stats->lock);
+	free(stats->entries);
+	free(stats->slots);
+	free(stats);
+}
+
+void invoke_stats_begin(struct invoke_sample *sample, const TEEC_Operation *op)
+{
+	uint32_t class = 0;
+	size_t in = 0;
+	size_t out = 0;
+
+	memset(sample->bytes_in, 0, sizeof(sample->bytes_in));
+
+	/* Counted before the conversion of the parameters changes them */
+	for (size_t i = 0; op && i < MAX_NUM_PARAMS; i++) {
+		class = param_bytes(op, i, &in, &out);
+		if (class < TEEC_STATS_PARAM_CLASSES)
+			sample->bytes_in[class] += in;
+	}
+
+	sample->mem_objs = thread_mem_objs;
+	sample->copy_bytes = thread_copy_bytes;
+	sample->start = now_ns();
+}
+
+void invoke_stats_end(struct invoke_stats *stats, struct invoke_sample *sample,
+		      uint32_t command_id, const TEEC_Operation *op,
+		      TEEC_Result result)
+{
+	uint64_t bytes_out[TEEC_STATS_PARAM_CLASSES] = { 0 };
+	uint64_t usec = (now_ns() - sample->start) / NSEC_PER_USEC;
+	TEEC_CommandStatistics *e = NULL;
+	uint32_t bucket = 0;
+	uint32_t class = 0;
+	size_t in = 0;
+	size_t out = 0;
+
+	/* Output sizes are only meaningful on success */
+	for (size_t i = 0; op && !result && i < MAX_NUM_PARAMS; i++) {
+		class = param_bytes(op, i, &in, &out);
+		if (class < TEEC_STATS_PARAM_CLASSES)
+			bytes_out[class] += out;
+	}
+
+	while (bucket < TEEC_STATS_LATENCY_BUCKETS - 1 &&
+	       usec >= (1ULL << bucket))
+		bucket++;
+
+	pthread_mutex_lock(&stats->lock);
+
+	e = entry_of(stats, command_id);
+
+	e->invocations++;
+	if (result)
+		e->failures++;
+	e->totalTime += usec;
+	if (e->maxTime < usec)
+		e->maxTime = usec;
+	e->latency[bucket]++;
+
+	for (size_t i = 0; i < TEEC_STATS_PARAM_CLASSES; i++) {
+		e->bytesIn[i] += sample->bytes_in[i];
+		e->bytesOut[i] += bytes_out[i];
+	}
+
+	e->memoryObjects += thread_mem_objs - sample->mem_objs;
+	e->copyBytes += thread_copy_bytes - sample->copy_bytes;
+
+	pthread_mutex_unlock(&stats->lock);
+}
+
+static int compare_cost(const void *a, const void *b)
+{
+	const TEEC_CommandStatistics *x = a;
+	const TEEC_CommandStatistics *y = b;
+
+	if (x->totalTime != y->totalTime)
+		return x->totalTime < y->totalTime ? 1 : -1;
+
+	return (x->commandID > y->commandID) - (x->commandID < y->commandID);
+}
+
+TEEC_Result invoke_stats_get(struct invoke_stats *stats,
+			     TEEC_CommandStatistics *out, uint32_t *num)
+{
+	TEEC_CommandStatistics *sorted = NULL;
+	uint32_t count = 0;
+
+	pthread_mutex_lock(&stats->lock);
+
+	count = stats->num;
+	if (count) {
+		sorted = malloc(count * sizeof(*sorted));
+		if (!sorted) {
+			pthread_mutex_unlock(&stats->lock);
+			return TEEC_ERROR_OUT_OF_MEMORY;
+		}
+
+		memcpy(sorted, stats->entries, count * sizeof(*sorted));
+	}
+
+	pthread_mutex_unlock(&stats->lock);
+
+	if (count)
+		qsort(sorted, count, sizeof(*sorted), compare_cost);
+
+	memcpy(out, sorted, (count < *num ? count : *num) * sizeof(*out));
+	free(sorted);
+
+	if (count > *num) {
+		*num = count;
+		return TEEC_ERROR_SHORT_BUFFER;
+	}
+
+	*num = count;
+
+	return TEEC_SUCCESS;
+}
+
+void invoke_stats_count_mem_obj(void)
+{
+	thread_mem_objs++;
+}
+
+void invoke_stats_count_copy(size_t bytes)
+{
+	thread_copy_bytes += bytes;
+}
+
+/**
+ * @brief Write the counters of a session to the dump file.
+ *
+ * @param stats The counters of the session, locked.
+ */
+static void dump_stats(const struct invoke_stats *stats)
+{
+	const TEEC_CommandStatistics *e = NULL;
+	const TEEC_UUID *u = &stats->uuid;
+
+	for (uint32_t n = 0; n < stats->num; n++) {
+		e = &stats->entries[n];
+
+		dprintf(dump.fd,
+			"session=%p uuid=%08x-%04x-%04x-%02x%02x-"
+			"%02x%02x%02x%02x%02x%02x cmd=0x%08x invocations=%"
+			PRIu64 " failures=%" PRIu64 " time_us=%" PRIu64
+			" max_us=%" PRIu64,
+			(void *)stats->session, u->timeLow, u->timeMid,
+			u->timeHiAndVersion, u->clockSeqAndNode[0],
+			u->clockSeqAndNode[1], u->clockSeqAndNode[2],
+			u->clockSeqAndNode[3], u->clockSeqAndNode[4],
+			u->clockSeqAndNode[5], u->clockSeqAndNode[6],
+			u->clockSeqAndNode[7], e->commandID, e->invocations,
+			e->failures, e->totalTime, e->maxTime);
+
+		dprintf(dump.fd, " bytes_in=%" PRIu64 ",%" PRIu64 ",%" PRIu64
+			",%" PRIu64 " bytes_out=%" PRIu64 ",%" PRIu64 ",%"
+			PRIu64 ",%" PRIu64 " mem_objs=%" PRIu64
+			" copy_bytes=%" PRIu64 " latency=",
+			e->bytesIn[0], e->bytesIn[1], e->bytesIn[2],
+			e->bytesIn[3], e->bytesOut[0], e->bytesOut[1],
+			e->bytesOut[2], e->bytesOut[3], e->memoryObjects,
+			e->copyBytes);
+
+		for (size_t i = 0; i < TEEC_STATS_LATENCY_BUCKETS; i++)
+			dprintf(dump.fd, i ? ",%" PRIu64 : "%" PRIu64,
+				e->latency[i]);
+
+		dprintf(dump.fd, "\n");
+	}
+}
+
+static void *dump_thread(void *arg)
+{
+	QNode *node = NULL;
+	struct invoke_stats *stats = NULL;
+
+	(void)arg;
+
+	for (;;) {
+		if (sem_wait(&dump.wake))
+			continue;
+
+		pthread_mutex_lock(&dump.lock);
+
+		QLIST_FOR_ALL(&dump.stats, node)
+		{
+			stats = (struct invoke_stats *)node;
+
+			pthread_mutex_lock(&stats->lock);
+			dump_stats(stats);
+			pthread_mutex_unlock(&stats->lock);
+		}
+
+		pthread_mutex_unlock(&dump.lock);
+	}
+
+	return NULL;
+}
+
+/* Only async-signal-safe calls here; the thread does the dumping */
+static void dump_signal(int signum)
+{
+	int saved_errno = errno;
+
+	(void)signum;
+
+	sem_post(&dump.wake);
+
+	errno = saved_errno;
+}
+
+TEEC_Result invoke_stats_dump_on_signal(int signum, int fd)
+{
+	struct sigaction sa;
+	pthread_attr_t attr;
+	pthread_t thread;
+	TEEC_Result ret = TEEC_SUCCESS;
+
+	pthread_mutex_lock(&dump.lock);
+
+	if (!dump.started) {
+		sem_init(&dump.wake, 0, 0);
+
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+		if (pthread_create(&thread, &attr, dump_thread, NULL)) {
+			MSGE("pthread_create failed for the stats dump\n");
+			ret = TEEC_ERROR_GENERIC;
+		} else {
+			dump.started = true;
+		}
+
+		pthread_attr_destroy(&attr);
+
+		if (ret)
+			goto out;
+	}
+
+	dump.fd = fd;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = dump_signal;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(signum, &sa, NULL)) {
+		MSGE("sigaction failed for signal %d: %d\n", signum, errno);
+		ret = TEEC_ERROR_GENERIC;
+	}
+
+out:
+	pthread_mutex_unlock(&dump.lock);
+
+	return ret;
+}
+
+uint32_t invoke_stats_default_commands(void)
+{
+	return default_commands;
+}
+
+/**
+ * @brief Count the invocations of every TEE context, and dump the counters
+ * on the signal given by MINKTEEC_STATS, when the library is loaded. The
+ * variable is ignored in setuid programs, not to let their caller install a
+ * signal handler dumping the counters of the process.
+ */
+__attribute__((constructor)) static void invoke_stats_init(void)
+{
+	const char *env = secure_getenv(STATS_ENV);
+	char *end = NULL;
+	long signum = 0;
+
+	if (!env || !*env)
+		return;
+
+	signum = strtol(env, &end, 0);
+	if (*end || signum <= 0 || signum >= NSIG) {
+		MSGE("Invalid %s=%s\n", STATS_ENV, env);
+		return;
+	}
+
+	if (invoke_stats_dump_on_signal((int)signum, STDERR_FILENO))
+		return;
+
+	default_commands = STATS_ENV_COMMANDS;
+}
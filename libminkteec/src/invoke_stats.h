@@ -0,0 +1,113 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __INVOKE_STATS_H_
+#define __INVOKE_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tee_client_api_ext.h"
+
+/* Invocation counters.
+ *
+ * Each session of a TEE context with counters keeps a table of counters by
+ * command ID, updated once each invocation completes. The memory objects
+ * and copies an invocation needs happen deep in the conversion of its
+ * parameters, so they are tallied per thread and the tallies sampled when
+ * the invocation begins and ends.
+ *
+ * The tables of all sessions are also kept process-wide, for a thread to
+ * dump them when the process is signalled.
+ */
+
+struct invoke_stats;
+
+struct invoke_sample {
+	uint64_t start;
+	uint64_t mem_objs;
+	uint64_t copy_bytes;
+	uint64_t bytes_in[TEEC_STATS_PARAM_CLASSES];
+};
+
+/**
+ * @brief Create the counters of a session.
+ *
+ * @param session The open session.
+ * @param max_commands The number of commands counted apart.
+ * @return The counters, or NULL if out of memory.
+ */
+struct invoke_stats *invoke_stats_new(TEEC_Session *session,
+				      uint32_t max_commands);
+
+/**
+ * @brief Free the counters of a session.
+ *
+ * @param stats The counters, or NULL.
+ */
+void invoke_stats_free(struct invoke_stats *stats);
+
+/**
+ * @brief Start sampling an invocation.
+ *
+ * @param sample The sample, on the stack of the invoking thread.
+ * @param op The operation of the invocation as given by the client, or NULL.
+ */
+void invoke_stats_begin(struct invoke_sample *sample, const TEEC_Operation *op);
+
+/**
+ * @brief Count a completed invocation.
+ *
+ * @param stats The counters of the session.
+ * @param sample The sample started with invoke_stats_begin().
+ * @param command_id The command.
+ * @param op The operation, updated with the results, or NULL.
+ * @param result The result of the invocation.
+ */
+void invoke_stats_end(struct invoke_stats *stats, struct invoke_sample *sample,
+		      uint32_t command_id, const TEEC_Operation *op,
+		      TEEC_Result result);
+
+/**
+ * @brief Get the counters of a session, costliest command first.
+ *
+ * @param stats The counters of the session.
+ * @param out The counters of up to *num commands.
+ * @param num The number of entries in out, set to the number of commands.
+ * @return TEEC_SUCCESS if every command was returned.
+ *         TEEC_ERROR_SHORT_BUFFER if out is too small.
+ *         TEEC_ERROR_OUT_OF_MEMORY if out of memory.
+ */
+TEEC_Result invoke_stats_get(struct invoke_stats *stats,
+			     TEEC_CommandStatistics *out, uint32_t *num);
+
+/**
+ * @brief Tally a memory object allocated or registered by this thread.
+ */
+void invoke_stats_count_mem_obj(void);
+
+/**
+ * @brief Tally bytes copied by this thread to or from a memory object.
+ *
+ * @param bytes The number of bytes.
+ */
+void invoke_stats_count_copy(size_t bytes);
+
+/**
+ * @brief Dump the counters of every session to a file on a signal.
+ *
+ * @param signum The signal.
+ * @param fd The file descriptor.
+ * @return TEEC_SUCCESS if the signal was set up.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result invoke_stats_dump_on_signal(int signum, int fd);
+
+/**
+ * @brief Get the number of commands counted apart in new TEE contexts.
+ *
+ * @return The number set with MINKTEEC_STATS, or 0 to count nothing.
+ */
+uint32_t invoke_stats_default_commands(void);
+
+#endif // __INVOKE_STATS_H_
@@ -0,0 +1,172 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "invoke_timer.h"
+#include "mink_teec.h"
+
+#include "IWait.h"
+
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_SEC  1000000000ULL
+
+struct invoke_timer {
+	Object waiter_cbo;
+	/* Soonest expiry first */
+	QList deadlines;
+	bool started;
+	bool stopping;
+	/* Protect the list, started and stopping */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	pthread_t thread;
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void *invoke_timer_thread(void *arg)
+{
+	struct invoke_timer *timer = arg;
+	struct invoke_deadline *d = NULL;
+	struct timespec wakeup;
+
+	pthread_mutex_lock(&timer->lock);
+
+	while (!timer->stopping) {
+		d = (struct invoke_deadline *)QList_getFirst(&timer->deadlines);
+		if (!d) {
+			pthread_cond_wait(&timer->cond, &timer->lock);
+			continue;
+		}
+
+		if (d->expiry > now_ns()) {
+			wakeup.tv_sec = (time_t)(d->expiry / NSEC_PER_SEC);
+			wakeup.tv_nsec = (long)(d->expiry % NSEC_PER_SEC);
+			pthread_cond_timedwait(&timer->cond, &timer->lock,
+					       &wakeup);
+			continue;
+		}
+
+		/* The deadline is dequeued, so the invoking thread knows the
+		 * command was cancelled when it disarms it.
+		 */
+		QNode_dequeue(&d->qn);
+		d->expired = true;
+
+		IWait_signal(timer->waiter_cbo, d->cancel_code,
+			     IWait_EVENT_CANCEL);
+	}
+
+	pthread_mutex_unlock(&timer->lock);
+
+	return NULL;
+}
+
+struct invoke_timer *invoke_timer_new(Object waiter_cbo)
+{
+	struct invoke_timer *timer = calloc(1, sizeof(*timer));
+	pthread_condattr_t attr;
+
+	if (!timer)
+		return NULL;
+
+	timer->waiter_cbo = waiter_cbo;
+	QList_construct(&timer->deadlines);
+	pthread_mutex_init(&timer->lock, NULL);
+
+	/* Deadlines are not to jump with the system clock */
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&timer->cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	return timer;
+}
+
+void invoke_timer_free(struct invoke_timer *timer)
+{
+	if (!timer)
+		return;
+
+	pthread_mutex_lock(&timer->lock);
+	timer->stopping = true;
+	pthread_cond_signal(&timer->cond);
+	pthread_mutex_unlock(&timer->lock);
+
+	if (timer->started)
+		pthread_join(timer->thread, NULL);
+
+	pthread_cond_destroy(&timer->cond);
+	pthread_mutex_destroy(&timer->lock);
+	free(timer);
+}
+
+bool invoke_timer_arm(struct invoke_timer *timer,
+		      struct invoke_deadline *deadline, uint32_t cancel_code,
+		      uint32_t msec)
+{
+	QNode *node = NULL;
+
+	QNode_construct(&deadline->qn);
+	deadline->expiry = now_ns() + msec * NSEC_PER_MSEC;
+	deadline->cancel_code = cancel_code;
+	deadline->expired = false;
+
+	pthread_mutex_lock(&timer->lock);
+
+	if (!timer->started) {
+		if (pthread_create(&timer->thread, NULL, invoke_timer_thread,
+				   timer)) {
+			pthread_mutex_unlock(&timer->lock);
+			MSGE("pthread_create failed for the invoke timer\n");
+			return false;
+		}
+
+		timer->started = true;
+	}
+
+	/* Commands mostly share a timeout, so their deadline goes last */
+	QLIST_REV_FOR_ALL(&timer->deadlines, node)
+	{
+		if (((struct invoke_deadline *)node)->expiry <= deadline->expiry)
+			break;
+	}
+
+	QNode_insNext(node, &deadline->qn);
+
+	/* Wake the thread up if this deadline is now the soonest */
+	if (QList_getFirst(&timer->deadlines) == &deadline->qn)
+		pthread_cond_signal(&timer->cond);
+
+	pthread_mutex_unlock(&timer->lock);
+
+	return true;
+}
+
+bool invoke_timer_disarm(struct invoke_timer *timer,
+			 struct invoke_deadline *deadline)
+{
+	bool expired = false;
+
+	pthread_mutex_lock(&timer->lock);
+
+	expired = deadline->expired;
+	if (!expired)
+		QNode_dequeue(&deadline->qn);
+
+	pthread_mutex_unlock(&timer->lock);
+
+	return expired;
+}
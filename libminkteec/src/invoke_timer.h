@@ -0,0 +1,75 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __INVOKE_TIMER_H_
+#define __INVOKE_TIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "object.h"
+#include "qlist.h"
+
+/* Invocation timer.
+ *
+ * The timeout of a command is passed to QTEE with it, but a TA only stops at
+ * a cancellation. Each TEE context keeps a timer thread which signals
+ * IWait_EVENT_CANCEL on the CWait object of the context for the commands
+ * whose timeout expired, as TEEC_RequestCancellation() does.
+ *
+ * Deadlines are owned by the invoking thread, on its stack, and kept in a
+ * list sorted by expiry. The thread is started on the first deadline armed.
+ */
+
+struct invoke_timer;
+
+struct invoke_deadline {
+	QNode qn;
+
+	/* Expiry on CLOCK_MONOTONIC, in nanoseconds */
+	uint64_t expiry;
+	uint32_t cancel_code;
+	bool expired;
+};
+
+/**
+ * @brief Create a timer for a TEE context.
+ *
+ * @param waiter_cbo The CWait object of the context, which must outlive the
+ *                   timer.
+ * @return The timer, or NULL if out of memory.
+ */
+struct invoke_timer *invoke_timer_new(Object waiter_cbo);
+
+/**
+ * @brief Stop the thread of a timer and free it.
+ *
+ * @param timer The timer, or NULL.
+ */
+void invoke_timer_free(struct invoke_timer *timer);
+
+/**
+ * @brief Arm a deadline for a command.
+ *
+ * @param timer The timer.
+ * @param deadline The deadline, valid until disarmed.
+ * @param cancel_code The cancel code of the command.
+ * @param msec Time in milliseconds until the command is cancelled.
+ * @return true if the deadline was armed.
+ *         false if the thread of the timer could not be started.
+ */
+bool invoke_timer_arm(struct invoke_timer *timer,
+		      struct invoke_deadline *deadline, uint32_t cancel_code,
+		      uint32_t msec);
+
+/**
+ * @brief Disarm the deadline of a completed command.
+ *
+ * @param timer The timer.
+ * @param deadline The deadline armed with invoke_timer_arm().
+ * @return true if the deadline expired, and the command was cancelled.
+ */
+bool invoke_timer_disarm(struct invoke_timer *timer,
+			 struct invoke_deadline *deadline);
+
+#endif // __INVOKE_TIMER_H_
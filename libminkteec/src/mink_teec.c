@@ -1,19 +1,86 @@
 // Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
 // SPDX-License-Identifier: BSD-3-Clause
 
+#define _GNU_SOURCE /* memfd_create(), secure_getenv() */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "mink_teec.h"
+#include "bounce_pool.h"
+#include "completion_queue.h"
+#include "context_pool.h"
+#include "inflight.h"
+#include "invoke_stats.h"
+#include "invoke_timer.h"
 #include "MinkCom.h"
+#include "probes.h"
+#include "session_pool.h"
+#include "session_recovery.h"
+#include "shm_cache.h"
+#include "worker_pool.h"
 
 #include "IClientEnv.h"
 #include "IGPSession.h"
 #include "IGPAppClient.h"
 #include "CGPAppClient.h"
+#include "CGPLocal_open.h"
 #include "CWait_open.h"
 #include "IWait.h"
 #include "memscpy.h"
 
+#define LOCAL_TA_ENV "MINKTEEC_LOCAL_TA"
+
+/* Cleared once QCOMTEE turns out not to support registering client memory. */
+static atomic_bool register_in_place_supported = true;
+
+/* Cancel codes are handed out to threads in blocks of CANCEL_CODE_BLOCK, so
+ * that threads invoking concurrently do not contend for them.
+ */
+#define CANCEL_CODE_BLOCK 1024
+
+static atomic_uint cancel_code_next;
+static __thread uint32_t cancel_code_cur;
+static __thread uint32_t cancel_code_end;
+
+#ifdef MINKTEEC_LOCAL_TA
+/**
+ * @brief Check whether sessions are to be opened with the local reference TA
+ * rather than QTEE.
+ *
+ * Only libraries built with the local TA honour MINKTEEC_LOCAL_TA: 1 selects
+ * the local TA and 0 QTEE, over the default the library was built with. It is
+ * ignored in setuid programs, and each switch is logged.
+ */
+static bool use_local_ta(void)
+{
+	static atomic_bool last = MINKTEEC_LOCAL_TA;
+	const char *env = secure_getenv(LOCAL_TA_ENV);
+	bool local = MINKTEEC_LOCAL_TA;
+
+	if (env && *env)
+		local = strcmp(env, "0") != 0;
+
+	/* On stderr, not to mix with the output of the client */
+	if (atomic_exchange(&last, local) != local)
+		fprintf(stderr, "%s: opening sessions with %s\n", LOCAL_TA_ENV,
+			local ? "the local reference TA" : "QTEE");
+
+	return local;
+}
+#endif
+
 /**
  * @brief Get a MINK AppClient Object.
  *
@@ -27,6 +94,11 @@ static int32_t mink_get_app_client(Object root_obj, Object *app_client)
 	int32_t rv = Object_OK;
 	Object client_env = Object_NULL;
 
+#ifdef MINKTEEC_LOCAL_TA
+	if (use_local_ta())
+		return CGPLocal_open(app_client);
+#endif
+
 	rv = MinkCom_getClientEnvObject(root_obj, &client_env);
 	if (Object_isERROR(rv)) {
 		MSGE("MinkCom_getClientEnvObject failed: 0x%x\n", rv);
@@ -156,6 +228,8 @@ mink_open_session(Object app_client, Object waiter_cbo,
  * @param command_id Identifier for the command to invoke.
  * @param cancel_code A cancellation code to identify the cancellation request
  *                    on behalf of QTEE.
+ * @param timeout Time in milliseconds for the command to complete, or
+ *                MINK_TEEC_TIMEOUT_INFINITE.
  * @param tee_paramTypes The type of the parameters in this request.
  * @param tee_exParamTypes The type of the extended parameters in this request
  *                         for use by QTEE.
@@ -166,7 +240,7 @@ mink_open_session(Object app_client, Object waiter_cbo,
  *         Object_ERROR_* on failure.
  */
 static int32_t mink_invoke_command(Object session, uint32_t command_id,
-				   uint32_t cancel_code,
+				   uint32_t cancel_code, uint32_t timeout,
 				   uint32_t tee_paramTypes,
 				   uint32_t tee_exParamTypes,
 				   MINK_Parameter *m_params,
@@ -178,7 +252,7 @@ static int32_t mink_invoke_command(Object session, uint32_t command_id,
 	rv = IGPSession_invokeCommand(session,
 				      command_id,
 				      cancel_code,
-				      MINK_TEEC_TIMEOUT_INFINITE,
+				      timeout,
 				      tee_paramTypes,
 				      tee_exParamTypes,
 				      m_params[0].in_buf.buf,
@@ -363,48 +437,70 @@ static bool is_mem_obj_equal(Object mo1, Object mo2)
 }
 
 /**
- * @brief Copy the contents of Shared Memory to a Memory object represented
+ * @brief Copy a range of Shared Memory to a Memory object represented
  *        memory.
  *
  * @param shm The Shared Memory to copy from.
  * @param mo The Memory Object to copy to.
+ * @param offset Offset of the range in the Shared Memory.
+ * @param size Size of the range.
  * @return Object_OK on success.
  *         Object_ERROR_* on failure.
  */
-static int32_t copy_to_mem_object(TEEC_SharedMemory *shm, Object mo)
+static int32_t copy_to_mem_object(TEEC_SharedMemory *shm, Object mo,
+				  size_t offset, size_t size)
 {
 	int32_t rv = Object_OK;
 	void *mo_addr;
 	size_t mo_size;
+	size_t copied;
 
 	rv = MinkCom_getMemoryObjectInfo(mo, &mo_addr, &mo_size);
 	if (Object_isERROR(rv))
 		return rv;
 
-	memscpy(mo_addr, mo_size, shm->buffer, shm->size);
+	if (offset > shm->size || offset > mo_size)
+		return Object_ERROR_SIZE_IN;
+
+	copied = memscpy((uint8_t *)mo_addr + offset, mo_size - offset,
+			 (uint8_t *)shm->buffer + offset,
+			 size < shm->size - offset ? size : shm->size - offset);
+
+	invoke_stats_count_copy(copied);
 	return rv;
 }
 
 /**
- * @brief Copy the contents of a Memory object represented memory to a Shared
+ * @brief Copy a range of a Memory object represented memory to a Shared
  *        Memory.
  *
  * @param mo The Memory Object to copy from.
  * @param shm The Shared Memory to copy to.
+ * @param offset Offset of the range in the Shared Memory.
+ * @param size Size of the range.
  * @return Object_OK on success.
  *         Object_ERROR_* on failure.
  */
-static int32_t copy_from_mem_object(Object mo, TEEC_SharedMemory *shm)
+static int32_t copy_from_mem_object(Object mo, TEEC_SharedMemory *shm,
+				    size_t offset, size_t size)
 {
 	int32_t rv = Object_OK;
 	void *mo_addr;
 	size_t mo_size;
+	size_t copied;
 
 	rv = MinkCom_getMemoryObjectInfo(mo, &mo_addr, &mo_size);
 	if (Object_isERROR(rv))
 		return rv;
 
-	memscpy(shm->buffer, shm->size, mo_addr, mo_size);
+	if (offset > shm->size || offset > mo_size)
+		return Object_ERROR_SIZE_OUT;
+
+	copied = memscpy((uint8_t *)shm->buffer + offset, shm->size - offset,
+			 (uint8_t *)mo_addr + offset,
+			 size < mo_size - offset ? size : mo_size - offset);
+
+	invoke_stats_count_copy(copied);
 	return rv;
 }
 
@@ -420,12 +516,21 @@ static void memref_temp_from_partial(size_t i, uint32_t *param_types,
 {
 	uint32_t type = TEEC_PARAM_TYPE_GET(*param_types, i);
 	TEEC_RegisteredMemoryReference memref = params[i].memref;
+	TEEC_SharedMemory *shm = memref.parent;
 
 	memset((void *)(&params[i]), 0, sizeof(TEEC_Parameter));
-	params[i].tmpref.buffer = memref.parent->buffer;
-	params[i].tmpref.size = memref.parent->size;
+	params[i].tmpref.buffer = shm->buffer;
+	params[i].tmpref.size = shm->size;
+
+	/* Keep the bounce buffer for the next temporary memory reference */
+	if (!shm->imp.in_place && !Object_isNull(shm->imp.mem_obj)) {
+		bounce_pool_put(shm->imp.ctx->imp.bounce_pool,
+				shm->imp.mem_obj);
+		shm->imp.mem_obj = Object_NULL;
+	}
 
-	free((void *)memref.parent);
+	release_shared_memory(shm);
+	free((void *)shm);
 	/* Convert MEMREF_PARTIAL_* to MEMREF_TEMP_* type */
 	*param_types = TEEC_PARAM_TYPE_SET(type ^ 0x00000008, i, *param_types);
 }
@@ -478,31 +583,39 @@ static TEEC_Result memref_temp_to_partial(TEEC_Context *ctx, size_t i,
 	uint32_t type = TEEC_PARAM_TYPE_GET(*param_types, i);
 	TEEC_TempMemoryReference tmpref = params[i].tmpref;
 	size_t shm_size = sizeof(TEEC_SharedMemory);
+	TEEC_Result result = TEEC_SUCCESS;
 
-	TEEC_SharedMemory *shm = (TEEC_SharedMemory *)malloc(shm_size);
+	TEEC_SharedMemory *shm = (TEEC_SharedMemory *)calloc(1, shm_size);
 	if (!shm)
 		return TEEC_ERROR_OUT_OF_MEMORY;
 
-	memset((void *)&params[i], 0, sizeof(TEEC_Parameter));
-	params[i].memref.parent = shm;
-	params[i].memref.parent->buffer = tmpref.buffer;
-	params[i].memref.parent->size = tmpref.size;
-	params[i].memref.parent->flags = 0;
-	params[i].memref.offset = 0;
-	params[i].memref.size = tmpref.size;
+	shm->buffer = tmpref.buffer;
+	shm->size = tmpref.size;
 
 	if (type == TEEC_MEMREF_TEMP_INPUT ||
 	    type == TEEC_MEMREF_TEMP_INOUT)
-		params[i].memref.parent->flags |= TEEC_MEM_INPUT;
+		shm->flags |= TEEC_MEM_INPUT;
 
 	if (type == TEEC_MEMREF_TEMP_OUTPUT ||
 	    type == TEEC_MEMREF_TEMP_INOUT)
-		params[i].memref.parent->flags |= TEEC_MEM_OUTPUT;
+		shm->flags |= TEEC_MEM_OUTPUT;
+
+	/* Leave the parameter untouched if it cannot be converted */
+	result = register_shared_memory(ctx, shm, TRUE);
+	if (result) {
+		free((void *)shm);
+		return result;
+	}
+
+	memset((void *)&params[i], 0, sizeof(TEEC_Parameter));
+	params[i].memref.parent = shm;
+	params[i].memref.offset = 0;
+	params[i].memref.size = tmpref.size;
 
 	/* Convert MEMREF_TEMP_* to MEMREF_PARTIAL_* type */
 	*param_types = TEEC_PARAM_TYPE_SET(type | 0x00000008, i, *param_types);
 
-	return register_shared_memory(ctx, params[i].memref.parent, TRUE);
+	return TEEC_SUCCESS;
 }
 
 /**
@@ -558,15 +671,21 @@ out_failed:
  * @brief Update the contents of Shared Memory with it's associated Memory
  *        object.
  *
+ * Only the range referenced by each output parameter is copied, up to the
+ * size returned by the TA.
+ *
  * @param param_types The parameter type encoding for the list of parameters.
  * @param params The list of parameters.
+ * @param m_params The MINK parameters the operation was sent with.
  */
 static void update_shm_memref_from_mem_obj(uint32_t param_types,
-					   TEEC_Parameter *params)
+					   TEEC_Parameter *params,
+					   MINK_Parameter *m_params)
 {
 	uint32_t type = TEEC_NONE;
 	TEEC_SharedMemory *shm;
 	Object mem_obj;
+	size_t offset, size;
 
 	for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
 
@@ -578,9 +697,26 @@ static void update_shm_memref_from_mem_obj(uint32_t param_types,
 
 			shm = params[i].memref.parent;
 			mem_obj = shm->imp.mem_obj;
-			if (!Object_isNull(mem_obj) &&
-			    shm->imp.type == TEEC_MEMORY_REGISTERED)
-				copy_from_mem_object(mem_obj, shm);
+			if (Object_isNull(mem_obj) ||
+			    shm->imp.type != TEEC_MEMORY_REGISTERED ||
+			    shm->imp.in_place)
+				break;
+
+			if (type == TEEC_MEMREF_WHOLE &&
+			    !(shm->flags & TEEC_MEM_OUTPUT))
+				break;
+
+			offset = type == TEEC_MEMREF_WHOLE ?
+					 0 : params[i].memref.offset;
+
+			/* The TA may report more than fits, e.g. for
+			 * TEEC_ERROR_SHORT_BUFFER; never copy past the range.
+			 */
+			size = params[i].memref.size;
+			if (size > m_params[i].mem_obj_params.size)
+				size = m_params[i].mem_obj_params.size;
+
+			copy_from_mem_object(mem_obj, shm, offset, size);
 			break;
 		default:
 			break;
@@ -737,12 +873,15 @@ static void assign_extended_params(size_t index, int shm_index,
  * @param param_types The parameter type encoding for the list of parameters.
  * @param params The list of parameters.
  * @param m_params The list of MINK Parameters to be assigned.
+ * @param shm_obj_indices The shared memory object index of each parameter,
+ *                        or NULL to look it up.
  * @param tee_exParamTypes The parameter type encoding for extended parameters
  *                         in this request for use by QTEE.
  */
 static void process_memref_whole(size_t i, uint32_t param_types,
 				 TEEC_Parameter *params,
 				 MINK_Parameter *m_params,
+				 const size_t *shm_obj_indices,
 				 uint32_t *tee_exParamTypes)
 {
 	uint32_t type = TEEC_PARAM_TYPE_GET(param_types, i);
@@ -761,23 +900,28 @@ static void process_memref_whole(size_t i, uint32_t param_types,
 
 		/* We need to set the memory object and it's parameters */
 		*mem_obj = memref_mem_obj;
-		mem_obj_params->offset = 0;
+		mem_obj_params->offset = shm->imp.offset;
 		mem_obj_params->size = params[i].memref.parent->size;
 
-		/* In case of TEEC_MEMORY_ALLOCATED, shm->buffer already
-		 * points to memory object backed memory, thus no need for copy.
+		/* In case of TEEC_MEMORY_ALLOCATED, or memory registered in
+		 * place, shm->buffer already points to memory object backed
+		 * memory, thus no need for copy.
 		 */
-		if (shm->imp.type == TEEC_MEMORY_REGISTERED)
-			copy_to_mem_object(shm, memref_mem_obj);
+		if (shm->imp.type == TEEC_MEMORY_REGISTERED &&
+		    !shm->imp.in_place && (shm->flags & TEEC_MEM_INPUT))
+			copy_to_mem_object(shm, memref_mem_obj, 0, shm->size);
 
 		inbuf->buf = mem_obj_params;
 		inbuf->len = sizeof(*mem_obj_params);
 
 		/* Does this memory reference share it's memory object with
 		 * another memory reference? */
-		shm_obj_index = get_shared_mem_obj_index(i, memref_mem_obj,
-							 param_types,
-							 params);
+		if (shm_obj_indices)
+			shm_obj_index = shm_obj_indices[i];
+		else
+			shm_obj_index = get_shared_mem_obj_index(i,
+							memref_mem_obj,
+							param_types, params);
 
 		if (shm_obj_index != DEFINING_INDEX_NA)
 			assign_extended_params(i, shm_obj_index, type,
@@ -810,12 +954,15 @@ static void process_memref_whole(size_t i, uint32_t param_types,
  * @param param_types The parameter type encoding for the list of parameters.
  * @param params The list of parameters.
  * @param m_params The list of MINK Parameters to be assigned.
+ * @param shm_obj_indices The shared memory object index of each parameter,
+ *                        or NULL to look it up.
  * @param tee_exParamTypes The parameter type encoding for extended parameters
  *                         in this request for use by QTEE.
  */
 static void process_memref_partial(size_t i, uint32_t param_types,
 				   TEEC_Parameter *params,
 				   MINK_Parameter *m_params,
+				   const size_t *shm_obj_indices,
 				   uint32_t *tee_exParamTypes)
 {
 	uint32_t type = TEEC_PARAM_TYPE_GET(param_types, i);
@@ -834,23 +981,33 @@ static void process_memref_partial(size_t i, uint32_t param_types,
 
 		/* We need to set the memory object and it's parameters */
 		*mem_obj = memref_mem_obj;
-		mem_obj_params->offset = params[i].memref.offset;
+		mem_obj_params->offset = shm->imp.offset +
+					 params[i].memref.offset;
 		mem_obj_params->size = params[i].memref.size;
 
-		/* In case of TEEC_MEMORY_ALLOCATED, shm->buffer already
-		 * points to memory object backed memory, thus no need for copy.
+		/* In case of TEEC_MEMORY_ALLOCATED, or memory registered in
+		 * place, shm->buffer already points to memory object backed
+		 * memory, thus no need for copy.
 		 */
-		if (shm->imp.type == TEEC_MEMORY_REGISTERED)
-			copy_to_mem_object(shm, memref_mem_obj);
+		if (shm->imp.type == TEEC_MEMORY_REGISTERED &&
+		    !shm->imp.in_place &&
+		    (type == TEEC_MEMREF_PARTIAL_INPUT ||
+		     type == TEEC_MEMREF_PARTIAL_INOUT))
+			copy_to_mem_object(shm, memref_mem_obj,
+					   params[i].memref.offset,
+					   params[i].memref.size);
 
 		inbuf->buf = mem_obj_params;
 		inbuf->len = sizeof(*mem_obj_params);
 
 		/* Does this memory reference share it's memory object with
 		 * another memory reference? */
-		shm_obj_index = get_shared_mem_obj_index(i, memref_mem_obj,
-							 param_types,
-							 params);
+		if (shm_obj_indices)
+			shm_obj_index = shm_obj_indices[i];
+		else
+			shm_obj_index = get_shared_mem_obj_index(i,
+							memref_mem_obj,
+							param_types, params);
 
 		if (shm_obj_index != DEFINING_INDEX_NA)
 			assign_extended_params(i, shm_obj_index, type,
@@ -883,12 +1040,16 @@ static void process_memref_partial(size_t i, uint32_t param_types,
  * @param param_types The parameter type encoding for the operation payload.
  * @param params The list of TEEC_* parameters in operation payload.
  * @param m_params The MINK parameters to be passed to a MINK API.
+ * @param shm_obj_indices The shared memory object index of each memory
+ *                        reference, as found by get_shared_mem_obj_index(),
+ *                        or NULL to look them up.
  * @param tee_exParamTypes The extended parameters type encoding in this
  *                         request for use by QTEE.
  */
 static void mink_params_from_teec_params(uint32_t param_types,
 					 TEEC_Parameter *params,
 					 MINK_Parameter *m_params,
+					 const size_t *shm_obj_indices,
 					 uint32_t *tee_exParamTypes)
 {
 	uint32_t type = TEEC_NONE;
@@ -915,12 +1076,14 @@ static void mink_params_from_teec_params(uint32_t param_types,
 		case TEEC_MEMREF_PARTIAL_INOUT:
 
 			process_memref_partial(i, param_types, params, m_params,
+					       shm_obj_indices,
 					       tee_exParamTypes);
 
 			break;
 		case TEEC_MEMREF_WHOLE:
 
 			process_memref_whole(i, param_types, params, m_params,
+					     shm_obj_indices,
 					     tee_exParamTypes);
 			break;
 		default:
@@ -929,7 +1092,69 @@ static void mink_params_from_teec_params(uint32_t param_types,
 	}
 }
 
-TEEC_Result initialize_context(TEEC_Context *ctx)
+uint32_t new_cancel_code(void)
+{
+	uint32_t code = 0;
+
+	while (!code) {
+		if (cancel_code_cur == cancel_code_end) {
+			cancel_code_cur = atomic_fetch_add_explicit(
+				&cancel_code_next, CANCEL_CODE_BLOCK,
+				memory_order_relaxed);
+			cancel_code_end = cancel_code_cur + CANCEL_CODE_BLOCK;
+		}
+
+		/* 0 means no cancel code to CWait */
+		code = cancel_code_cur++ & CANCEL_CODE_MASK;
+	}
+
+	return code;
+}
+
+void bind_operation(TEEC_Context *ctx, TEEC_Session *session,
+		    TEEC_Operation *op, struct completion_queue *cq)
+{
+	op->imp.cancel_code = new_cancel_code();
+	op->imp.session = session;
+	op->imp.cq = cq;
+	op->imp.session_gen = __atomic_load_n(&session->imp.cancel_gen,
+					      __ATOMIC_SEQ_CST);
+	op->imp.context_gen = __atomic_load_n(&ctx->imp.cancel_gen,
+					      __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Check whether the session or TEE context of an operation was
+ * cancelled since the operation was bound to them.
+ */
+static bool operation_cancelled(TEEC_Context *ctx, TEEC_Session *session,
+				TEEC_Operation *op)
+{
+	return op->imp.session_gen != __atomic_load_n(&session->imp.cancel_gen,
+						      __ATOMIC_SEQ_CST) ||
+	       op->imp.context_gen != __atomic_load_n(&ctx->imp.cancel_gen,
+						      __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Tag the calling thread with a correlation ID for a client request.
+ *
+ * A client may set its own correlation ID with MinkCom_setCorrelationId()
+ * to follow a request; otherwise a new one is used for its duration.
+ *
+ * @return The correlation ID to restore once the request is complete.
+ */
+static uint64_t correlation_begin(void)
+{
+	uint64_t prev = MinkCom_getCorrelationId();
+
+	if (!prev)
+		MinkCom_setCorrelationId(MinkCom_newCorrelationId());
+
+	return prev;
+}
+
+TEEC_Result open_connection(struct context_conn *conn)
 {
 	TEEC_Result ret = TEEC_SUCCESS;
 	int32_t rv = Object_OK;
@@ -960,12 +1185,9 @@ TEEC_Result initialize_context(TEEC_Context *ctx)
 		goto err_waiter_cbo;
 	}
 
-	/* Store these Mink Objects for the current
-	 * context
-	 */
-	ctx->imp.root_obj = root_obj;
-	ctx->imp.app_client = app_client;
-	ctx->imp.waiter_cbo = waiter_cbo;
+	conn->root_obj = root_obj;
+	conn->app_client = app_client;
+	conn->waiter_cbo = waiter_cbo;
 
 	return ret;
 
@@ -978,11 +1200,365 @@ err_gp_app_client:
 	return ret;
 }
 
+void close_connection(struct context_conn *conn)
+{
+	Object_ASSIGN_NULL(conn->root_obj);
+	Object_ASSIGN_NULL(conn->waiter_cbo);
+	Object_ASSIGN_NULL(conn->app_client);
+}
+
+bool connection_healthy(const struct context_conn *conn)
+{
+	Object client_env = Object_NULL;
+	int32_t rv = Object_OK;
+
+	rv = MinkCom_getClientEnvObject(conn->root_obj, &client_env);
+	if (Object_isERROR(rv))
+		return false;
+
+	Object_ASSIGN_NULL(client_env);
+
+	return true;
+}
+
+TEEC_Result initialize_context(TEEC_Context *ctx)
+{
+	TEEC_Result ret = TEEC_SUCCESS;
+	struct context_conn conn;
+
+	/* Connecting to QTEE anew starts a supplicant and takes round trips */
+	if (!context_pool_get(&conn)) {
+		ret = open_connection(&conn);
+		if (ret != TEEC_SUCCESS)
+			return ret;
+	}
+
+	/* Store these Mink Objects for the current
+	 * context
+	 */
+	ctx->imp.root_obj = conn.root_obj;
+	ctx->imp.app_client = conn.app_client;
+	ctx->imp.waiter_cbo = conn.waiter_cbo;
+
+	/* Sessions are not pooled until configured */
+	ctx->imp.session_pool = NULL;
+
+	/* Nor recovered once defunct */
+	ctx->imp.recovery = NULL;
+
+	/* Nor their invocations counted, unless with MINKTEEC_STATS */
+	ctx->imp.stats_commands = invoke_stats_default_commands();
+
+	/* Without a pool, bounce buffers are allocated for each invocation */
+	ctx->imp.bounce_pool = bounce_pool_new();
+
+	/* Without a cache, small shared memory is copied on each invocation */
+	ctx->imp.shm_cache = shm_cache_new();
+
+	/* Without a timer, timeouts are only passed to QTEE */
+	ctx->imp.invoke_timeout = MINK_TEEC_TIMEOUT_INFINITE;
+	ctx->imp.invoke_timer = invoke_timer_new(conn.waiter_cbo);
+
+	/* Without the set, commands can only be cancelled one by one */
+	ctx->imp.inflight = inflight_new(conn.waiter_cbo);
+	ctx->imp.cancel_gen = 0;
+
+	return ret;
+}
+
 void finalize_context(TEEC_Context *ctx)
 {
-	Object_ASSIGN_NULL(ctx->imp.root_obj);
-	Object_ASSIGN_NULL(ctx->imp.waiter_cbo);
-	Object_ASSIGN_NULL(ctx->imp.app_client);
+	struct context_conn conn;
+
+	invoke_timer_free(ctx->imp.invoke_timer);
+	ctx->imp.invoke_timer = NULL;
+
+	inflight_free(ctx->imp.inflight);
+	ctx->imp.inflight = NULL;
+
+	session_pool_free(ctx->imp.session_pool);
+	ctx->imp.session_pool = NULL;
+
+	session_recovery_free(ctx->imp.recovery);
+	ctx->imp.recovery = NULL;
+
+	bounce_pool_free(ctx->imp.bounce_pool);
+	ctx->imp.bounce_pool = NULL;
+
+	shm_cache_free(ctx->imp.shm_cache);
+	ctx->imp.shm_cache = NULL;
+
+	conn.root_obj = ctx->imp.root_obj;
+	conn.app_client = ctx->imp.app_client;
+	conn.waiter_cbo = ctx->imp.waiter_cbo;
+
+	ctx->imp.root_obj = Object_NULL;
+	ctx->imp.app_client = Object_NULL;
+	ctx->imp.waiter_cbo = Object_NULL;
+
+	if (!context_pool_put(&conn))
+		close_connection(&conn);
+}
+
+TEEC_Result configure_session_pool(TEEC_Context *ctx,
+				   const TEEC_SessionPoolConfig *config)
+{
+	session_pool_free(ctx->imp.session_pool);
+	ctx->imp.session_pool = NULL;
+
+	if (!config || !config->maxSessions)
+		return TEEC_SUCCESS;
+
+	ctx->imp.session_pool = session_pool_new(config);
+	if (!ctx->imp.session_pool)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result
+configure_session_recovery(TEEC_Context *ctx,
+			   const TEEC_SessionRecoveryConfig *config)
+{
+	session_recovery_free(ctx->imp.recovery);
+	ctx->imp.recovery = NULL;
+
+	if (!config)
+		return TEEC_SUCCESS;
+
+	ctx->imp.recovery = session_recovery_new(config);
+	if (!ctx->imp.recovery)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	return TEEC_SUCCESS;
+}
+
+void configure_statistics(TEEC_Context *ctx,
+			  const TEEC_StatisticsConfig *config)
+{
+	ctx->imp.stats_commands = config ? config->maxCommands : 0;
+}
+
+TEEC_Result get_statistics(TEEC_Session *session,
+			   TEEC_CommandStatistics *stats, uint32_t *num)
+{
+	if (!session->imp.stats)
+		return TEEC_ERROR_BAD_STATE;
+
+	return invoke_stats_get(session->imp.stats, stats, num);
+}
+
+void get_session_pool_stats(TEEC_Context *ctx, TEEC_SessionPoolStats *stats)
+{
+	if (!ctx->imp.session_pool) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	session_pool_get_stats(ctx->imp.session_pool, stats);
+}
+
+void get_bounce_buffer_stats(TEEC_Context *ctx, TEEC_BounceBufferStats *stats)
+{
+	if (!ctx->imp.bounce_pool) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	bounce_pool_get_stats(ctx->imp.bounce_pool, stats);
+}
+
+void get_session_recovery_stats(TEEC_Context *ctx,
+				TEEC_SessionRecoveryStats *stats)
+{
+	if (!ctx->imp.recovery) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	session_recovery_get_stats(ctx->imp.recovery, stats);
+}
+
+/**
+ * @brief Re-open a session found defunct, unless another thread did already.
+ *
+ * The session is opened again with the Trusted Application, connection
+ * method and connection data it was opened with, and replaces the defunct
+ * one if this succeeds.
+ *
+ * @param session The session, opened without parameters.
+ * @param epoch The epoch of the defunct session object.
+ */
+static void recover_session(TEEC_Session *session, uint32_t epoch)
+{
+	TEEC_Context *ctx = session->imp.ctx;
+	Object session_obj = Object_NULL;
+	TEEC_Result result = TEEC_SUCCESS;
+	uint32_t eorigin = TEEC_ORIGIN_COMMS;
+	MINK_Parameter m_params[MAX_NUM_PARAMS];
+
+	if (!session_recovery_begin(ctx->imp.recovery, session, epoch))
+		return;
+
+	mink_params_INIT(m_params);
+
+	mink_open_session(ctx->imp.app_client, ctx->imp.waiter_cbo,
+			  &session->imp.uuid, new_cancel_code(),
+			  session->imp.login, session->imp.conn_data, 0, 0,
+			  m_params, &session_obj, &result, &eorigin);
+
+	if (result) {
+		MSGE("Recovering session failed: 0x%x, origin %u\n", result,
+		     eorigin);
+
+		/* As in open_session() */
+		if (eorigin == TEEC_ORIGIN_TRUSTED_APP)
+			Object_ASSIGN_NULL(session_obj);
+	}
+
+	session_recovery_end(ctx->imp.recovery, session, session_obj);
+}
+
+/**
+ * @brief Invoke a command within a session, cancelling it once its timeout
+ * expires or its session or TEE context is cancelled.
+ *
+ * As mink_invoke_command(), with the command in the in-flight commands of the
+ * session's TEE context and the context timer armed for its cancel code. An
+ * operation whose session or context was cancelled since it was bound to them
+ * completes with TEEC_ERROR_CANCEL without being invoked.
+ *
+ * In a TEE context with session recovery, a session found defunct is
+ * re-opened and, for idempotent commands, the command retried in it.
+ */
+static int32_t invoke_cancellable(TEEC_Session *session, uint32_t command_id,
+				  TEEC_Operation *op, uint32_t cancel_code,
+				  uint32_t timeout, uint32_t tee_paramTypes,
+				  uint32_t tee_exParamTypes,
+				  MINK_Parameter *m_params,
+				  TEEC_Result *result, uint32_t *eorigin)
+{
+	int32_t rv = Object_OK;
+	TEEC_Context *ctx = session->imp.ctx;
+	struct session_recovery *rec = ctx->imp.recovery;
+	Object session_obj = session->imp.session_obj;
+	struct invoke_deadline deadline;
+	struct inflight_cmd cmd;
+	size_t out_lens[MAX_NUM_PARAMS];
+	bool armed = false;
+	uint32_t epoch = 0;
+	uint32_t attempt = 0;
+
+	if (ctx->imp.inflight)
+		inflight_add(ctx->imp.inflight, &cmd, session, cancel_code);
+
+	/* Checked once in flight, not to miss a cancellation in between */
+	if (op && operation_cancelled(ctx, session, op)) {
+		*result = TEEC_ERROR_CANCEL;
+		*eorigin = TEEC_ORIGIN_API;
+		goto out;
+	}
+
+	if (timeout != MINK_TEEC_TIMEOUT_INFINITE && ctx->imp.invoke_timer)
+		armed = invoke_timer_arm(ctx->imp.invoke_timer, &deadline,
+					 cancel_code, timeout);
+
+	/* The sizes of the outputs are updated in place by each attempt */
+	for (size_t i = 0; i < MAX_NUM_PARAMS; i++)
+		out_lens[i] = m_params[i].out_buf.len;
+
+retry:
+	for (size_t i = 0; i < MAX_NUM_PARAMS; i++)
+		m_params[i].out_buf.len = out_lens[i];
+
+	/* Another thread may be replacing the object of a defunct session */
+	if (rec)
+		session_obj = session_recovery_object(rec, session, &epoch);
+
+	rv = mink_invoke_command(session_obj, command_id, cancel_code, timeout,
+				 tee_paramTypes, tee_exParamTypes, m_params,
+				 result, eorigin);
+
+	/* Held while invoked only, as a recovery may release it */
+	if (rec)
+		Object_ASSIGN_NULL(session_obj);
+
+	if (rec && *result == TEEC_ERROR_TARGET_DEAD &&
+	    *eorigin == TEEC_ORIGIN_TEE) {
+		recover_session(session, epoch);
+
+		if (!(op && operation_cancelled(ctx, session, op)) &&
+		    session_recovery_retry(rec, session, epoch, command_id,
+					   attempt++))
+			goto retry;
+	}
+
+	/* The TA may have completed without waiting for the cancellation */
+	if (armed && invoke_timer_disarm(ctx->imp.invoke_timer, &deadline))
+		CWait_clear(ctx->imp.waiter_cbo, cancel_code);
+
+out:
+	if (ctx->imp.inflight)
+		inflight_remove(ctx->imp.inflight, &cmd);
+
+	return rv;
+}
+
+/**
+ * @brief Check a pooled session with the health check command of the pool.
+ *
+ * The command is cancelled if it does not complete within
+ * TEEC_SESSION_POOL_HEALTH_CHECK_TIMEOUT, or the context is cancelled, so that
+ * a hung TA cannot block TEEC_OpenSession.
+ *
+ * @param session_obj The MINK object of the session.
+ * @param command_id The health check command.
+ * @return true if the command completed successfully.
+ */
+static bool session_healthy(TEEC_Session *session, uint32_t command_id)
+{
+	TEEC_Result result = TEEC_SUCCESS;
+	uint32_t eorigin = TEEC_ORIGIN_COMMS;
+	MINK_Parameter m_params[MAX_NUM_PARAMS];
+	mink_params_INIT(m_params);
+
+	if (invoke_cancellable(session, command_id, NULL, new_cancel_code(),
+			       TEEC_SESSION_POOL_HEALTH_CHECK_TIMEOUT, 0, 0,
+			       m_params, &result, &eorigin))
+		return false;
+
+	return result == TEEC_SUCCESS;
+}
+
+/**
+ * @brief Hand out an idle session of the session pool of the context.
+ *
+ * @param ctx The TEE context with a session pool.
+ * @param session The session to be established with QTEE.
+ * @return true if a pooled session was handed out.
+ *         false if a new session is to be opened.
+ */
+static bool open_pooled_session(TEEC_Context *ctx, TEEC_Session *session)
+{
+	struct session_pool *pool = ctx->imp.session_pool;
+	uint32_t command_id = 0;
+
+	while (session_pool_get(pool, &session->imp.uuid, session->imp.login,
+				session->imp.conn_data,
+				&session->imp.session_obj)) {
+		session->imp.ctx = ctx;
+
+		if (!session_pool_health_check(pool, &command_id) ||
+		    session_healthy(session, command_id))
+			return true;
+
+		session_pool_check_failed(pool);
+		Object_ASSIGN_NULL(session->imp.session_obj);
+	}
+
+	session->imp.ctx = NULL;
+
+	return false;
 }
 
 TEEC_Result open_session(TEEC_Context *ctx, TEEC_Session *session,
@@ -999,6 +1575,7 @@ TEEC_Result open_session(TEEC_Context *ctx, TEEC_Session *session,
 		conn_data = *(const uint32_t *)connection_data;
 
 	uint32_t cancel_code = 0;
+	struct inflight_cmd cmd;
 
 	if (ret_origin) {
 		*ret_origin = TEEC_ORIGIN_COMMS;
@@ -1009,30 +1586,76 @@ TEEC_Result open_session(TEEC_Context *ctx, TEEC_Session *session,
 	MINK_Parameter m_params[MAX_NUM_PARAMS];
 	mink_params_INIT(m_params);
 
+	uint64_t prev_id = correlation_begin();
+
+	PROBE(open_session_entry, session, conn_method,
+	      MinkCom_getCorrelationId());
+
+	session->imp.cancel_gen = 0;
+	session->imp.epoch = 0;
+	session->imp.stats = NULL;
+
 	if (op) {
-		cancel_code = (rand() & CANCEL_CODE_MASK);
-		op->imp.cancel_code = cancel_code;
-		op->imp.session = session;
+		bind_operation(ctx, session, op, NULL);
+		cancel_code = op->imp.cancel_code;
 
 		result = memref_temp_to_partial_params(ctx, &(op->paramTypes),
 						       op->params);
-		if (result)
+		if (result) {
+			PROBE(open_session_exit, session, result, eorigin,
+			      MinkCom_getCorrelationId());
+			MinkCom_setCorrelationId(prev_id);
 			return result;
+		}
 
 		mink_params_from_teec_params(op->paramTypes, op->params,
-					     m_params, &tee_exParamTypes);
+					     m_params, NULL,
+					     &tee_exParamTypes);
 
 		tee_types_from_teec_types(op, &tee_paramTypes);
 	}
 
+	/* Only sessions opened without parameters are interchangeable */
+	session->imp.uuid = *destination;
+	session->imp.login = conn_method;
+	session->imp.conn_data = conn_data;
+	session->imp.poolable = (!op || !op->paramTypes);
+	session->imp.broken = FALSE;
+
+	if (ctx->imp.session_pool && session->imp.poolable &&
+	    open_pooled_session(ctx, session)) {
+		if (ctx->imp.stats_commands)
+			session->imp.stats = invoke_stats_new(
+				session, ctx->imp.stats_commands);
+
+		if (ret_origin)
+			*ret_origin = TEEC_ORIGIN_TRUSTED_APP;
+
+		PROBE(open_session_exit, session, TEEC_SUCCESS,
+		      TEEC_ORIGIN_TRUSTED_APP, MinkCom_getCorrelationId());
+		MinkCom_setCorrelationId(prev_id);
+		return TEEC_SUCCESS;
+	}
+
+	/* Opening the session can be cancelled with the context */
+	if (!cancel_code)
+		cancel_code = new_cancel_code();
+
+	if (ctx->imp.inflight)
+		inflight_add(ctx->imp.inflight, &cmd, session, cancel_code);
+
 	ret = mink_open_session(ctx->imp.app_client, ctx->imp.waiter_cbo,
 				destination, cancel_code, conn_method,
 				conn_data, tee_paramTypes, tee_exParamTypes,
 				m_params, &(session->imp.session_obj), &result,
 				&eorigin);
 
+	if (ctx->imp.inflight)
+		inflight_remove(ctx->imp.inflight, &cmd);
+
 	if (ret)
-		MSGE("mink_open_session() failed: %d\n", ret);
+		MSGE("mink_open_session() failed: %d, request 0x%" PRIx64 "\n",
+		     ret, MinkCom_getCorrelationId());
 
 	if (result) {
 		/* If we have an error originating from trusted app, then
@@ -1044,36 +1667,555 @@ TEEC_Result open_session(TEEC_Context *ctx, TEEC_Session *session,
 			Object_ASSIGN_NULL(session->imp.session_obj);
 	} else {
 		session->imp.ctx = ctx;
+
+		/* Without counters, if out of memory, the session still works */
+		if (ctx->imp.stats_commands)
+			session->imp.stats = invoke_stats_new(
+				session, ctx->imp.stats_commands);
 	}
 
 	if (ret_origin)
 		*ret_origin = eorigin;
 
 	if (op) {
-		update_shm_memref_from_mem_obj(op->paramTypes, op->params);
+		update_shm_memref_from_mem_obj(op->paramTypes, op->params,
+					       m_params);
 
 		memref_temp_from_partial_params(&(op->paramTypes), op->params);
 	}
 
+	PROBE(open_session_exit, session, result, eorigin,
+	      MinkCom_getCorrelationId());
+
+	MinkCom_setCorrelationId(prev_id);
+
 	return result;
 }
 
 void close_session(TEEC_Session *session)
 {
-	Object_ASSIGN_NULL(session->imp.session_obj);
+	TEEC_Context *ctx = session->imp.ctx;
+
+	if (ctx && ctx->imp.session_pool && session->imp.poolable &&
+	    !session->imp.broken) {
+		/* The pool takes over the reference */
+		session_pool_put(ctx->imp.session_pool, &session->imp.uuid,
+				 session->imp.login, session->imp.conn_data,
+				 session->imp.session_obj);
+		session->imp.session_obj = Object_NULL;
+	} else {
+		Object_ASSIGN_NULL(session->imp.session_obj);
+	}
+
+	/* Recovered sessions leave their recovery state behind */
+	if (ctx && ctx->imp.recovery)
+		session_recovery_close(ctx->imp.recovery, session);
+
+	invoke_stats_free(session->imp.stats);
+	session->imp.stats = NULL;
+
 	session->imp.ctx = NULL;
 }
 
 TEEC_Result invoke_command(TEEC_Session *session, uint32_t command_id,
-			   TEEC_Operation *op, uint32_t *ret_origin)
+			   TEEC_Operation *op, uint32_t timeout,
+			   uint32_t *ret_origin)
 {
-	TEEC_Result ret = TEEC_SUCCESS;
+	if (op)
+		bind_operation(session->imp.ctx, session, op, NULL);
 
-	TEEC_Result result = TEEC_SUCCESS;
-	uint32_t eorigin = TEEC_ORIGIN_COMMS;
-	uint32_t cancel_code = 0;
+	return invoke_operation(session, command_id, op, timeout, ret_origin);
+}
 
-	TEEC_Context *ctx = session->imp.ctx;
+TEEC_Result invoke_command_batch(TEEC_Session *session, uint32_t num,
+				 const uint32_t *command_ids,
+				 TEEC_Operation **ops, TEEC_Result *results,
+				 uint32_t *ret_origins)
+{
+	struct completion_queue *cq = NULL;
+	TEEC_Completion completion;
+	TEEC_Result ret = TEEC_SUCCESS;
+	uint32_t submitted = 0;
+	uint32_t i = 0;
+	uint64_t prev_id = 0;
+
+	/* Commands not invoked complete as cancelled */
+	for (i = 0; i < num; i++) {
+		results[i] = TEEC_ERROR_CANCEL;
+		if (ret_origins)
+			ret_origins[i] = TEEC_ORIGIN_API;
+	}
+
+	/* A single thread invokes the commands in order, and cancels those
+	 * after the first which fails.
+	 */
+	ret = completion_queue_new(1, &cq);
+	if (ret != TEEC_SUCCESS)
+		return ret;
+
+	completion_queue_stop_on_error(cq);
+
+	/* The commands of a batch share the correlation ID of the batch */
+	prev_id = correlation_begin();
+
+	for (submitted = 0; submitted < num; submitted++) {
+		ret = completion_queue_submit(cq, session,
+					      command_ids[submitted],
+					      ops ? ops[submitted] : NULL,
+					      (void *)(uintptr_t)submitted,
+					      NULL);
+		if (ret != TEEC_SUCCESS) {
+			results[submitted] = ret;
+			break;
+		}
+	}
+
+	MinkCom_setCorrelationId(prev_id);
+
+	/* The commands queued before the one which could not be are not
+	 * invoked either.
+	 */
+	for (i = 0; ret != TEEC_SUCCESS && i < submitted; i++)
+		completion_queue_cancel(cq, ops ? ops[i] : NULL);
+
+	for (i = 0; i < submitted; i++) {
+		completion_queue_wait(cq, &completion, 1,
+				      MINK_TEEC_TIMEOUT_INFINITE);
+
+		results[(uintptr_t)completion.userData] = completion.result;
+		if (ret_origins)
+			ret_origins[(uintptr_t)completion.userData] =
+				completion.returnOrigin;
+	}
+
+	completion_queue_free(cq);
+
+	/* The first command which failed stopped the batch */
+	for (i = 0; i < num; i++) {
+		if (results[i] != TEEC_SUCCESS)
+			return results[i];
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/* A read-only input shared by the commands of a fan-out. */
+struct shared_input {
+	TEEC_Context *ctx;
+	void *buffer;
+	size_t size;
+	uint32_t uses;
+	bool active;
+	TEEC_SharedMemory shm;
+};
+
+/* The commands of a fan-out, and their completion. */
+struct multi_call {
+	uint32_t command_id;
+	uint32_t timeout;
+	/* CLOCK_MONOTONIC, unless timeout is infinite */
+	uint64_t deadline;
+	uint64_t correlation_id;
+	uint32_t pending;
+	/* Protect pending */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+/* A command of a fan-out, invoked by the worker pool. */
+struct multi_cmd {
+	struct work_item work;
+
+	struct multi_call *call;
+	TEEC_Session *session;
+	/* The client's operation, or none, bound before the command starts */
+	TEEC_Operation *op;
+	TEEC_Operation none;
+	/* The shared input each parameter was replaced with, if any */
+	struct shared_input *shared[MAX_NUM_PARAMS];
+	/* Protected by the lock of the call */
+	bool done;
+	bool signalled;
+	TEEC_Result result;
+	uint32_t origin;
+};
+
+static uint64_t monotonic_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Find the shared input of a temporary memory reference, or add it.
+ */
+static struct shared_input *find_shared_input(struct shared_input *shared,
+					      uint32_t *num_shared,
+					      TEEC_Context *ctx,
+					      TEEC_TempMemoryReference *tmpref)
+{
+	struct shared_input *in = NULL;
+
+	for (uint32_t i = 0; i < *num_shared; i++) {
+		in = &shared[i];
+		if (in->ctx == ctx && in->buffer == tmpref->buffer &&
+		    in->size == tmpref->size)
+			return in;
+	}
+
+	in = &shared[(*num_shared)++];
+	in->ctx = ctx;
+	in->buffer = tmpref->buffer;
+	in->size = tmpref->size;
+
+	return in;
+}
+
+/**
+ * @brief Share the memory of an input used by several commands with QTEE
+ * once, copied into allocated memory.
+ *
+ * Like other temporary memory references, the input is not shared in place,
+ * not to expose the client's memory next to it.
+ */
+static bool share_input(struct shared_input *in)
+{
+	TEEC_SharedMemory *shm = &in->shm;
+
+	memset(shm, 0, sizeof(*shm));
+	shm->size = in->size;
+	shm->flags = TEEC_MEM_INPUT;
+
+	if (allocate_shared_memory(in->ctx, shm))
+		return false;
+
+	memcpy(shm->buffer, in->buffer, in->size);
+
+	return true;
+}
+
+/**
+ * @brief Replace the large temporary input memory references which several
+ * commands of a fan-out share with a reference to memory shared once.
+ *
+ * @return The number of shared inputs, to release with unshare_inputs().
+ */
+static uint32_t share_inputs(struct multi_cmd *cmds, uint32_t num,
+			     struct shared_input *shared)
+{
+	struct shared_input *in = NULL;
+	TEEC_Parameter *param = NULL;
+	TEEC_Operation *op = NULL;
+	uint32_t num_shared = 0;
+	uint32_t type = TEEC_NONE;
+
+	for (uint32_t i = 0; i < num; i++) {
+		op = cmds[i].op;
+		for (size_t p = 0; p < MAX_NUM_PARAMS; p++) {
+			type = TEEC_PARAM_TYPE_GET(op->paramTypes, p);
+			param = &op->params[p];
+			if (type != TEEC_MEMREF_TEMP_INPUT ||
+			    param->tmpref.size <= TEEC_SHM_MAX_HEAP_SZ)
+				continue;
+
+			in = find_shared_input(shared, &num_shared,
+					       cmds[i].session->imp.ctx,
+					       &param->tmpref);
+			in->uses++;
+		}
+	}
+
+	/* Inputs used once are passed as usual */
+	for (uint32_t i = 0; i < num_shared; i++)
+		shared[i].active = shared[i].uses > 1 &&
+				   share_input(&shared[i]);
+
+	for (uint32_t i = 0; i < num; i++) {
+		op = cmds[i].op;
+		for (size_t p = 0; p < MAX_NUM_PARAMS; p++) {
+			type = TEEC_PARAM_TYPE_GET(op->paramTypes, p);
+			param = &op->params[p];
+			if (type != TEEC_MEMREF_TEMP_INPUT ||
+			    param->tmpref.size <= TEEC_SHM_MAX_HEAP_SZ)
+				continue;
+
+			in = find_shared_input(shared, &num_shared,
+					       cmds[i].session->imp.ctx,
+					       &param->tmpref);
+			if (!in->active)
+				continue;
+
+			memset(param, 0, sizeof(*param));
+			param->memref.parent = &in->shm;
+			param->memref.offset = 0;
+			param->memref.size = in->size;
+
+			op->paramTypes = TEEC_PARAM_TYPE_SET(
+				TEEC_MEMREF_PARTIAL_INPUT, p, op->paramTypes);
+			cmds[i].shared[p] = in;
+		}
+	}
+
+	return num_shared;
+}
+
+/**
+ * @brief Restore the temporary memory references replaced by
+ * share_inputs(), and release the shared memory.
+ */
+static void unshare_inputs(struct multi_cmd *cmds, uint32_t num,
+			   struct shared_input *shared, uint32_t num_shared)
+{
+	struct shared_input *in = NULL;
+	TEEC_Parameter *param = NULL;
+	TEEC_Operation *op = NULL;
+
+	for (uint32_t i = 0; i < num; i++) {
+		op = cmds[i].op;
+		for (size_t p = 0; p < MAX_NUM_PARAMS; p++) {
+			in = cmds[i].shared[p];
+			if (!in)
+				continue;
+
+			param = &op->params[p];
+			memset(param, 0, sizeof(*param));
+			param->tmpref.buffer = in->buffer;
+			param->tmpref.size = in->size;
+
+			op->paramTypes = TEEC_PARAM_TYPE_SET(
+				TEEC_MEMREF_TEMP_INPUT, p, op->paramTypes);
+			cmds[i].shared[p] = NULL;
+		}
+	}
+
+	for (uint32_t i = 0; i < num_shared; i++)
+		if (shared[i].active)
+			release_shared_memory(&shared[i].shm);
+}
+
+/**
+ * @brief Invoke a command of a fan-out, unless the deadline of the fan-out
+ * has passed.
+ */
+static void run_multi_cmd(struct multi_cmd *cmd)
+{
+	struct multi_call *call = cmd->call;
+	uint32_t timeout = call->timeout;
+	uint64_t now = 0;
+
+	if (timeout != MINK_TEEC_TIMEOUT_INFINITE) {
+		now = monotonic_ns();
+		if (now >= call->deadline) {
+			cmd->result = TEEC_ERROR_CANCEL;
+			cmd->origin = TEEC_ORIGIN_API;
+			return;
+		}
+
+		/* Rounded up, not to cancel the command early */
+		timeout = (uint32_t)((call->deadline - now + 999999) /
+				     1000000);
+	}
+
+	cmd->result = invoke_operation(cmd->session, call->command_id, cmd->op,
+				       timeout, &cmd->origin);
+}
+
+static void multi_cmd_work(struct work_item *item)
+{
+	struct multi_cmd *cmd = (struct multi_cmd *)item;
+	struct multi_call *call = cmd->call;
+
+	/* Invoke the command on behalf of the client request */
+	MinkCom_setCorrelationId(call->correlation_id);
+	run_multi_cmd(cmd);
+	MinkCom_setCorrelationId(0);
+
+	pthread_mutex_lock(&call->lock);
+	cmd->done = true;
+	if (!--call->pending)
+		pthread_cond_signal(&call->cond);
+	pthread_mutex_unlock(&call->lock);
+}
+
+/**
+ * @brief Wait for the commands of a fan-out until its deadline, then cancel
+ * those still outstanding.
+ *
+ * Commands no thread has picked up complete without being invoked, and those
+ * in flight are cancelled as by TEEC_RequestCancellation.
+ */
+static void cancel_multi_at_deadline(struct multi_call *call,
+				     struct multi_cmd *cmds, uint32_t num)
+{
+	struct timespec deadline;
+	bool expired = false;
+
+	deadline.tv_sec = (time_t)(call->deadline / 1000000000ULL);
+	deadline.tv_nsec = (long)(call->deadline % 1000000000ULL);
+
+	pthread_mutex_lock(&call->lock);
+	while (call->pending && !expired)
+		expired = pthread_cond_timedwait(&call->cond, &call->lock,
+						 &deadline) == ETIMEDOUT;
+	pthread_mutex_unlock(&call->lock);
+
+	if (!expired)
+		return;
+
+	for (uint32_t i = 0; i < num; i++) {
+		/* Completed with TEEC_ERROR_CANCEL, the deadline being past */
+		if (worker_pool_reclaim(&cmds[i].work)) {
+			multi_cmd_work(&cmds[i].work);
+			continue;
+		}
+
+		pthread_mutex_lock(&call->lock);
+		if (!cmds[i].done) {
+			request_cancellation(cmds[i].op);
+			cmds[i].signalled = true;
+		}
+		pthread_mutex_unlock(&call->lock);
+	}
+}
+
+TEEC_Result invoke_command_multi(TEEC_Session **sessions, uint32_t num,
+				 uint32_t command_id, TEEC_Operation **ops,
+				 uint32_t timeout, TEEC_Result *results,
+				 uint32_t *ret_origins)
+{
+	TEEC_Result result = TEEC_SUCCESS;
+	struct shared_input *shared = NULL;
+	struct multi_cmd *cmds = NULL;
+	struct multi_call call;
+	pthread_condattr_t attr;
+	TEEC_Context *ctx = NULL;
+	QList items;
+	uint32_t num_shared = 0;
+	uint32_t first = 0;
+	uint64_t prev_id = 0;
+
+	cmds = calloc(num, sizeof(*cmds));
+	if (!cmds)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	for (uint32_t i = 0; i < num; i++) {
+		cmds[i].work.fn = multi_cmd_work;
+		cmds[i].session = sessions[i];
+		cmds[i].op = ops && ops[i] ? ops[i] : &cmds[i].none;
+		QNode_construct(&cmds[i].work.qn);
+	}
+
+	if (ops) {
+		shared = calloc((size_t)num * MAX_NUM_PARAMS, sizeof(*shared));
+		if (!shared) {
+			free(cmds);
+			return TEEC_ERROR_OUT_OF_MEMORY;
+		}
+
+		num_shared = share_inputs(cmds, num, shared);
+	}
+
+	/* The commands of a fan-out share the correlation ID of the fan-out */
+	prev_id = correlation_begin();
+
+	call.command_id = command_id;
+	call.timeout = timeout;
+	call.deadline = monotonic_ns() + (uint64_t)timeout * 1000000ULL;
+	call.correlation_id = MinkCom_getCorrelationId();
+	pthread_mutex_init(&call.lock, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&call.cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	/* Bound up front, so that they can be cancelled wherever they run */
+	for (uint32_t i = 0; i < num; i++) {
+		cmds[i].call = &call;
+		bind_operation(sessions[i]->imp.ctx, sessions[i], cmds[i].op,
+			       NULL);
+	}
+
+	/* Without a deadline to keep, the calling thread invokes the first
+	 * command itself
+	 */
+	if (timeout == MINK_TEEC_TIMEOUT_INFINITE)
+		first = 1;
+
+	QList_construct(&items);
+	for (uint32_t i = first; i < num; i++)
+		QList_appendNode(&items, &cmds[i].work.qn);
+
+	call.pending = num - first;
+	if (call.pending)
+		worker_pool_submit(&items, call.pending);
+
+	if (first) {
+		run_multi_cmd(&cmds[0]);
+
+		/* Then those no thread has picked up yet */
+		for (uint32_t i = 1; i < num; i++) {
+			if (worker_pool_reclaim(&cmds[i].work))
+				multi_cmd_work(&cmds[i].work);
+		}
+	} else {
+		cancel_multi_at_deadline(&call, cmds, num);
+	}
+
+	/* A Trusted Application ignoring the cancellation still holds the
+	 * operation of its command
+	 */
+	pthread_mutex_lock(&call.lock);
+	while (call.pending)
+		pthread_cond_wait(&call.cond, &call.lock);
+	pthread_mutex_unlock(&call.lock);
+
+	pthread_cond_destroy(&call.cond);
+	pthread_mutex_destroy(&call.lock);
+
+	MinkCom_setCorrelationId(prev_id);
+
+	/* Those which completed before seeing it leave it behind */
+	for (uint32_t i = 0; i < num; i++) {
+		if (!cmds[i].signalled)
+			continue;
+
+		ctx = sessions[i]->imp.ctx;
+		CWait_clear(ctx->imp.waiter_cbo, cmds[i].op->imp.cancel_code);
+	}
+
+	if (ops)
+		unshare_inputs(cmds, num, shared, num_shared);
+
+	for (uint32_t i = 0; i < num; i++) {
+		results[i] = cmds[i].result;
+		if (ret_origins)
+			ret_origins[i] = cmds[i].origin;
+
+		if (!result)
+			result = cmds[i].result;
+	}
+
+	free(shared);
+	free(cmds);
+
+	return result;
+}
+
+TEEC_Result invoke_operation(TEEC_Session *session, uint32_t command_id,
+			     TEEC_Operation *op, uint32_t timeout,
+			     uint32_t *ret_origin)
+{
+	TEEC_Result ret = TEEC_SUCCESS;
+
+	TEEC_Result result = TEEC_SUCCESS;
+	uint32_t eorigin = TEEC_ORIGIN_COMMS;
+	uint32_t cancel_code = 0;
+
+	TEEC_Context *ctx = session->imp.ctx;
+	struct invoke_sample sample;
 
 	if (ret_origin) {
 		*ret_origin = TEEC_ORIGIN_COMMS;
@@ -1084,52 +2226,416 @@ TEEC_Result invoke_command(TEEC_Session *session, uint32_t command_id,
 	MINK_Parameter m_params[MAX_NUM_PARAMS];
 	mink_params_INIT(m_params);
 
+	uint64_t prev_id = correlation_begin();
+
+	PROBE(invoke_command_entry, session, command_id,
+	      MinkCom_getCorrelationId());
+
+	if (session->imp.stats)
+		invoke_stats_begin(&sample, op);
+
 	if (op) {
-		cancel_code = (rand() & CANCEL_CODE_MASK);
-		op->imp.cancel_code = cancel_code;
-		op->imp.session = session;
+		cancel_code = op->imp.cancel_code;
 
 		memref_temp_to_partial_params(ctx, &(op->paramTypes),
 					      op->params);
 
 		mink_params_from_teec_params(op->paramTypes, op->params,
-					     m_params, &tee_exParamTypes);
+					     m_params, NULL,
+					     &tee_exParamTypes);
 
 		tee_types_from_teec_types(op, &tee_paramTypes);
 	}
 
-	ret = mink_invoke_command(session->imp.session_obj, command_id,
-				  cancel_code, tee_paramTypes, tee_exParamTypes,
-				  m_params, &result, &eorigin);
+	/* A command without an operation needs a cancel code to time out or
+	 * to be cancelled with its session
+	 */
+	if (!cancel_code)
+		cancel_code = new_cancel_code();
+
+	ret = invoke_cancellable(session, command_id, op, cancel_code,
+				 timeout, tee_paramTypes, tee_exParamTypes,
+				 m_params, &result, &eorigin);
 
 	if (ret)
-		MSGE("mink_invoke_command() failed: %d\n", ret);
+		MSGE("mink_invoke_command() failed: %d, request 0x%" PRIx64 "\n",
+		     ret, MinkCom_getCorrelationId());
+
+	/* Do not pool a session which failed outside the TA */
+	if (result && eorigin != TEEC_ORIGIN_TRUSTED_APP &&
+	    eorigin != TEEC_ORIGIN_API)
+		session->imp.broken = TRUE;
 
 	if (ret_origin)
 		*ret_origin = eorigin;
 
 	if (op) {
-		update_shm_memref_from_mem_obj(op->paramTypes, op->params);
+		update_shm_memref_from_mem_obj(op->paramTypes, op->params,
+					       m_params);
 
 		memref_temp_from_partial_params(&(op->paramTypes), op->params);
 	}
 
+	if (session->imp.stats)
+		invoke_stats_end(session->imp.stats, &sample, command_id, op,
+				 result);
+
+	PROBE(invoke_command_exit, session, command_id, result, eorigin,
+	      MinkCom_getCorrelationId());
+
+	MinkCom_setCorrelationId(prev_id);
+
 	return result;
 }
 
-TEEC_Result register_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm,
-				   uint8_t convert)
+/**
+ * @brief Refresh the parameters of a prepared operation from the client's
+ * operation.
+ *
+ * Values, and the offsets and sizes of memory references, may change between
+ * invocations. The parameter types, Shared Memory and temporary buffers may
+ * not, and temporary memory references may not grow past the size they were
+ * prepared with.
+ *
+ * @param prep The prepared operation.
+ * @return TEEC_SUCCESS on success.
+ *         TEEC_ERROR_BAD_PARAMETERS if the operation no longer matches.
+ */
+static TEEC_Result prepared_params_refresh(struct prepared_op *prep)
+{
+	TEEC_Parameter *params = prep->op->params;
+	TEEC_SharedMemory *shm;
+	uint32_t type = TEEC_NONE;
+
+	if (prep->op->paramTypes != prep->param_types)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+
+		type = TEEC_PARAM_TYPE_GET(prep->param_types, i);
+		switch(type) {
+		case TEEC_VALUE_INPUT:
+		case TEEC_VALUE_OUTPUT:
+		case TEEC_VALUE_INOUT:
+
+			prep->params[i].value = params[i].value;
+			break;
+		case TEEC_MEMREF_TEMP_INPUT:
+		case TEEC_MEMREF_TEMP_OUTPUT:
+		case TEEC_MEMREF_TEMP_INOUT:
+
+			/* Passed inline, as long as it stays small */
+			if (TEEC_PARAM_TYPE_GET(prep->conv_types, i) == type) {
+				if (params[i].tmpref.size > TEEC_SHM_MAX_HEAP_SZ)
+					return TEEC_ERROR_BAD_PARAMETERS;
+
+				prep->params[i].tmpref = params[i].tmpref;
+				break;
+			}
+
+			shm = prep->params[i].memref.parent;
+			if (params[i].tmpref.buffer != shm->buffer ||
+			    params[i].tmpref.size > shm->size)
+				return TEEC_ERROR_BAD_PARAMETERS;
+
+			prep->params[i].memref.size = params[i].tmpref.size;
+			break;
+		case TEEC_MEMREF_PARTIAL_INPUT:
+		case TEEC_MEMREF_PARTIAL_OUTPUT:
+		case TEEC_MEMREF_PARTIAL_INOUT:
+		case TEEC_MEMREF_WHOLE:
+
+			shm = params[i].memref.parent;
+			if (shm != prep->params[i].memref.parent)
+				return TEEC_ERROR_BAD_PARAMETERS;
+
+			if (type != TEEC_MEMREF_WHOLE &&
+			    (params[i].memref.offset > shm->size ||
+			     params[i].memref.size >
+				     shm->size - params[i].memref.offset))
+				return TEEC_ERROR_BAD_PARAMETERS;
+
+			prep->params[i].memref = params[i].memref;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Return the output values and sizes of a prepared operation to the
+ * client's operation.
+ *
+ * @param prep The prepared operation.
+ */
+static void prepared_params_update(struct prepared_op *prep)
+{
+	TEEC_Parameter *params = prep->op->params;
+	uint32_t type = TEEC_NONE;
+
+	for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+
+		type = TEEC_PARAM_TYPE_GET(prep->conv_types, i);
+		switch(type) {
+		case TEEC_VALUE_OUTPUT:
+		case TEEC_VALUE_INOUT:
+
+			params[i].value = prep->params[i].value;
+			break;
+		case TEEC_MEMREF_TEMP_OUTPUT:
+		case TEEC_MEMREF_TEMP_INOUT:
+
+			params[i].tmpref.size = prep->params[i].tmpref.size;
+			break;
+		case TEEC_MEMREF_PARTIAL_INPUT:
+		case TEEC_MEMREF_PARTIAL_OUTPUT:
+		case TEEC_MEMREF_PARTIAL_INOUT:
+
+			/* A converted temporary memory reference */
+			if (prep->params[i].memref.parent->imp.converted) {
+				params[i].tmpref.size =
+					prep->params[i].memref.size;
+				break;
+			}
+
+			/* fallthrough */
+		case TEEC_MEMREF_WHOLE:
+
+			params[i].memref.size = prep->params[i].memref.size;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+TEEC_Result prepare_operation(TEEC_Session *session, TEEC_Operation *op,
+			      struct prepared_op **prepared)
+{
+	TEEC_Result result = TEEC_SUCCESS;
+	TEEC_Context *ctx = session->imp.ctx;
+	TEEC_Operation conv_op = { 0 };
+	struct prepared_op *prep;
+	uint32_t type = TEEC_NONE;
+	Object mem_obj;
+
+	prep = calloc(1, sizeof(*prep));
+	if (!prep)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	prep->session = session;
+	prep->op = op;
+	prep->param_types = op->paramTypes;
+	prep->conv_types = op->paramTypes;
+	memcpy(prep->params, op->params, sizeof(prep->params));
+
+	/* Large temporary memory references keep their memory object until
+	 * the prepared operation is released.
+	 */
+	result = memref_temp_to_partial_params(ctx, &prep->conv_types,
+					       prep->params);
+	if (result) {
+		free(prep);
+		return result;
+	}
+
+	/* Which memory references share a memory object does not change */
+	for (size_t i = 0; i < MAX_NUM_PARAMS; i++) {
+
+		type = TEEC_PARAM_TYPE_GET(prep->conv_types, i);
+		switch(type) {
+		case TEEC_MEMREF_PARTIAL_INPUT:
+		case TEEC_MEMREF_PARTIAL_OUTPUT:
+		case TEEC_MEMREF_PARTIAL_INOUT:
+		case TEEC_MEMREF_WHOLE:
+
+			mem_obj = prep->params[i].memref.parent->imp.mem_obj;
+			if (!Object_isNull(mem_obj))
+				prep->shm_obj_index[i] =
+					get_shared_mem_obj_index(i, mem_obj,
+								 prep->conv_types,
+								 prep->params);
+			break;
+		default:
+			break;
+		}
+	}
+
+	conv_op.paramTypes = prep->conv_types;
+	memcpy(conv_op.params, prep->params, sizeof(conv_op.params));
+	tee_types_from_teec_types(&conv_op, &prep->tee_paramTypes);
+
+	*prepared = prep;
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result invoke_prepared(struct prepared_op *prep, uint32_t command_id,
+			    uint32_t *ret_origin)
+{
+	TEEC_Result ret = TEEC_SUCCESS;
+
+	TEEC_Result result = TEEC_SUCCESS;
+	uint32_t eorigin = TEEC_ORIGIN_COMMS;
+	uint32_t cancel_code = 0;
+
+	TEEC_Session *session = prep->session;
+	TEEC_Operation *op = prep->op;
+	struct invoke_sample sample;
+
+	if (session->imp.stats)
+		invoke_stats_begin(&sample, op);
+
+	result = prepared_params_refresh(prep);
+	if (result)
+		return result;
+
+	if (ret_origin) {
+		*ret_origin = TEEC_ORIGIN_COMMS;
+	}
+
+	uint32_t tee_exParamTypes = 0;
+	MINK_Parameter m_params[MAX_NUM_PARAMS];
+	mink_params_INIT(m_params);
+
+	uint64_t prev_id = correlation_begin();
+
+	PROBE(invoke_command_entry, session, command_id,
+	      MinkCom_getCorrelationId());
+
+	bind_operation(session->imp.ctx, session, op, NULL);
+	cancel_code = op->imp.cancel_code;
+
+	mink_params_from_teec_params(prep->conv_types, prep->params, m_params,
+				     prep->shm_obj_index, &tee_exParamTypes);
+
+	ret = invoke_cancellable(session, command_id, op, cancel_code,
+				 session->imp.ctx->imp.invoke_timeout,
+				 prep->tee_paramTypes, tee_exParamTypes,
+				 m_params, &result, &eorigin);
+
+	if (ret)
+		MSGE("mink_invoke_command() failed: %d, request 0x%" PRIx64 "\n",
+		     ret, MinkCom_getCorrelationId());
+
+	/* Do not pool a session which failed outside the TA */
+	if (result && eorigin != TEEC_ORIGIN_TRUSTED_APP &&
+	    eorigin != TEEC_ORIGIN_API)
+		session->imp.broken = TRUE;
+
+	if (ret_origin)
+		*ret_origin = eorigin;
+
+	update_shm_memref_from_mem_obj(prep->conv_types, prep->params,
+				       m_params);
+
+	prepared_params_update(prep);
+
+	if (session->imp.stats)
+		invoke_stats_end(session->imp.stats, &sample, command_id, op,
+				 result);
+
+	PROBE(invoke_command_exit, session, command_id, result, eorigin,
+	      MinkCom_getCorrelationId());
+
+	MinkCom_setCorrelationId(prev_id);
+
+	return result;
+}
+
+void release_prepared(struct prepared_op *prep)
+{
+	memref_temp_from_partial_params(&prep->conv_types, prep->params);
+	free(prep);
+}
+
+/**
+ * @brief Share the pages of a Shared Memory with QTEE in place.
+ *
+ * The memory object covers the pages holding shm->buffer, which starts at
+ * shm->imp.offset in it. QTEE has access to the whole pages, so the client's
+ * memory is only shared if it spans whole pages, not to expose the data next
+ * to it.
+ *
+ * @param root_obj The root object of the TEE context.
+ * @param shm The Shared Memory to register.
+ * @param owned Whether the library allocated the pages holding shm->buffer.
+ * @param mo The memory object backed by shm->buffer.
+ * @return Object_OK on success.
+ *         Object_ERROR_* on failure.
+ */
+static int32_t register_in_place(Object root_obj, TEEC_SharedMemory *shm,
+				 bool owned, Object *mo)
+{
+	uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+	uintptr_t start = (uintptr_t)shm->buffer & ~(page - 1);
+	uintptr_t end = ((uintptr_t)shm->buffer + shm->size + page - 1) &
+			~(page - 1);
+	int32_t rv = Object_OK;
+
+	if (!owned && (((uintptr_t)shm->buffer | shm->size) & (page - 1)))
+		return Object_ERROR_INVALID;
+
+	if (!atomic_load_explicit(&register_in_place_supported,
+				  memory_order_relaxed))
+		return Object_ERROR_UNAVAIL;
+
+	rv = MinkCom_registerMemoryObject(root_obj, (void *)start, end - start,
+					  mo);
+	if (rv == Object_ERROR_UNAVAIL)
+		atomic_store_explicit(&register_in_place_supported, false,
+				      memory_order_relaxed);
+	if (rv)
+		return rv;
+
+	invoke_stats_count_mem_obj();
+
+	shm->imp.offset = (uintptr_t)shm->buffer - start;
+
+	return Object_OK;
+}
+
+/**
+ * @brief Register a shared memory with QTEE, as register_shared_memory().
+ *
+ * @param owned Whether the library allocated the pages holding shm->buffer,
+ *              which can then be shared in place whatever their alignment.
+ */
+static TEEC_Result register_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm,
+				   uint8_t convert, bool owned)
 {
 	int32_t rv = Object_OK;
 	Object root_obj = ctx->imp.root_obj;
 	Object mo = Object_NULL;
 
-	/* Based on size, we might need to use a MINK Memory Object */
+	shm->imp.in_place = FALSE;
+	shm->imp.offset = 0;
+
+	/* Based on size, we might need to use a MINK Memory Object. Share the
+	 * client's pages if we can, otherwise the buffer is copied to and from
+	 * a separate memory object on every invocation. Temporary memory
+	 * references, often on the stack, are never shared in place: they
+	 * borrow that memory object from the context's pool.
+	 */
 	if (shm->size > TEEC_SHM_MAX_HEAP_SZ) {
 
-		rv = MinkCom_getMemoryObject(root_obj, shm->size, &mo);
-		if (Object_isERROR(rv))
-			return TEEC_ERROR_GENERIC;
+		if (!convert && !register_in_place(root_obj, shm, owned, &mo)) {
+			shm->imp.in_place = TRUE;
+		} else if (convert) {
+			rv = bounce_pool_get(ctx->imp.bounce_pool, root_obj,
+					     shm->size, &mo);
+			if (Object_isERROR(rv))
+				return TEEC_ERROR_GENERIC;
+		} else {
+			rv = MinkCom_getMemoryObject(root_obj, shm->size, &mo);
+			if (Object_isERROR(rv))
+				return TEEC_ERROR_GENERIC;
+
+			invoke_stats_count_mem_obj();
+		}
 	}
 
 	/* This shared memory is a Registered Memory */
@@ -1140,6 +2646,150 @@ TEEC_Result register_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm,
 
 	shm->imp.mem_obj = mo;
 	shm->imp.ctx = ctx;
+	shm->imp.fd = -1;
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result register_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm,
+				   uint8_t convert)
+{
+	return register_memory(ctx, shm, convert, false);
+}
+
+/**
+ * @brief Map a memfd and register its memory with QTEE as client memory.
+ *
+ * @param ctx The initialized TEE context over which to register the memory.
+ * @param shm The Shared Memory, whose size is the size to map.
+ * @param fd The memfd. The Shared Memory takes it over on success.
+ * @return TEEC_SUCCESS If the memory was registered successfully.
+ *	   TEEC_ERROR_* otherwise.
+ */
+static TEEC_Result register_memfd(TEEC_Context *ctx, TEEC_SharedMemory *shm,
+				  int fd)
+{
+	TEEC_Result ret = TEEC_SUCCESS;
+	void *buffer = NULL;
+
+	buffer = mmap(NULL, shm->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+		      0);
+	if (buffer == MAP_FAILED) {
+		MSGE("mmap failed: %s\n", strerror(errno));
+		return TEEC_ERROR_OUT_OF_MEMORY;
+	}
+
+	shm->buffer = buffer;
+
+	/* The pages are shared in place unless QCOMTEE cannot register them,
+	 * or the memory is small enough to be copied on every invocation.
+	 * They are whole pages of the memfd, so nothing else is shared.
+	 */
+	ret = register_memory(ctx, shm, FALSE, true);
+	if (ret) {
+		munmap(buffer, shm->size);
+		shm->buffer = NULL;
+		return ret;
+	}
+
+	shm->imp.fd = fd;
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Allocate a memory shared with QTEE from a sealed memfd, which other
+ * processes can import.
+ */
+static TEEC_Result allocate_shareable_memory(TEEC_Context *ctx,
+					     TEEC_SharedMemory *shm)
+{
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	TEEC_Result ret = TEEC_SUCCESS;
+	int fd = -1;
+
+	if (!shm->size)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	fd = memfd_create("minkteec-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	if (fd < 0) {
+		MSGE("memfd_create failed: %s\n", strerror(errno));
+		return TEEC_ERROR_GENERIC;
+	}
+
+	/* Fix the size for good, so that the mappings of the processes which
+	 * import the memory can never lose their pages.
+	 */
+	if (ftruncate(fd, (off_t)((shm->size + page - 1) & ~(page - 1))) ||
+	    fcntl(fd, F_ADD_SEALS,
+		  F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)) {
+		MSGE("Sizing the memfd failed: %s\n", strerror(errno));
+		ret = TEEC_ERROR_OUT_OF_MEMORY;
+		goto err_close;
+	}
+
+	ret = register_memfd(ctx, shm, fd);
+	if (ret)
+		goto err_close;
+
+	return TEEC_SUCCESS;
+
+err_close:
+	close(fd);
+
+	return ret;
+}
+
+TEEC_Result import_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm,
+				 int fd)
+{
+	TEEC_Result ret = TEEC_SUCCESS;
+	struct stat st = { 0 };
+	size_t size = shm->size;
+	int seals = 0;
+	int imp_fd = -1;
+
+	/* A file which can shrink may take the pages from under QTEE */
+	seals = fcntl(fd, F_GET_SEALS);
+	if (seals < 0 || !(seals & F_SEAL_SHRINK) || fstat(fd, &st)) {
+		MSGE("Importing memory not sealed against shrinking\n");
+		return TEEC_ERROR_BAD_PARAMETERS;
+	}
+
+	if (!size)
+		size = (size_t)st.st_size;
+
+	if (!size || size > (size_t)st.st_size)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (size > TEEC_CONFIG_SHAREDMEM_MAX_SIZE)
+		return TEEC_ERROR_OUT_OF_MEMORY;
+
+	imp_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+	if (imp_fd < 0) {
+		MSGE("fcntl failed: %s\n", strerror(errno));
+		return TEEC_ERROR_GENERIC;
+	}
+
+	shm->size = size;
+
+	ret = register_memfd(ctx, shm, imp_fd);
+	if (ret)
+		close(imp_fd);
+
+	return ret;
+}
+
+TEEC_Result export_shared_memory(TEEC_SharedMemory *shm, int *fd)
+{
+	if (shm->imp.type != TEEC_MEMORY_REGISTERED || shm->imp.fd < 0)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	*fd = fcntl(shm->imp.fd, F_DUPFD_CLOEXEC, 0);
+	if (*fd < 0) {
+		MSGE("fcntl failed: %s\n", strerror(errno));
+		return TEEC_ERROR_GENERIC;
+	}
 
 	return TEEC_SUCCESS;
 }
@@ -1152,6 +2802,9 @@ TEEC_Result allocate_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm)
 	/* mo is page aligned, thus mo_size > shm->size when used */
 	size_t mo_size;
 
+	if (shm->flags & TEEC_MEM_SHAREABLE)
+		return allocate_shareable_memory(ctx, shm);
+
 	if (shm->size > TEEC_SHM_MAX_HEAP_SZ) {
 
 		/* Larger memory sizes need to be backed by a
@@ -1161,12 +2814,21 @@ TEEC_Result allocate_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm)
 		if (Object_isERROR(rv))
 			return TEEC_ERROR_GENERIC;
 
+		invoke_stats_count_mem_obj();
+
 		rv = MinkCom_getMemoryObjectInfo(mo, &shm->buffer, &mo_size);
 		if (Object_isERROR(rv)) {
 			Object_ASSIGN_NULL(mo);
 			return TEEC_ERROR_GENERIC;
 		}
-	} else {
+	} else if (!ctx->imp.shm_cache ||
+		   shm_cache_get(ctx->imp.shm_cache, root_obj, shm->size, &mo,
+				 &shm->buffer)) {
+
+		/* Smaller memory sizes get a memory object of their own from
+		 * the cache of the context, or are copied on each invocation
+		 * if that fails.
+		 */
 		shm->buffer = malloc(shm->size);
 		if (!shm->buffer)
 			return TEEC_ERROR_OUT_OF_MEMORY;
@@ -1174,8 +2836,11 @@ TEEC_Result allocate_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm)
 
 	/* This shared memory is a Registered Memory */
 	shm->imp.type = TEEC_MEMORY_ALLOCATED;
+	shm->imp.in_place = FALSE;
+	shm->imp.offset = 0;
 	shm->imp.mem_obj = mo;
 	shm->imp.ctx = ctx;
+	shm->imp.fd = -1;
 
 	return TEEC_SUCCESS;
 }
@@ -1183,8 +2848,15 @@ TEEC_Result allocate_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm)
 void release_shared_memory(TEEC_SharedMemory *shm)
 {
 	if (shm->imp.type == TEEC_MEMORY_ALLOCATED) {
-		if(shm->size <= TEEC_SHM_MAX_HEAP_SZ)
-			free(shm->buffer);
+		if (shm->size <= TEEC_SHM_MAX_HEAP_SZ) {
+			if (Object_isNull(shm->imp.mem_obj))
+				free(shm->buffer);
+			else
+				shm_cache_put(shm->imp.ctx->imp.shm_cache,
+					      shm->imp.mem_obj);
+
+			shm->imp.mem_obj = Object_NULL;
+		}
 
 		shm->buffer = NULL;
 		shm->size = 0;
@@ -1193,16 +2865,52 @@ void release_shared_memory(TEEC_SharedMemory *shm)
 	/* If there's a backing memory object, release it */
 	Object_ASSIGN_NULL(shm->imp.mem_obj);
 
+	/* Shareable memory is the library's own mapping of its memfd */
+	if (shm->imp.type == TEEC_MEMORY_REGISTERED && shm->imp.fd >= 0) {
+		munmap(shm->buffer, shm->size);
+		close(shm->imp.fd);
+
+		shm->buffer = NULL;
+		shm->size = 0;
+	}
+
+	shm->imp.fd = -1;
 	shm->imp.converted = 0;
+	shm->imp.in_place = FALSE;
+	shm->imp.offset = 0;
 	shm->imp.type = TEEC_MEMORY_FREE;
 	shm->imp.ctx = NULL;
 }
 
+void cancel_session(TEEC_Session *session)
+{
+	TEEC_Context *ctx = session->imp.ctx;
+
+	/* Operations bound to the session and not yet invoked see this */
+	__atomic_add_fetch(&session->imp.cancel_gen, 1, __ATOMIC_SEQ_CST);
+
+	if (ctx->imp.inflight)
+		inflight_cancel(ctx->imp.inflight, session);
+}
+
+void cancel_context(TEEC_Context *ctx)
+{
+	/* Operations bound to the context and not yet invoked see this */
+	__atomic_add_fetch(&ctx->imp.cancel_gen, 1, __ATOMIC_SEQ_CST);
+
+	if (ctx->imp.inflight)
+		inflight_cancel(ctx->imp.inflight, NULL);
+}
+
 void request_cancellation(TEEC_Operation *op)
 {
 	TEEC_Session *session = (TEEC_Session *)op->imp.session;
 	TEEC_Context *ctx = (TEEC_Context *)session->imp.ctx;
 
+	/* A command still queued is completed without being invoked */
+	if (op->imp.cq && completion_queue_cancel(op->imp.cq, op))
+		return;
+
 	Object waiter_cbo = ctx->imp.waiter_cbo;
 	if (Object_isNull(waiter_cbo)) {
 		MSGE("Waiter CBO not available!\n");
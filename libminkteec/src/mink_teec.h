@@ -4,9 +4,11 @@
 #ifndef __MINK_TEEC_H_
 #define __MINK_TEEC_H_
 
+#include <stdbool.h>
 #include <stdio.h>
 
 #include "tee_client_api.h"
+#include "tee_client_api_ext.h"
 #include "IGPSession.h"
 
 #define MSGV printf
@@ -69,6 +71,80 @@ typedef struct {
 	MemoryObjectParams mem_obj_params;
 } MINK_Parameter;
 
+/**
+ * @brief prepared_op.
+ *
+ * An operation validated and converted once, to be invoked many times.
+ */
+struct prepared_op {
+	TEEC_Session *session;
+	TEEC_Operation *op;
+	/* The parameter types given by the client */
+	uint32_t param_types;
+	/* The parameter types with large temporary memory references
+	 * converted to partial memory references
+	 */
+	uint32_t conv_types;
+	uint32_t tee_paramTypes;
+	/* Index of the parameter hosting the memory object of each memory
+	 * reference
+	 */
+	size_t shm_obj_index[MAX_NUM_PARAMS];
+	TEEC_Parameter params[MAX_NUM_PARAMS];
+};
+
+/**
+ * @brief Get a cancel code for an operation.
+ *
+ * Cancel codes are unique until 2^31 of them have been handed out.
+ *
+ * @return A non-zero cancel code.
+ */
+uint32_t new_cancel_code(void);
+
+/**
+ * @brief Bind an operation to the session it is invoked in, so that it can be
+ * cancelled.
+ *
+ * @param ctx The TEE context of the session.
+ * @param session The session.
+ * @param op The operation.
+ * @param cq The completion queue the operation is submitted to, or NULL.
+ */
+void bind_operation(TEEC_Context *ctx, TEEC_Session *session,
+		    TEEC_Operation *op, struct completion_queue *cq);
+
+struct context_conn;
+
+/**
+ * @brief Open a connection to QTEE: the MINK root object, the GP AppClient
+ * object and the CWait object for cancellations.
+ *
+ * @param conn The connection to open.
+ * @return TEEC_SUCCESS if the connection was opened.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result open_connection(struct context_conn *conn);
+
+/**
+ * @brief Close a connection opened with open_connection().
+ *
+ * @param conn The connection to close.
+ */
+void close_connection(struct context_conn *conn);
+
+/**
+ * @brief Check that QTEE still answers through a connection.
+ *
+ * Registers as a client with the root object of the connection, the first
+ * of the round trips of open_connection().
+ *
+ * @param conn The connection to check.
+ * @return true if QTEE answered.
+ *         false if the connection is to be closed.
+ */
+bool connection_healthy(const struct context_conn *conn);
+
 /**
  * @brief Initializes a new TEE Context over MINK IPC, forming a connection
  * between the Client Application and QTEE.
@@ -87,6 +163,75 @@ TEEC_Result initialize_context(TEEC_Context *ctx);
  */
 void finalize_context(TEEC_Context *ctx);
 
+/**
+ * @brief Configure the session pool of a TEE Context.
+ *
+ * @param ctx The initialized TEE context.
+ * @param config The configuration of the pool, or NULL to disable it.
+ * @return TEEC_SUCCESS if the pool was configured.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result configure_session_pool(TEEC_Context *ctx,
+				   const TEEC_SessionPoolConfig *config);
+
+/**
+ * @brief Configure the session recovery of a TEE Context.
+ *
+ * @param ctx The initialized TEE context.
+ * @param config The configuration of the recovery, or NULL to disable it.
+ * @return TEEC_SUCCESS if the recovery was configured.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result
+configure_session_recovery(TEEC_Context *ctx,
+			   const TEEC_SessionRecoveryConfig *config);
+
+/**
+ * @brief Configure the counters of the sessions of a TEE Context.
+ *
+ * @param ctx The initialized TEE context.
+ * @param config The configuration of the counters, or NULL to disable them.
+ */
+void configure_statistics(TEEC_Context *ctx,
+			  const TEEC_StatisticsConfig *config);
+
+/**
+ * @brief Get the counters of the commands of a session.
+ *
+ * @param session The open session.
+ * @param stats The counters of up to *num commands.
+ * @param num The number of entries in stats, set to the number of commands.
+ * @return TEEC_SUCCESS if every command was returned.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result get_statistics(TEEC_Session *session,
+			   TEEC_CommandStatistics *stats, uint32_t *num);
+
+/**
+ * @brief Get the session pool statistics of a TEE Context.
+ *
+ * @param ctx The initialized TEE context.
+ * @param stats The statistics, all zero if the pool is disabled.
+ */
+void get_session_pool_stats(TEEC_Context *ctx, TEEC_SessionPoolStats *stats);
+
+/**
+ * @brief Get the bounce buffer statistics of a TEE Context.
+ *
+ * @param ctx The initialized TEE context.
+ * @param stats The statistics, all zero if the context has no bounce pool.
+ */
+void get_bounce_buffer_stats(TEEC_Context *ctx, TEEC_BounceBufferStats *stats);
+
+/**
+ * @brief Get the session recovery statistics of a TEE Context.
+ *
+ * @param ctx The initialized TEE context.
+ * @param stats The statistics, all zero if recovery is disabled.
+ */
+void get_session_recovery_stats(TEEC_Context *ctx,
+				TEEC_SessionRecoveryStats *stats);
+
 /**
  * @brief Opens a new Session between the Client Application and the specified
  * Trusted Application in QTEE.
@@ -122,12 +267,109 @@ void close_session(TEEC_Session *session);
  * @param session The session over which to invoke the command.
  * @param command_id Identifier for the command to invoke.
  * @param op The optional operation payload for this request.
+ * @param timeout Time in milliseconds after which the command is cancelled,
+ *                or MINK_TEEC_TIMEOUT_INFINITE.
  * @param ret_origin The origin of the returned value from QTEE.
  * @return TEEC_SUCCESS If the command was invoked successfully.
  *	   TEEC_ERROR_* otherwise.
  */
 TEEC_Result invoke_command(TEEC_Session *session, uint32_t command_id,
-			   TEEC_Operation *op, uint32_t *ret_origin);
+			   TEEC_Operation *op, uint32_t timeout,
+			   uint32_t *ret_origin);
+
+/**
+ * @brief Invoke a sequence of commands over an established Session, in order
+ * on a completion queue, stopping at the first which fails.
+ *
+ * @param session The session over which to invoke the commands.
+ * @param num The number of commands.
+ * @param command_ids Identifiers for the commands to invoke.
+ * @param ops The optional operation payload of each command, or NULL.
+ * @param results The result of each command.
+ * @param ret_origins The origin of the result of each command, or NULL.
+ * @return TEEC_SUCCESS If all commands were invoked successfully.
+ *	   The result of the command which failed otherwise.
+ */
+TEEC_Result invoke_command_batch(TEEC_Session *session, uint32_t num,
+				 const uint32_t *command_ids,
+				 TEEC_Operation **ops, TEEC_Result *results,
+				 uint32_t *ret_origins);
+
+/**
+ * @brief Invoke a command in several sessions concurrently, on the worker
+ * pool.
+ *
+ * Large temporary input memory references to the same buffer in several
+ * operations are shared with QTEE once for all the commands. Once the timeout
+ * expires, the commands not yet started complete with TEEC_ERROR_CANCEL and
+ * those in flight are cancelled.
+ *
+ * @param sessions The sessions over which to invoke the command.
+ * @param num The number of sessions, at least 1.
+ * @param command_id Identifier for the command to invoke.
+ * @param ops The optional operation payload of each command, or NULL.
+ * @param timeout Time in milliseconds after which the commands still in
+ *                flight are cancelled, or MINK_TEEC_TIMEOUT_INFINITE.
+ * @param results The result of each command.
+ * @param ret_origins The origin of the result of each command, or NULL.
+ * @return TEEC_SUCCESS If all commands were invoked successfully.
+ *	   The result of the first command which failed otherwise.
+ */
+TEEC_Result invoke_command_multi(TEEC_Session **sessions, uint32_t num,
+				 uint32_t command_id, TEEC_Operation **ops,
+				 uint32_t timeout, TEEC_Result *results,
+				 uint32_t *ret_origins);
+
+/**
+ * @brief Invoke a command with an operation already bound to the session.
+ *
+ * As invoke_command(), but the cancellation code and session of the operation
+ * are set by the caller, so that the operation can be cancelled before the
+ * invocation starts.
+ *
+ * @param session The session over which to invoke the command.
+ * @param command_id Identifier for the command to invoke.
+ * @param op The optional operation payload for this request.
+ * @param timeout Time in milliseconds after which the command is cancelled,
+ *                or MINK_TEEC_TIMEOUT_INFINITE.
+ * @param ret_origin The origin of the returned value from QTEE.
+ * @return TEEC_SUCCESS If the command was invoked successfully.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result invoke_operation(TEEC_Session *session, uint32_t command_id,
+			     TEEC_Operation *op, uint32_t timeout,
+			     uint32_t *ret_origin);
+
+/**
+ * @brief Validate and convert an operation once for repeated invocations.
+ *
+ * @param session The session over which the operation is to be invoked.
+ * @param op The operation payload, validated by the caller.
+ * @param prepared The prepared operation.
+ * @return TEEC_SUCCESS If the operation was prepared successfully.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result prepare_operation(TEEC_Session *session, TEEC_Operation *op,
+			      struct prepared_op **prepared);
+
+/**
+ * @brief Invoke a command with a prepared operation.
+ *
+ * @param prep The prepared operation.
+ * @param command_id Identifier for the command to invoke.
+ * @param ret_origin The origin of the returned value from QTEE.
+ * @return TEEC_SUCCESS If the command was invoked successfully.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result invoke_prepared(struct prepared_op *prep, uint32_t command_id,
+			    uint32_t *ret_origin);
+
+/**
+ * @brief Release a prepared operation.
+ *
+ * @param prep The prepared operation.
+ */
+void release_prepared(struct prepared_op *prep);
 
 /**
  * @brief Register a shared memory with QTEE.
@@ -154,6 +396,29 @@ TEEC_Result register_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm,
  */
 TEEC_Result allocate_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm);
 
+/**
+ * @brief Register a memfd another process shares as a shared memory.
+ *
+ * @param ctx The initialized TEE context over which to register the memory.
+ * @param shm The Shared Memory to be registered, of the size to map, or 0 for
+ *            the whole memfd.
+ * @param fd The memfd, sealed against shrinking. It is duplicated.
+ * @return TEEC_SUCCESS If the memory was registered successfully.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result import_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm,
+				 int fd);
+
+/**
+ * @brief Duplicate the memfd backing a shareable shared memory.
+ *
+ * @param shm The Shared Memory allocated with TEEC_MEM_SHAREABLE.
+ * @param fd The duplicate, for the caller to close.
+ * @return TEEC_SUCCESS If the memfd was duplicated.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result export_shared_memory(TEEC_SharedMemory *shm, int *fd);
+
 /**
  * @brief Release a memory shared with QTEE.
  *
@@ -161,6 +426,22 @@ TEEC_Result allocate_shared_memory(TEEC_Context *ctx, TEEC_SharedMemory *shm);
  */
 void release_shared_memory(TEEC_SharedMemory *shm);
 
+/**
+ * @brief Cancel the commands in flight in a Session, and those bound to it
+ * and not yet invoked.
+ *
+ * @param session The session whose commands to cancel.
+ */
+void cancel_session(TEEC_Session *session);
+
+/**
+ * @brief Cancel the commands in flight in a TEE Context, and those bound to
+ * it and not yet invoked, including the opening of Sessions.
+ *
+ * @param ctx The TEE context whose commands to cancel.
+ */
+void cancel_context(TEEC_Context *ctx);
+
 /**
  * @brief Requests cancellation of a pending open Session operation or a
  * Command invocation operation.
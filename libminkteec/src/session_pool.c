@@ -0,0 +1,212 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "session_pool.h"
+
+#include "qlist.h"
+
+typedef struct {
+	QNode qn;
+
+	TEEC_UUID uuid;
+	uint32_t login;
+	uint32_t conn_data;
+	Object session_obj;
+	/* When the session was returned to the pool, in milliseconds */
+	uint64_t idle_since;
+} idle_session;
+
+struct session_pool {
+	TEEC_SessionPoolConfig config;
+	/* Most recently returned first */
+	QList idle;
+	TEEC_SessionPoolStats stats;
+	/* Protect the list and the statistics */
+	pthread_mutex_t mutex;
+};
+
+static uint64_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Close the sessions of a list and free them.
+ *
+ * Closing a session is a round trip to QTEE, so it is done without holding
+ * the lock of the pool.
+ */
+static void close_sessions(QList *list)
+{
+	QNode *node = NULL;
+
+	while ((node = QList_pop(list))) {
+		Object_ASSIGN_NULL(((idle_session *)node)->session_obj);
+		free(node);
+	}
+}
+
+/**
+ * @brief Move the sessions idle for too long to a list. Called with the lock
+ * held.
+ */
+static void evict_expired(struct session_pool *pool, uint64_t now,
+			  QList *evicted)
+{
+	idle_session *s = NULL;
+
+	if (pool->config.maxIdleTime == TEEC_TIMEOUT_INFINITE)
+		return;
+
+	while ((s = (idle_session *)QList_getLast(&pool->idle))) {
+		if (now - s->idle_since < pool->config.maxIdleTime)
+			break;
+
+		QNode_dequeue(&s->qn);
+		QList_appendNode(evicted, &s->qn);
+		pool->stats.evictions++;
+		pool->stats.idle--;
+	}
+}
+
+struct session_pool *session_pool_new(const TEEC_SessionPoolConfig *config)
+{
+	struct session_pool *pool = calloc(1, sizeof(*pool));
+
+	if (!pool)
+		return NULL;
+
+	pool->config = *config;
+	QList_construct(&pool->idle);
+	pthread_mutex_init(&pool->mutex, NULL);
+
+	return pool;
+}
+
+void session_pool_free(struct session_pool *pool)
+{
+	if (!pool)
+		return;
+
+	close_sessions(&pool->idle);
+
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool);
+}
+
+bool session_pool_get(struct session_pool *pool, const TEEC_UUID *uuid,
+		      uint32_t login, uint32_t conn_data, Object *session_obj)
+{
+	QLIST_DEFINE_INIT(evicted);
+	QNode *node = NULL;
+	idle_session *s = NULL;
+	bool found = false;
+
+	pthread_mutex_lock(&pool->mutex);
+
+	evict_expired(pool, now_ms(), &evicted);
+
+	QLIST_FOR_ALL(&pool->idle, node)
+	{
+		s = (idle_session *)node;
+		if (s->login == login && s->conn_data == conn_data &&
+		    !memcmp(&s->uuid, uuid, sizeof(*uuid))) {
+			found = true;
+			break;
+		}
+	}
+
+	if (found) {
+		QNode_dequeue(node);
+		*session_obj = s->session_obj;
+		pool->stats.hits++;
+		pool->stats.idle--;
+	} else {
+		pool->stats.misses++;
+	}
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (found)
+		free(s);
+
+	close_sessions(&evicted);
+
+	return found;
+}
+
+void session_pool_put(struct session_pool *pool, const TEEC_UUID *uuid,
+		      uint32_t login, uint32_t conn_data, Object session_obj)
+{
+	QLIST_DEFINE_INIT(evicted);
+	idle_session *s = NULL;
+	uint64_t now = now_ms();
+
+	if (!pool->config.maxSessions) {
+		Object_RELEASE_IF(session_obj);
+		return;
+	}
+
+	s = malloc(sizeof(*s));
+	if (!s) {
+		Object_RELEASE_IF(session_obj);
+		return;
+	}
+
+	QNode_construct(&s->qn);
+	s->uuid = *uuid;
+	s->login = login;
+	s->conn_data = conn_data;
+	s->session_obj = session_obj;
+	s->idle_since = now;
+
+	pthread_mutex_lock(&pool->mutex);
+
+	evict_expired(pool, now, &evicted);
+
+	/* Make room by closing the session idle the longest */
+	if (pool->stats.idle >= pool->config.maxSessions) {
+		QList_appendNode(&evicted, QList_popLast(&pool->idle));
+		pool->stats.evictions++;
+		pool->stats.idle--;
+	}
+
+	QList_prependNode(&pool->idle, &s->qn);
+	pool->stats.idle++;
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	close_sessions(&evicted);
+}
+
+bool session_pool_health_check(struct session_pool *pool,
+			       uint32_t *command_id)
+{
+	*command_id = pool->config.healthCheckCommand;
+
+	return pool->config.flags & TEEC_SESSION_POOL_HEALTH_CHECK;
+}
+
+void session_pool_check_failed(struct session_pool *pool)
+{
+	pthread_mutex_lock(&pool->mutex);
+	pool->stats.failedChecks++;
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+void session_pool_get_stats(struct session_pool *pool,
+			    TEEC_SessionPoolStats *stats)
+{
+	pthread_mutex_lock(&pool->mutex);
+	*stats = pool->stats;
+	pthread_mutex_unlock(&pool->mutex);
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __SESSION_POOL_H_
+#define __SESSION_POOL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tee_client_api_ext.h"
+
+/* Session pool.
+ *
+ * Opening a session is a round trip to QTEE, and may load the Trusted
+ * Application. A TEE context with a pool keeps the sessions closed by the
+ * client open, keyed by the UUID of the Trusted Application, the login method
+ * and the connection data, and hands them out again on open.
+ *
+ * The pool keeps at most maxSessions idle sessions, most recently used first,
+ * and closes those idle longer than maxIdleTime as it is used. It does not
+ * run a thread of its own.
+ */
+
+struct session_pool;
+
+/**
+ * @brief Create an empty session pool.
+ *
+ * @param config The configuration of the pool.
+ * @return The pool, or NULL if out of memory.
+ */
+struct session_pool *session_pool_new(const TEEC_SessionPoolConfig *config);
+
+/**
+ * @brief Close the sessions held by a pool and free it.
+ *
+ * @param pool The pool, or NULL.
+ */
+void session_pool_free(struct session_pool *pool);
+
+/**
+ * @brief Take an idle session out of a pool.
+ *
+ * @param pool The pool.
+ * @param uuid The UUID of the Trusted Application.
+ * @param login The login method.
+ * @param conn_data The connection data.
+ * @param session_obj The session object, transferred to the caller.
+ * @return true if a session was taken.
+ *         false if the pool holds none for the key.
+ */
+bool session_pool_get(struct session_pool *pool, const TEEC_UUID *uuid,
+		      uint32_t login, uint32_t conn_data, Object *session_obj);
+
+/**
+ * @brief Return a session to a pool, or close it.
+ *
+ * The caller's reference is transferred to the pool.
+ *
+ * @param pool The pool.
+ * @param uuid The UUID of the Trusted Application.
+ * @param login The login method.
+ * @param conn_data The connection data.
+ * @param session_obj The session object.
+ */
+void session_pool_put(struct session_pool *pool, const TEEC_UUID *uuid,
+		      uint32_t login, uint32_t conn_data, Object session_obj);
+
+/**
+ * @brief Get the command to check a session with before handing it out.
+ *
+ * @param pool The pool.
+ * @param command_id The command.
+ * @return true if sessions are to be checked.
+ */
+bool session_pool_health_check(struct session_pool *pool,
+			       uint32_t *command_id);
+
+/**
+ * @brief Count a session which failed the health check.
+ *
+ * @param pool The pool.
+ */
+void session_pool_check_failed(struct session_pool *pool);
+
+/**
+ * @brief Get the statistics of a pool.
+ *
+ * @param pool The pool.
+ * @param stats The statistics.
+ */
+void session_pool_get_stats(struct session_pool *pool,
+			    TEEC_SessionPoolStats *stats);
+
+#endif // __SESSION_POOL_H_
@@ -0,0 +1,296 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "session_recovery.h"
+#include "mink_teec.h"
+
+#include "qlist.h"
+
+#define NSEC_PER_USEC 1000ULL
+#define NSEC_PER_MSEC 1000000ULL
+#define NSEC_PER_SEC  1000000000ULL
+
+/* The recovery state of a session found defunct at least once. */
+typedef struct {
+	QNode qn;
+
+	TEEC_Session *session;
+	/* Set while a thread re-opens the session, so it is re-opened once */
+	bool recovering;
+	/* The last failed re-open, not to attempt another during hold_off */
+	uint64_t failed_at;
+	/* Start of the current recovery */
+	uint64_t started_at;
+} recovering_session;
+
+struct session_recovery {
+	uint32_t max_retries;
+	uint64_t hold_off;
+	uint32_t num_idempotent;
+	uint32_t *idempotent;
+
+	/* Protect sessions and stats */
+	pthread_mutex_t lock;
+	/* Signalled as the recovery of a session ends */
+	pthread_cond_t cond;
+	QList sessions;
+	TEEC_SessionRecoveryStats stats;
+
+	/* Held to replace session objects and epochs, and to read them */
+	pthread_rwlock_t obj_lock;
+};
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_ids(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+struct session_recovery *
+session_recovery_new(const TEEC_SessionRecoveryConfig *config)
+{
+	struct session_recovery *rec = calloc(1, sizeof(*rec));
+
+	if (!rec)
+		return NULL;
+
+	if (config->numIdempotentCommands) {
+		rec->idempotent = calloc(config->numIdempotentCommands,
+					 sizeof(uint32_t));
+		if (!rec->idempotent) {
+			free(rec);
+			return NULL;
+		}
+
+		/* Sorted, to look commands up on each retry */
+		memcpy(rec->idempotent, config->idempotentCommands,
+		       config->numIdempotentCommands * sizeof(uint32_t));
+		qsort(rec->idempotent, config->numIdempotentCommands,
+		      sizeof(uint32_t), compare_ids);
+	}
+
+	rec->num_idempotent = config->numIdempotentCommands;
+	rec->max_retries = config->maxRetries;
+	rec->hold_off = (uint64_t)config->holdOff * NSEC_PER_MSEC;
+
+	pthread_mutex_init(&rec->lock, NULL);
+	pthread_cond_init(&rec->cond, NULL);
+	QList_construct(&rec->sessions);
+	pthread_rwlock_init(&rec->obj_lock, NULL);
+
+	return rec;
+}
+
+void session_recovery_free(struct session_recovery *rec)
+{
+	QNode *node = NULL;
+
+	if (!rec)
+		return;
+
+	while ((node = QList_pop(&rec->sessions)))
+		free(node);
+
+	pthread_rwlock_destroy(&rec->obj_lock);
+	pthread_cond_destroy(&rec->cond);
+	pthread_mutex_destroy(&rec->lock);
+	free(rec->idempotent);
+	free(rec);
+}
+
+Object session_recovery_object(struct session_recovery *rec,
+			       TEEC_Session *session, uint32_t *epoch)
+{
+	Object session_obj = Object_NULL;
+
+	pthread_rwlock_rdlock(&rec->obj_lock);
+	Object_INIT(session_obj, session->imp.session_obj);
+	*epoch = session->imp.epoch;
+	pthread_rwlock_unlock(&rec->obj_lock);
+
+	return session_obj;
+}
+
+/**
+ * @brief Find the recovery state of a session, or add it.
+ *
+ * @return The recovery state, or NULL if out of memory.
+ */
+static recovering_session *find_session(struct session_recovery *rec,
+					TEEC_Session *session, bool add)
+{
+	recovering_session *s = NULL;
+	QNode *node = NULL;
+
+	QLIST_FOR_ALL(&rec->sessions, node)
+	{
+		s = (recovering_session *)node;
+		if (s->session == session)
+			return s;
+	}
+
+	if (!add)
+		return NULL;
+
+	s = calloc(1, sizeof(*s));
+	if (!s)
+		return NULL;
+
+	s->session = session;
+	QList_appendNode(&rec->sessions, &s->qn);
+
+	return s;
+}
+
+bool session_recovery_begin(struct session_recovery *rec,
+			    TEEC_Session *session, uint32_t epoch)
+{
+	recovering_session *s = NULL;
+	uint64_t now = 0;
+
+	/* Only sessions opened without parameters can be opened again */
+	if (!session->imp.poolable)
+		return false;
+
+	pthread_mutex_lock(&rec->lock);
+
+	s = find_session(rec, session, true);
+	if (!s) {
+		pthread_mutex_unlock(&rec->lock);
+		return false;
+	}
+
+	while (s->recovering)
+		pthread_cond_wait(&rec->cond, &rec->lock);
+
+	/* Another thread recovered the session while this one waited */
+	if (session->imp.epoch != epoch) {
+		rec->stats.coalesced++;
+		pthread_mutex_unlock(&rec->lock);
+		return false;
+	}
+
+	/* Not to reload a TA failing to start over and over */
+	now = now_ns();
+	if (s->failed_at && now - s->failed_at < rec->hold_off) {
+		pthread_mutex_unlock(&rec->lock);
+		return false;
+	}
+
+	s->recovering = true;
+	s->started_at = now;
+
+	pthread_mutex_unlock(&rec->lock);
+
+	return true;
+}
+
+void session_recovery_end(struct session_recovery *rec, TEEC_Session *session,
+			  Object session_obj)
+{
+	recovering_session *s = NULL;
+	Object defunct = Object_NULL;
+	uint64_t elapsed = 0;
+
+	if (Object_isNull(session_obj)) {
+		pthread_mutex_lock(&rec->lock);
+		s = find_session(rec, session, false);
+		s->recovering = false;
+		s->failed_at = now_ns();
+		rec->stats.failedRecoveries++;
+		pthread_cond_broadcast(&rec->cond);
+		pthread_mutex_unlock(&rec->lock);
+		return;
+	}
+
+	pthread_rwlock_wrlock(&rec->obj_lock);
+
+	defunct = session->imp.session_obj;
+	session->imp.session_obj = session_obj;
+	session->imp.epoch++;
+
+	pthread_rwlock_unlock(&rec->obj_lock);
+
+	/* Freed once the threads still invoking it release it too */
+	Object_ASSIGN_NULL(defunct);
+
+	pthread_mutex_lock(&rec->lock);
+
+	s = find_session(rec, session, false);
+	s->recovering = false;
+	s->failed_at = 0;
+	elapsed = now_ns() - s->started_at;
+	pthread_cond_broadcast(&rec->cond);
+
+	rec->stats.recoveries++;
+	rec->stats.recoveryTimeTotal += elapsed / NSEC_PER_USEC;
+	if (rec->stats.recoveryTimeMax < elapsed / NSEC_PER_USEC)
+		rec->stats.recoveryTimeMax = elapsed / NSEC_PER_USEC;
+
+	pthread_mutex_unlock(&rec->lock);
+}
+
+bool session_recovery_retry(struct session_recovery *rec,
+			    TEEC_Session *session, uint32_t epoch,
+			    uint32_t command_id, uint32_t attempt)
+{
+	bool recovered = false;
+
+	if (attempt >= rec->max_retries ||
+	    !bsearch(&command_id, rec->idempotent, rec->num_idempotent,
+		     sizeof(uint32_t), compare_ids))
+		return false;
+
+	pthread_rwlock_rdlock(&rec->obj_lock);
+	recovered = session->imp.epoch != epoch;
+	pthread_rwlock_unlock(&rec->obj_lock);
+
+	if (!recovered)
+		return false;
+
+	pthread_mutex_lock(&rec->lock);
+	rec->stats.retries++;
+	pthread_mutex_unlock(&rec->lock);
+
+	return true;
+}
+
+void session_recovery_close(struct session_recovery *rec,
+			    TEEC_Session *session)
+{
+	recovering_session *s = NULL;
+
+	pthread_mutex_lock(&rec->lock);
+
+	s = find_session(rec, session, false);
+	if (s) {
+		QNode_dequeue(&s->qn);
+		free(s);
+	}
+
+	pthread_mutex_unlock(&rec->lock);
+}
+
+void session_recovery_get_stats(struct session_recovery *rec,
+				TEEC_SessionRecoveryStats *stats)
+{
+	pthread_mutex_lock(&rec->lock);
+	*stats = rec->stats;
+	pthread_mutex_unlock(&rec->lock);
+}
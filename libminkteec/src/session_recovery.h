@@ -0,0 +1,117 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __SESSION_RECOVERY_H_
+#define __SESSION_RECOVERY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "object.h"
+#include "tee_client_api_ext.h"
+
+/* Session recovery.
+ *
+ * When QTEE reports a session defunct, e.g. as its TA crashed, a TEE context
+ * with recovery re-opens the session in place, once for all the threads which
+ * found it defunct: the first marks the session as being recovered and
+ * re-opens it, the others wait for it and find the session recovered. Each
+ * session is recovered, and held off after a failed re-open, on its own, so
+ * that recovering one does not hold up the others.
+ *
+ * A command found in the configured idempotent commands is then retried in
+ * the re-opened session.
+ *
+ * Threads may still be invoking the defunct session object as it is
+ * replaced, so each invocation holds a reference to the object it invokes;
+ * the defunct object is freed as the last of them returns.
+ */
+
+struct session_recovery;
+
+/**
+ * @brief Create the session recovery of a TEE context.
+ *
+ * @param config The configuration of the recovery.
+ * @return The session recovery, or NULL if out of memory.
+ */
+struct session_recovery *
+session_recovery_new(const TEEC_SessionRecoveryConfig *config);
+
+/**
+ * @brief Free a session recovery.
+ *
+ * @param rec The session recovery, or NULL.
+ */
+void session_recovery_free(struct session_recovery *rec);
+
+/**
+ * @brief Get the object of a session to invoke.
+ *
+ * @param rec The session recovery.
+ * @param session The session.
+ * @param epoch The number of times the session was recovered, to pass to
+ *              session_recovery_begin() if the object is found defunct.
+ * @return A reference to the session object, to release once invoked.
+ */
+Object session_recovery_object(struct session_recovery *rec,
+			       TEEC_Session *session, uint32_t *epoch);
+
+/**
+ * @brief Start recovering a session found defunct.
+ *
+ * @param rec The session recovery.
+ * @param session The session.
+ * @param epoch The epoch returned with the defunct session object.
+ * @return true if the caller is to re-open the session and then call
+ *         session_recovery_end().
+ *         false if the session was recovered meanwhile, or cannot be.
+ */
+bool session_recovery_begin(struct session_recovery *rec,
+			    TEEC_Session *session, uint32_t epoch);
+
+/**
+ * @brief Finish recovering a session.
+ *
+ * @param rec The session recovery.
+ * @param session The session.
+ * @param session_obj The re-opened session object, or Object_NULL if the
+ *                    session could not be re-opened.
+ */
+void session_recovery_end(struct session_recovery *rec, TEEC_Session *session,
+			  Object session_obj);
+
+/**
+ * @brief Whether a command found the session defunct is retried.
+ *
+ * @param rec The session recovery.
+ * @param session The session.
+ * @param epoch The epoch returned with the defunct session object.
+ * @param command_id The command.
+ * @param attempt The number of times the command was retried already.
+ * @return true if the session was recovered since and the command is to be
+ *         retried in it.
+ */
+bool session_recovery_retry(struct session_recovery *rec,
+			    TEEC_Session *session, uint32_t epoch,
+			    uint32_t command_id, uint32_t attempt);
+
+/**
+ * @brief Forget the recovery state of a session.
+ *
+ * @param rec The session recovery.
+ * @param session The session being closed.
+ */
+void session_recovery_close(struct session_recovery *rec,
+			    TEEC_Session *session);
+
+/**
+ * @brief Get the statistics of a session recovery.
+ *
+ * @param rec The session recovery.
+ * @param stats The statistics.
+ */
+void session_recovery_get_stats(struct session_recovery *rec,
+				TEEC_SessionRecoveryStats *stats);
+
+#endif // __SESSION_RECOVERY_H_
@@ -0,0 +1,106 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shm_cache.h"
+#include "invoke_stats.h"
+#include "MinkCom.h"
+
+struct shm_cache {
+	Object free[SHM_CACHE_DEPTH];
+	size_t num;
+	/* Protect the free list */
+	pthread_mutex_t mutex;
+};
+
+struct shm_cache *shm_cache_new(void)
+{
+	struct shm_cache *cache = calloc(1, sizeof(*cache));
+
+	if (!cache)
+		return NULL;
+
+	pthread_mutex_init(&cache->mutex, NULL);
+
+	return cache;
+}
+
+void shm_cache_free(struct shm_cache *cache)
+{
+	if (!cache)
+		return;
+
+	for (size_t i = 0; i < cache->num; i++)
+		Object_ASSIGN_NULL(cache->free[i]);
+
+	pthread_mutex_destroy(&cache->mutex);
+	free(cache);
+}
+
+int32_t shm_cache_get(struct shm_cache *cache, Object root_obj, size_t size,
+		      Object *mo, void **addr)
+{
+	size_t mo_size;
+	int32_t rv = Object_OK;
+
+	if (size > SHM_CACHE_OBJ_SIZE)
+		return Object_ERROR_SIZE_IN;
+
+	*mo = Object_NULL;
+
+	pthread_mutex_lock(&cache->mutex);
+
+	if (cache->num) {
+		*mo = cache->free[--cache->num];
+		cache->free[cache->num] = Object_NULL;
+	}
+
+	pthread_mutex_unlock(&cache->mutex);
+
+	if (Object_isNull(*mo)) {
+		/* Allocate the largest size so the memory object can be
+		 * reused for any allocation.
+		 */
+		rv = MinkCom_getMemoryObject(root_obj, SHM_CACHE_OBJ_SIZE, mo);
+		if (Object_isERROR(rv))
+			return rv;
+
+		invoke_stats_count_mem_obj();
+	}
+
+	rv = MinkCom_getMemoryObjectInfo(*mo, addr, &mo_size);
+	if (Object_isERROR(rv))
+		Object_ASSIGN_NULL(*mo);
+
+	return rv;
+}
+
+void shm_cache_put(struct shm_cache *cache, Object mo)
+{
+	void *addr;
+	size_t size;
+
+	if (!cache || MinkCom_getMemoryObjectInfo(mo, &addr, &size)) {
+		Object_RELEASE_IF(mo);
+		return;
+	}
+
+	/* The next allocation, possibly passed to another TA, must not see
+	 * the data of this one.
+	 */
+	memset(addr, 0, size);
+
+	pthread_mutex_lock(&cache->mutex);
+
+	if (cache->num < SHM_CACHE_DEPTH) {
+		cache->free[cache->num++] = mo;
+		mo = Object_NULL;
+	}
+
+	pthread_mutex_unlock(&cache->mutex);
+
+	Object_RELEASE_IF(mo);
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __SHM_CACHE_H_
+#define __SHM_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "object.h"
+
+/* Shared memory cache.
+ *
+ * Shared memory up to TEEC_SHM_MAX_HEAP_SZ allocated with
+ * TEEC_AllocateSharedMemory gets a memory object of its own, so that it is
+ * passed to QTEE as a memory object rather than copied on every invocation.
+ * QTEE has access to the whole memory object passed to a TA, so allocations
+ * never share one.
+ *
+ * Each TEE context keeps up to SHM_CACHE_DEPTH memory objects of
+ * SHM_CACHE_OBJ_SIZE bytes once their allocation is released, and hands them
+ * out again rather than allocating new ones. They are cleared as they are
+ * returned, so that they never carry data to the next allocation.
+ */
+
+#define SHM_CACHE_OBJ_SIZE 4096
+#define SHM_CACHE_DEPTH    16
+
+struct shm_cache;
+
+/**
+ * @brief Create an empty shared memory cache.
+ *
+ * @return The cache, or NULL if out of memory.
+ */
+struct shm_cache *shm_cache_new(void);
+
+/**
+ * @brief Release the memory objects held by a cache and free it.
+ *
+ * @param cache The cache, or NULL.
+ */
+void shm_cache_free(struct shm_cache *cache);
+
+/**
+ * @brief Get a memory object for one allocation of shared memory.
+ *
+ * @param cache The cache.
+ * @param root_obj The root object to allocate memory objects from.
+ * @param size The size of the allocation, up to SHM_CACHE_OBJ_SIZE.
+ * @param mo The memory object.
+ * @param addr The address of its memory.
+ * @return Object_OK on success.
+ *         Object_ERROR_* on failure.
+ */
+int32_t shm_cache_get(struct shm_cache *cache, Object root_obj, size_t size,
+		      Object *mo, void **addr);
+
+/**
+ * @brief Return the memory object of a released allocation.
+ *
+ * The caller's reference is transferred to the cache, which clears the
+ * memory of the memory object if it keeps it.
+ *
+ * @param cache The cache, or NULL to release the memory object.
+ * @param mo The memory object obtained with shm_cache_get().
+ */
+void shm_cache_put(struct shm_cache *cache, Object mo);
+
+#endif // __SHM_CACHE_H_
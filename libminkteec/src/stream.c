@@ -0,0 +1,177 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "stream.h"
+#include "completion_queue.h"
+#include "mink_teec.h"
+
+typedef struct {
+	TEEC_SharedMemory shm;
+	TEEC_Operation op;
+} stream_buffer;
+
+/**
+ * @brief Read the next chunk of a payload, until the chunk is full or the
+ * payload ends.
+ *
+ * @param config The stream.
+ * @param buf The buffer to read into.
+ * @param filled The number of bytes read.
+ * @return TEEC_SUCCESS if the chunk was read.
+ *	   TEEC_ERROR_GENERIC otherwise.
+ */
+static TEEC_Result read_chunk(const TEEC_StreamConfig *config, uint8_t *buf,
+			      size_t *filled)
+{
+	ssize_t n = 0;
+
+	*filled = 0;
+
+	while (*filled < config->chunkSize) {
+		if (config->read)
+			n = config->read(config->userData, buf + *filled,
+					 config->chunkSize - *filled);
+		else
+			n = read(config->fd, buf + *filled,
+				 config->chunkSize - *filled);
+
+		if (n < 0) {
+			if (!config->read && errno == EINTR)
+				continue;
+
+			MSGE("Failed to read the stream: %d\n",
+			     config->read ? -1 : errno);
+			return TEEC_ERROR_GENERIC;
+		}
+
+		if (!n)
+			break;
+
+		*filled += (size_t)n;
+	}
+
+	return TEEC_SUCCESS;
+}
+
+/**
+ * @brief Complete the chunks queued and not yet invoked as cancelled.
+ */
+static void cancel_chunks(struct completion_queue *cq, stream_buffer *bufs,
+			  uint32_t num_bufs)
+{
+	for (uint32_t i = 0; i < num_bufs; i++)
+		completion_queue_cancel(cq, &bufs[i].op);
+}
+
+TEEC_Result invoke_stream(TEEC_Session *session,
+			  const TEEC_StreamConfig *config,
+			  uint32_t *ret_origin)
+{
+	stream_buffer bufs[TEEC_CONFIG_STREAM_MAX_BUFFERS];
+	struct completion_queue *cq = NULL;
+	TEEC_Completion completion;
+	TEEC_Result ret = TEEC_SUCCESS;
+	uint32_t origin = TEEC_ORIGIN_API;
+	uint32_t num_bufs = 0;
+	uint32_t in_flight = 0;
+	uint32_t next = 0;
+	uint32_t chunk = 0;
+	stream_buffer *b = NULL;
+	size_t filled = 0;
+	bool done = false;
+
+	memset(bufs, 0, sizeof(bufs));
+
+	/* Allocated memory is shared with QTEE in place, without copies */
+	for (num_bufs = 0; num_bufs < config->numBuffers; num_bufs++) {
+		bufs[num_bufs].shm.size = config->chunkSize;
+		bufs[num_bufs].shm.flags = TEEC_MEM_INPUT;
+
+		ret = allocate_shared_memory(session->imp.ctx,
+					     &bufs[num_bufs].shm);
+		if (ret != TEEC_SUCCESS)
+			goto out;
+	}
+
+	/* A single thread invokes the chunks in the order they are read, and
+	 * cancels those queued after one which fails.
+	 */
+	ret = completion_queue_new(1, &cq);
+	if (ret != TEEC_SUCCESS)
+		goto out;
+
+	completion_queue_stop_on_error(cq);
+
+	while (!done || in_flight) {
+		/* Completions come in order, so the next buffer is free */
+		if (!done && in_flight < num_bufs) {
+			b = &bufs[next];
+
+			ret = read_chunk(config, b->shm.buffer, &filled);
+			if (ret != TEEC_SUCCESS) {
+				origin = TEEC_ORIGIN_API;
+				cancel_chunks(cq, bufs, num_bufs);
+				done = true;
+				continue;
+			}
+
+			/* A short chunk is the last */
+			done = filled < config->chunkSize;
+
+			b->op.started = 0;
+			b->op.paramTypes = TEEC_PARAM_TYPES(
+				TEEC_MEMREF_PARTIAL_INPUT, TEEC_VALUE_INPUT,
+				TEEC_NONE, TEEC_NONE);
+			b->op.params[0].memref.parent = &b->shm;
+			b->op.params[0].memref.offset = 0;
+			b->op.params[0].memref.size = filled;
+			b->op.params[1].value.a = chunk++;
+			b->op.params[1].value.b = done ? TEEC_STREAM_FINAL : 0;
+
+			ret = completion_queue_submit(cq, session,
+						      config->commandID,
+						      &b->op, NULL, NULL);
+			if (ret != TEEC_SUCCESS) {
+				origin = TEEC_ORIGIN_API;
+				cancel_chunks(cq, bufs, num_bufs);
+				done = true;
+				continue;
+			}
+
+			in_flight++;
+			next = (next + 1) % num_bufs;
+			continue;
+		}
+
+		completion_queue_wait(cq, &completion, 1,
+				      MINK_TEEC_TIMEOUT_INFINITE);
+		in_flight--;
+
+		/* The origin is that of the first failure, once there is one */
+		if (ret != TEEC_SUCCESS)
+			continue;
+
+		origin = completion.returnOrigin;
+		if (completion.result == TEEC_SUCCESS)
+			continue;
+
+		ret = completion.result;
+		done = true;
+	}
+
+out:
+	if (cq)
+		completion_queue_free(cq);
+
+	for (uint32_t i = 0; i < num_bufs; i++)
+		release_shared_memory(&bufs[i].shm);
+
+	if (ret_origin)
+		*ret_origin = origin;
+
+	return ret;
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __STREAM_H_
+#define __STREAM_H_
+
+#include <stdint.h>
+
+#include "tee_client_api_ext.h"
+
+/* Streams.
+ *
+ * A payload too large to pass in one command is passed to the TA in chunks,
+ * one command per chunk. Chunks are read into a ring of buffers allocated
+ * once, shared with QTEE, and invoked in order by a completion queue with a
+ * single thread; the calling thread reads the next chunks into the free
+ * buffers meanwhile, so that reading the payload overlaps with the TA
+ * processing it.
+ */
+
+/**
+ * @brief Stream a payload to a TA.
+ *
+ * @param session The session in which to invoke the commands.
+ * @param config The stream, validated by the caller.
+ * @param ret_origin The origin of the result.
+ * @return TEEC_SUCCESS if every chunk was processed.
+ *	   TEEC_ERROR_* otherwise.
+ */
+TEEC_Result invoke_stream(TEEC_Session *session,
+			  const TEEC_StreamConfig *config,
+			  uint32_t *ret_origin);
+
+#endif // __STREAM_H_
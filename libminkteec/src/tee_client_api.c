@@ -1,7 +1,14 @@
 // Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include <signal.h>
+
 #include "mink_teec.h"
+#include "completion_queue.h"
+#include "context_pool.h"
+#include "invoke_stats.h"
+#include "stream.h"
+#include "tee_client_api_ext.h"
 
 static int verify_shm(TEEC_RegisteredMemoryReference memref,
 		      TEEC_SharedMemory *shm, TEEC_Context *ctx, uint32_t type)
@@ -187,11 +194,115 @@ TEEC_Result TEEC_InvokeCommand(TEEC_Session *session, uint32_t command_id,
 			return TEEC_ERROR_BAD_PARAMETERS;
 	}
 
-	ret = invoke_command(session, command_id, op, ret_origin);
+	ret = invoke_command(session, command_id, op, ctx->imp.invoke_timeout,
+			     ret_origin);
 
 	return ret;
 }
 
+TEEC_Result TEEC_InvokeCommandWithTimeout(TEEC_Session *session,
+					  uint32_t command_id,
+					  TEEC_Operation *op, uint32_t timeout,
+					  uint32_t *ret_origin)
+{
+	TEEC_Context *ctx = NULL;
+
+	if (ret_origin) {
+		*ret_origin = TEEC_ORIGIN_API;
+	}
+
+	if (!session)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	ctx = session->imp.ctx;
+
+	if (op) {
+		if (verify_param_types(op->paramTypes))
+			return TEEC_ERROR_BAD_PARAMETERS;
+
+		if (verify_params(ctx, op->paramTypes, op->params))
+			return TEEC_ERROR_BAD_PARAMETERS;
+	}
+
+	return invoke_command(session, command_id, op, timeout, ret_origin);
+}
+
+TEEC_Result TEEC_InvokeCommandBatch(TEEC_Session *session, uint32_t num,
+				    const uint32_t *command_ids,
+				    TEEC_Operation **ops, TEEC_Result *results,
+				    uint32_t *ret_origins)
+{
+	TEEC_Operation *op = NULL;
+
+	if (!session || (num && (!command_ids || !results)))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	for (uint32_t i = 0; i < num; i++) {
+		results[i] = TEEC_ERROR_BAD_PARAMETERS;
+		if (ret_origins)
+			ret_origins[i] = TEEC_ORIGIN_API;
+	}
+
+	/* Validate all operations before invoking any command */
+	for (uint32_t i = 0; ops && i < num; i++) {
+		op = ops[i];
+		if (!op)
+			continue;
+
+		if (verify_param_types(op->paramTypes))
+			return TEEC_ERROR_BAD_PARAMETERS;
+
+		if (verify_params(session->imp.ctx, op->paramTypes,
+				  op->params))
+			return TEEC_ERROR_BAD_PARAMETERS;
+	}
+
+	return invoke_command_batch(session, num, command_ids, ops, results,
+				    ret_origins);
+}
+
+TEEC_Result TEEC_InvokeCommandMulti(TEEC_Session **sessions, uint32_t num,
+				    uint32_t command_id, TEEC_Operation **ops,
+				    uint32_t timeout, TEEC_Result *results,
+				    uint32_t *ret_origins)
+{
+	TEEC_Operation *op = NULL;
+
+	if (!sessions || !num || !results)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	for (uint32_t i = 0; i < num; i++) {
+		results[i] = TEEC_ERROR_BAD_PARAMETERS;
+		if (ret_origins)
+			ret_origins[i] = TEEC_ORIGIN_API;
+	}
+
+	/* Validate all sessions and operations before invoking any command */
+	for (uint32_t i = 0; i < num; i++) {
+		if (!sessions[i] || !sessions[i]->imp.ctx)
+			return TEEC_ERROR_BAD_PARAMETERS;
+
+		op = ops ? ops[i] : NULL;
+		if (!op)
+			continue;
+
+		/* Operations are invoked concurrently */
+		for (uint32_t j = 0; j < i; j++)
+			if (ops[j] == op)
+				return TEEC_ERROR_BAD_PARAMETERS;
+
+		if (verify_param_types(op->paramTypes))
+			return TEEC_ERROR_BAD_PARAMETERS;
+
+		if (verify_params(sessions[i]->imp.ctx, op->paramTypes,
+				  op->params))
+			return TEEC_ERROR_BAD_PARAMETERS;
+	}
+
+	return invoke_command_multi(sessions, num, command_id, ops, timeout,
+				    results, ret_origins);
+}
+
 TEEC_Result TEEC_RegisterSharedMemory(TEEC_Context *ctx, TEEC_SharedMemory *shm)
 {
 	if (!ctx || !shm)
@@ -220,6 +331,26 @@ TEEC_Result TEEC_AllocateSharedMemory(TEEC_Context *ctx, TEEC_SharedMemory *shm)
 	return allocate_shared_memory(ctx, shm);
 }
 
+TEEC_Result TEEC_ExportSharedMemory(TEEC_SharedMemory *shm, int *fd)
+{
+	if (!shm || !fd)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return export_shared_memory(shm, fd);
+}
+
+TEEC_Result TEEC_ImportSharedMemory(TEEC_Context *ctx, TEEC_SharedMemory *shm,
+				    int fd)
+{
+	if (!ctx || !shm || fd < 0)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (!shm->flags || (shm->flags & ~(TEEC_MEM_INPUT | TEEC_MEM_OUTPUT)))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return import_shared_memory(ctx, shm, fd);
+}
+
 void TEEC_ReleaseSharedMemory(TEEC_SharedMemory *shm)
 {
 	if (!shm)
@@ -250,3 +381,270 @@ void TEEC_RequestCancellation(TEEC_Operation *op)
 
 	request_cancellation(op);
 }
+
+void TEEC_CancelSession(TEEC_Session *session)
+{
+	if (!session || !session->imp.ctx) {
+		MSGE("Invalid session.\n");
+		return;
+	}
+
+	cancel_session(session);
+}
+
+void TEEC_CancelContext(TEEC_Context *ctx)
+{
+	if (!ctx) {
+		MSGE("Invalid context.\n");
+		return;
+	}
+
+	cancel_context(ctx);
+}
+
+TEEC_Result TEEC_PrepareOperation(TEEC_Session *session, TEEC_Operation *op,
+				  TEEC_PreparedOperation *prepared)
+{
+	if (!session || !op || !prepared)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	prepared->imp.prep = NULL;
+
+	if (verify_param_types(op->paramTypes))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (verify_params(session->imp.ctx, op->paramTypes, op->params))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return prepare_operation(session, op, &prepared->imp.prep);
+}
+
+TEEC_Result TEEC_InvokePrepared(TEEC_PreparedOperation *prepared,
+				uint32_t command_id, uint32_t *ret_origin)
+{
+	if (ret_origin) {
+		*ret_origin = TEEC_ORIGIN_API;
+	}
+
+	if (!prepared || !prepared->imp.prep)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return invoke_prepared(prepared->imp.prep, command_id, ret_origin);
+}
+
+void TEEC_ReleasePreparedOperation(TEEC_PreparedOperation *prepared)
+{
+	if (!prepared || !prepared->imp.prep)
+		return;
+
+	release_prepared(prepared->imp.prep);
+	prepared->imp.prep = NULL;
+}
+
+TEEC_Result TEEC_ConfigureSessionPool(TEEC_Context *ctx,
+				      const TEEC_SessionPoolConfig *config)
+{
+	if (!ctx)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (config && (config->flags & ~TEEC_SESSION_POOL_HEALTH_CHECK))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return configure_session_pool(ctx, config);
+}
+
+TEEC_Result TEEC_GetSessionPoolStats(TEEC_Context *ctx,
+				     TEEC_SessionPoolStats *stats)
+{
+	if (!ctx || !stats)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	get_session_pool_stats(ctx, stats);
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result TEEC_ConfigureContextPool(const TEEC_ContextPoolConfig *config)
+{
+	if (config && (config->maxContexts > TEEC_CONFIG_CONTEXT_POOL_MAX ||
+		       (config->flags & ~TEEC_CONTEXT_POOL_WARM)))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return context_pool_configure(config);
+}
+
+TEEC_Result TEEC_GetContextPoolStats(TEEC_ContextPoolStats *stats)
+{
+	if (!stats)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	context_pool_get_stats(stats);
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result
+TEEC_ConfigureSessionRecovery(TEEC_Context *ctx,
+			      const TEEC_SessionRecoveryConfig *config)
+{
+	if (!ctx)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (config && config->numIdempotentCommands &&
+	    !config->idempotentCommands)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return configure_session_recovery(ctx, config);
+}
+
+TEEC_Result TEEC_GetBounceBufferStats(TEEC_Context *ctx,
+				      TEEC_BounceBufferStats *stats)
+{
+	if (!ctx || !stats)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	get_bounce_buffer_stats(ctx, stats);
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result TEEC_GetSessionRecoveryStats(TEEC_Context *ctx,
+					 TEEC_SessionRecoveryStats *stats)
+{
+	if (!ctx || !stats)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	get_session_recovery_stats(ctx, stats);
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result TEEC_ConfigureStatistics(TEEC_Context *ctx,
+				     const TEEC_StatisticsConfig *config)
+{
+	if (!ctx)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (config && config->maxCommands > TEEC_CONFIG_STATS_MAX_COMMANDS)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	configure_statistics(ctx, config);
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result TEEC_GetStatistics(TEEC_Session *session,
+			       TEEC_CommandStatistics *stats,
+			       uint32_t *numStats)
+{
+	if (!session || !numStats || (*numStats && !stats))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return get_statistics(session, stats, numStats);
+}
+
+TEEC_Result TEEC_DumpStatisticsOnSignal(int signum, int fd)
+{
+	if (signum <= 0 || signum >= NSIG || fd < 0)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return invoke_stats_dump_on_signal(signum, fd);
+}
+
+TEEC_Result TEEC_SetInvokeTimeout(TEEC_Context *ctx, uint32_t timeout)
+{
+	if (!ctx)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	ctx->imp.invoke_timeout = timeout;
+
+	return TEEC_SUCCESS;
+}
+
+TEEC_Result TEEC_InitializeCompletionQueue(uint32_t num_threads,
+					   TEEC_CompletionQueue *queue)
+{
+	if (!queue)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	queue->imp.cq = NULL;
+
+	if (!num_threads ||
+	    num_threads > TEEC_CONFIG_COMPLETION_QUEUE_MAX_THREADS)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return completion_queue_new(num_threads, &queue->imp.cq);
+}
+
+void TEEC_FinalizeCompletionQueue(TEEC_CompletionQueue *queue)
+{
+	if (!queue || !queue->imp.cq)
+		return;
+
+	completion_queue_free(queue->imp.cq);
+	queue->imp.cq = NULL;
+}
+
+TEEC_Result TEEC_SubmitCommand(TEEC_CompletionQueue *queue,
+			       TEEC_Session *session, uint32_t command_id,
+			       TEEC_Operation *op, void *user_data,
+			       uint64_t *handle)
+{
+	if (!queue || !queue->imp.cq || !session)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (op) {
+		if (verify_param_types(op->paramTypes))
+			return TEEC_ERROR_BAD_PARAMETERS;
+
+		if (verify_params(session->imp.ctx, op->paramTypes,
+				  op->params))
+			return TEEC_ERROR_BAD_PARAMETERS;
+	}
+
+	return completion_queue_submit(queue->imp.cq, session, command_id, op,
+				       user_data, handle);
+}
+
+TEEC_Result TEEC_WaitCompletions(TEEC_CompletionQueue *queue,
+				 TEEC_Completion *completions,
+				 uint32_t max_completions, uint32_t timeout,
+				 uint32_t *num_completions)
+{
+	if (!queue || !queue->imp.cq || !completions || !max_completions ||
+	    !num_completions)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	*num_completions = completion_queue_wait(queue->imp.cq, completions,
+						 max_completions, timeout);
+
+	return TEEC_SUCCESS;
+}
+
+int TEEC_GetCompletionQueueFd(TEEC_CompletionQueue *queue)
+{
+	if (!queue || !queue->imp.cq)
+		return -1;
+
+	return completion_queue_fd(queue->imp.cq);
+}
+
+TEEC_Result TEEC_InvokeStream(TEEC_Session *session,
+			      const TEEC_StreamConfig *config,
+			      uint32_t *ret_origin)
+{
+	if (ret_origin)
+		*ret_origin = TEEC_ORIGIN_API;
+
+	if (!session || !config)
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	if (config->numBuffers < 2 ||
+	    config->numBuffers > TEEC_CONFIG_STREAM_MAX_BUFFERS ||
+	    !config->chunkSize ||
+	    config->chunkSize > TEEC_CONFIG_SHAREDMEM_MAX_SIZE ||
+	    (!config->read && config->fd < 0))
+		return TEEC_ERROR_BAD_PARAMETERS;
+
+	return invoke_stream(session, config, ret_origin);
+}
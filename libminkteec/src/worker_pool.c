@@ -0,0 +1,100 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <pthread.h>
+
+#include "worker_pool.h"
+#include "mink_teec.h"
+
+static struct {
+	QList items;
+	uint32_t num_items;
+	uint32_t num_threads;
+	uint32_t num_idle;
+	/* Protect all of the above */
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+} pool = {
+	.items = { { &pool.items.n, &pool.items.n } },
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void *worker_thread(void *arg)
+{
+	struct work_item *item = NULL;
+
+	(void)arg;
+
+	pthread_mutex_lock(&pool.lock);
+
+	for (;;) {
+		item = (struct work_item *)QList_pop(&pool.items);
+		if (!item) {
+			pool.num_idle++;
+			pthread_cond_wait(&pool.cond, &pool.lock);
+			pool.num_idle--;
+			continue;
+		}
+
+		pool.num_items--;
+		pthread_mutex_unlock(&pool.lock);
+		item->fn(item);
+		pthread_mutex_lock(&pool.lock);
+	}
+
+	return NULL;
+}
+
+void worker_pool_submit(QList *items, uint32_t num)
+{
+	pthread_attr_t attr;
+	pthread_t thread;
+	uint32_t num_started = 0;
+
+	pthread_mutex_lock(&pool.lock);
+
+	QList_appendList(&pool.items, items);
+	pool.num_items += num;
+
+	/* Start threads for the items idle threads cannot take */
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+	while (pool.num_idle + num_started < pool.num_items &&
+	       pool.num_threads < WORKER_POOL_MAX_THREADS) {
+		if (pthread_create(&thread, &attr, worker_thread, NULL)) {
+			MSGE("pthread_create failed for the worker pool\n");
+			break;
+		}
+
+		pool.num_threads++;
+		num_started++;
+	}
+
+	pthread_attr_destroy(&attr);
+
+	if (num > 1)
+		pthread_cond_broadcast(&pool.cond);
+	else
+		pthread_cond_signal(&pool.cond);
+
+	pthread_mutex_unlock(&pool.lock);
+}
+
+bool worker_pool_reclaim(struct work_item *item)
+{
+	bool queued = false;
+
+	pthread_mutex_lock(&pool.lock);
+
+	queued = QNode_isQueued(&item->qn);
+	if (queued) {
+		QNode_dequeue(&item->qn);
+		pool.num_items--;
+	}
+
+	pthread_mutex_unlock(&pool.lock);
+
+	return queued;
+}
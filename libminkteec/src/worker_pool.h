@@ -0,0 +1,54 @@
+// Copyright (c) 2025, Qualcomm Innovation Center, Inc. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef __WORKER_POOL_H_
+#define __WORKER_POOL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "qlist.h"
+
+/* Worker pool.
+ *
+ * A process-wide pool of threads running work items, for commands the
+ * library invokes concurrently on behalf of one client thread. Threads are
+ * started on demand, up to WORKER_POOL_MAX_THREADS, and then kept idle for
+ * the next work items; items beyond the threads wait in the order they were
+ * submitted.
+ *
+ * Work items are owned by the submitter, which waits for them to run, and
+ * runs those no thread has picked up yet itself.
+ */
+
+#define WORKER_POOL_MAX_THREADS 16
+
+struct work_item {
+	QNode qn;
+
+	void (*fn)(struct work_item *item);
+};
+
+/**
+ * @brief Submit work items to the pool.
+ *
+ * Items may stay queued if no thread can be started; the submitter is to
+ * reclaim them with worker_pool_reclaim() before waiting for them.
+ *
+ * @param items The work items, each valid until its function has run. The
+ *              list is emptied.
+ * @param num The number of work items.
+ */
+void worker_pool_submit(QList *items, uint32_t num);
+
+/**
+ * @brief Take back a work item no thread has picked up yet, to run it in the
+ * calling thread instead.
+ *
+ * @param item The work item.
+ * @return true if the item was taken back.
+ *         false if a thread has picked it up.
+ */
+bool worker_pool_reclaim(struct work_item *item);
+
+#endif // __WORKER_POOL_H_
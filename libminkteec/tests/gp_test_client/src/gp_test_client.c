@@ -9,6 +9,7 @@
 #include <unistd.h>
 
 #include "tee_client_api.h"
+#include "tee_client_api_ext.h"
 #include "gp_load_ta.h"
 
 #define EXAMPLE_MULTIPLY_HLOS_BUFFER_CMD 1
@@ -57,6 +58,37 @@ const TEEC_UUID gp_sample2_uuid = { 0Xc02cac07,
 
 #define GP_TESTAPP_TEST_COUNTS 4
 
+#define PREPARED_INVOKE_COUNT 3
+
+#define ASYNC_INVOKE_COUNT 8
+#define ASYNC_INVOKE_THREADS 2
+
+#define SESSION_POOL_OPEN_COUNT 3
+
+#define CONTEXT_POOL_INIT_COUNT 3
+
+#define MULTI_INVOKE_SESSIONS 4
+
+#define SESSION_RECOVERY_HOLD_OFF_MS 100
+
+#define STATISTICS_INVOKE_COUNT 4
+
+#define LOCAL_TA_FILL_BYTE 0x5A
+#define LOCAL_TA_SLEEP_MS 1000
+
+#define SHAREABLE_MEM_SIZE 0x3000
+
+#define STREAM_CHUNK_SIZE 0x1000
+#define STREAM_CHUNKS 4
+#define STREAM_BUFFERS 3
+#define STREAM_FAIL_AT (2 * STREAM_CHUNK_SIZE)
+
+#define RECOVERY_THREADS 4
+#define RECOVERY_SLEEP_MS 300
+#define RECOVERY_CRASH_DELAY_MS 100
+
+#define INVOKE_TIMEOUT_MS 200
+
 #define GP_HEAP_TESTS 11
 #define GP_PROPERTY_TESTS 12
 #define GP_TA_TA_TESTS 15
@@ -96,21 +128,1144 @@ static TEEC_Result run_gptest_app_cmds(void)
 	operation.paramTypes =
 		TEEC_PARAM_TYPES(TEEC_NONE, TEEC_NONE, TEEC_NONE, TEEC_NONE);
 
-	for (size_t i = 0; i < GP_TESTAPP_TEST_COUNTS; i++) {
-		result = TEEC_InvokeCommand(&session, commands[i], &operation,
-					    &return_origin);
+	for (size_t i = 0; i < GP_TESTAPP_TEST_COUNTS; i++) {
+		result = TEEC_InvokeCommand(&session, commands[i], &operation,
+					    &return_origin);
+
+		if (commands[i] == GP_TA_TA_NEG_TESTS)
+			result = result != TEEC_SUCCESS ? TEEC_SUCCESS :
+							  TEEC_ERROR_GENERIC;
+
+		if (result != TEEC_SUCCESS)
+			printf("TEEC_InvokeCommand %d failed, ret = 0x%x.\n",
+			       commands[i], result);
+		else
+			printf("TEEC_InvokeCommand %d passed.\n", commands[i]);
+	}
+
+	TEEC_CloseSession(&session);
+
+err_open_sess:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static TEEC_Result run_compare_tmp_buffer_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_Operation operation = { 0 };
+	TEEC_TempMemoryReference tmpref = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint8_t check_buf[BUFFER_SIZE] = { 0 };
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	// Allocate temp mem
+	tmpref.buffer = malloc(BUFFER_SIZE);
+	if (!tmpref.buffer)
+		goto err_tmp_malloc;
+	tmpref.size = BUFFER_SIZE;
+
+	/* Initialize buffer to all 1's */
+	memset(tmpref.buffer, 0x1, tmpref.size);
+
+	/* Initialize check_buf to all 1's */
+	memset(check_buf, 0x1, sizeof(check_buf));
+
+	/* Setup operation */
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT,
+						TEEC_MEMREF_TEMP_INOUT,
+						TEEC_NONE, TEEC_NONE);
+
+	operation.params[0].value.a = 42;
+	operation.params[1].tmpref = tmpref;
+
+	result = TEEC_InvokeCommand(&session, EXAMPLE_MULTIPLY_HLOS_BUFFER_CMD,
+				    &operation, &return_origin);
+
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeCommand failed, ret = 0x%x.\n", result);
+		goto err_invoke_cmd;
+	}
+
+	/* Do the multiply locally */
+	for (size_t cnt = 0; cnt < tmpref.size; ++cnt)
+		*(check_buf + cnt) *= operation.params[0].value.a;
+
+	if (memcmp(tmpref.buffer, check_buf, tmpref.size))
+		printf("[TEST FAILED] Buffer comparison failed!\n");
+	else
+		printf("[TEST PASSED] Buffer comparison success.\n");
+
+err_invoke_cmd:
+	free(tmpref.buffer);
+
+err_tmp_malloc:
+	TEEC_CloseSession(&session);
+
+err_open_sess:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static TEEC_Result run_prepared_invoke_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_Operation operation = { 0 };
+	TEEC_PreparedOperation prepared = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint8_t check_buf[BUFFER_SIZE] = { 0 };
+	uint8_t *buffer = NULL;
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	buffer = malloc(BUFFER_SIZE);
+	if (!buffer) {
+		result = TEEC_ERROR_OUT_OF_MEMORY;
+		goto err_tmp_malloc;
+	}
+
+	/* Initialize buffer and check_buf to all 1's */
+	memset(buffer, 0x1, BUFFER_SIZE);
+	memset(check_buf, 0x1, sizeof(check_buf));
+
+	/* Setup operation */
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT,
+						TEEC_MEMREF_TEMP_INOUT,
+						TEEC_NONE, TEEC_NONE);
+	operation.params[1].tmpref.buffer = buffer;
+	operation.params[1].tmpref.size = BUFFER_SIZE;
+
+	result = TEEC_PrepareOperation(&session, &operation, &prepared);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_PrepareOperation failed, ret = 0x%x.\n", result);
+		goto err_prepare;
+	}
+
+	/* Only the value changes between invocations */
+	for (uint32_t i = 0; i < PREPARED_INVOKE_COUNT; i++) {
+		operation.params[0].value.a = i + 2;
+		operation.params[1].tmpref.size = BUFFER_SIZE;
+
+		result = TEEC_InvokePrepared(&prepared,
+					     EXAMPLE_MULTIPLY_HLOS_BUFFER_CMD,
+					     &return_origin);
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_InvokePrepared failed, ret = 0x%x.\n",
+			       result);
+			goto err_invoke_cmd;
+		}
+
+		/* Do the multiply locally */
+		for (size_t cnt = 0; cnt < BUFFER_SIZE; ++cnt)
+			check_buf[cnt] *= operation.params[0].value.a;
+	}
+
+	if (memcmp(buffer, check_buf, BUFFER_SIZE))
+		printf("[TEST FAILED] Buffer comparison failed!\n");
+	else
+		printf("[TEST PASSED] Buffer comparison success.\n");
+
+err_invoke_cmd:
+	TEEC_ReleasePreparedOperation(&prepared);
+
+err_prepare:
+	free(buffer);
+
+err_tmp_malloc:
+	TEEC_CloseSession(&session);
+
+err_open_sess:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static TEEC_Result run_async_invoke_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_CompletionQueue queue = { 0 };
+	TEEC_Operation operations[ASYNC_INVOKE_COUNT] = { 0 };
+	TEEC_Completion completions[ASYNC_INVOKE_COUNT] = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint8_t check_buf[BUFFER_SIZE] = { 0 };
+	uint8_t *buffers = NULL;
+	uint32_t submitted = 0;
+	uint32_t reaped = 0;
+	uint32_t num = 0;
+	uint32_t failed = 0;
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	result = TEEC_InitializeCompletionQueue(ASYNC_INVOKE_THREADS, &queue);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeCompletionQueue failed, ret = 0x%x.\n",
+		       result);
+		goto err_init_queue;
+	}
+
+	buffers = malloc(ASYNC_INVOKE_COUNT * BUFFER_SIZE);
+	if (!buffers) {
+		result = TEEC_ERROR_OUT_OF_MEMORY;
+		goto err_tmp_malloc;
+	}
+
+	/* Initialize buffers and check_buf to all 1's */
+	memset(buffers, 0x1, ASYNC_INVOKE_COUNT * BUFFER_SIZE);
+	memset(check_buf, 0x1, sizeof(check_buf));
+
+	/* Submit all commands before reaping any */
+	for (submitted = 0; submitted < ASYNC_INVOKE_COUNT; submitted++) {
+		TEEC_Operation *op = &operations[submitted];
+
+		op->paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT,
+						  TEEC_MEMREF_TEMP_INOUT,
+						  TEEC_NONE, TEEC_NONE);
+		op->params[0].value.a = 2;
+		op->params[1].tmpref.buffer = buffers + submitted * BUFFER_SIZE;
+		op->params[1].tmpref.size = BUFFER_SIZE;
+
+		result = TEEC_SubmitCommand(&queue, &session,
+					    EXAMPLE_MULTIPLY_HLOS_BUFFER_CMD,
+					    op, NULL, NULL);
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_SubmitCommand failed, ret = 0x%x.\n",
+			       result);
+			break;
+		}
+	}
+
+	while (reaped < submitted) {
+		TEEC_WaitCompletions(&queue, completions, ASYNC_INVOKE_COUNT,
+				     TEEC_TIMEOUT_INFINITE, &num);
+
+		for (uint32_t i = 0; i < num; i++) {
+			if (completions[i].result != TEEC_SUCCESS) {
+				printf("Command failed, ret = 0x%x.\n",
+				       completions[i].result);
+				failed++;
+			}
+		}
+
+		reaped += num;
+	}
+
+	if (result != TEEC_SUCCESS)
+		goto err_submit;
+
+	for (size_t cnt = 0; cnt < BUFFER_SIZE; ++cnt)
+		check_buf[cnt] *= 2;
+
+	for (uint32_t i = 0; i < ASYNC_INVOKE_COUNT; i++) {
+		if (memcmp(buffers + i * BUFFER_SIZE, check_buf, BUFFER_SIZE))
+			failed++;
+	}
+
+	if (failed)
+		printf("[TEST FAILED] Buffer comparison failed!\n");
+	else
+		printf("[TEST PASSED] Buffer comparison success.\n");
+
+err_submit:
+	free(buffers);
+
+err_tmp_malloc:
+	TEEC_FinalizeCompletionQueue(&queue);
+
+err_init_queue:
+	TEEC_CloseSession(&session);
+
+err_open_sess:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static TEEC_Result run_session_pool_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_Operation operation = { 0 };
+	TEEC_SessionPoolConfig config = { 0 };
+	TEEC_SessionPoolStats stats = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint8_t check_buf[BUFFER_SIZE] = { 0 };
+	uint8_t buffer[BUFFER_SIZE] = { 0 };
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	/* Check pooled sessions with a command taking no parameters */
+	config.maxSessions = 1;
+	config.maxIdleTime = TEEC_TIMEOUT_INFINITE;
+	config.flags = TEEC_SESSION_POOL_HEALTH_CHECK;
+	config.healthCheckCommand = GP_PROPERTY_TESTS;
+
+	result = TEEC_ConfigureSessionPool(&context, &config);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_ConfigureSessionPool failed, ret = 0x%x.\n",
+		       result);
+		goto err_config_pool;
+	}
+
+	memset(buffer, 0x1, sizeof(buffer));
+	memset(check_buf, 0x1, sizeof(check_buf));
+
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT,
+						TEEC_MEMREF_TEMP_INOUT,
+						TEEC_NONE, TEEC_NONE);
+	operation.params[0].value.a = 2;
+
+	/* Sessions after the first come from the pool */
+	for (uint32_t i = 0; i < SESSION_POOL_OPEN_COUNT; i++) {
+		result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+					  TEEC_LOGIN_USER, NULL, NULL,
+					  &return_origin);
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_OpenSession failed, ret = 0x%x.\n",
+			       result);
+			goto err_config_pool;
+		}
+
+		operation.params[1].tmpref.buffer = buffer;
+		operation.params[1].tmpref.size = BUFFER_SIZE;
+
+		result = TEEC_InvokeCommand(&session,
+					    EXAMPLE_MULTIPLY_HLOS_BUFFER_CMD,
+					    &operation, &return_origin);
+
+		TEEC_CloseSession(&session);
+
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_InvokeCommand failed, ret = 0x%x.\n",
+			       result);
+			goto err_config_pool;
+		}
+
+		for (size_t cnt = 0; cnt < BUFFER_SIZE; ++cnt)
+			check_buf[cnt] *= 2;
+	}
+
+	if (memcmp(buffer, check_buf, BUFFER_SIZE)) {
+		printf("[TEST FAILED] Buffer comparison failed!\n");
+		goto err_config_pool;
+	}
+
+	result = TEEC_GetSessionPoolStats(&context, &stats);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_GetSessionPoolStats failed, ret = 0x%x.\n",
+		       result);
+		goto err_config_pool;
+	}
+
+	if (stats.hits != SESSION_POOL_OPEN_COUNT - 1 || stats.misses != 1) {
+		printf("[TEST FAILED] %llu sessions pooled, %llu opened!\n",
+		       (unsigned long long)stats.hits,
+		       (unsigned long long)stats.misses);
+		result = TEEC_ERROR_GENERIC;
+		goto err_config_pool;
+	}
+
+	printf("[TEST PASSED] Buffer comparison success.\n");
+
+err_config_pool:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static TEEC_Result run_context_pool_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_ContextPoolConfig config = { 0 };
+	TEEC_ContextPoolStats before = { 0 };
+	TEEC_ContextPoolStats after = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+
+	config.maxContexts = 1;
+	config.flags = TEEC_CONTEXT_POOL_WARM;
+
+	/* The statistics are process-wide: compare against a baseline */
+	TEEC_GetContextPoolStats(&before);
+
+	result = TEEC_ConfigureContextPool(&config);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_ConfigureContextPool failed, ret = 0x%x.\n",
+		       result);
+		goto err_config_pool;
+	}
+
+	/* Contexts after the first come from the pool */
+	for (uint32_t i = 0; i < CONTEXT_POOL_INIT_COUNT; i++) {
+		result = TEEC_InitializeContext(NULL, &context);
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_InitializeContext failed, ret = 0x%x.\n",
+			       result);
+			goto err_config_pool;
+		}
+
+		result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+					  TEEC_LOGIN_USER, NULL, NULL,
+					  &return_origin);
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_OpenSession failed, ret = 0x%x.\n",
+			       result);
+			TEEC_FinalizeContext(&context);
+			goto err_config_pool;
+		}
+
+		result = TEEC_InvokeCommand(&session, GP_PROPERTY_TESTS, NULL,
+					    &return_origin);
+
+		TEEC_CloseSession(&session);
+		TEEC_FinalizeContext(&context);
+
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_InvokeCommand failed, ret = 0x%x.\n",
+			       result);
+			goto err_config_pool;
+		}
+	}
+
+	TEEC_GetContextPoolStats(&after);
+
+	/* The warming thread may not have opened one for the first context */
+	if (after.hits - before.hits < CONTEXT_POOL_INIT_COUNT - 1) {
+		printf("[TEST FAILED] %llu contexts from the pool!\n",
+		       (unsigned long long)(after.hits - before.hits));
+		result = TEEC_ERROR_GENERIC;
+		goto err_config_pool;
+	}
+
+	printf("[TEST PASSED] Contexts initialized from the pool.\n");
+
+err_config_pool:
+	TEEC_ConfigureContextPool(NULL);
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static TEEC_Result run_invoke_multi_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session sessions[MULTI_INVOKE_SESSIONS] = { 0 };
+	TEEC_Session *session_ptrs[MULTI_INVOKE_SESSIONS] = { 0 };
+	TEEC_Operation operations[MULTI_INVOKE_SESSIONS] = { 0 };
+	TEEC_Operation *operation_ptrs[MULTI_INVOKE_SESSIONS] = { 0 };
+	TEEC_Result results[MULTI_INVOKE_SESSIONS] = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint32_t num_open = 0;
+	uint8_t check_buf[BUFFER_SIZE] = { 0 };
+	uint8_t buffers[MULTI_INVOKE_SESSIONS][BUFFER_SIZE] = { 0 };
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	for (num_open = 0; num_open < MULTI_INVOKE_SESSIONS; num_open++) {
+		result = TEEC_OpenSession(&context, &sessions[num_open],
+					  &gp_test_uuid, TEEC_LOGIN_USER, NULL,
+					  NULL, &return_origin);
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_OpenSession failed, ret = 0x%x.\n",
+			       result);
+			goto err_open_sess;
+		}
+	}
+
+	memset(check_buf, 0x2, sizeof(check_buf));
+
+	for (uint32_t i = 0; i < MULTI_INVOKE_SESSIONS; i++) {
+		memset(buffers[i], 0x1, BUFFER_SIZE);
+
+		operations[i].paramTypes =
+			TEEC_PARAM_TYPES(TEEC_VALUE_INPUT,
+					 TEEC_MEMREF_TEMP_INOUT, TEEC_NONE,
+					 TEEC_NONE);
+		operations[i].params[0].value.a = 2;
+		operations[i].params[1].tmpref.buffer = buffers[i];
+		operations[i].params[1].tmpref.size = BUFFER_SIZE;
+
+		session_ptrs[i] = &sessions[i];
+		operation_ptrs[i] = &operations[i];
+	}
+
+	result = TEEC_InvokeCommandMulti(session_ptrs, MULTI_INVOKE_SESSIONS,
+					 EXAMPLE_MULTIPLY_HLOS_BUFFER_CMD,
+					 operation_ptrs, INVOKE_TIMEOUT_MS,
+					 results, NULL);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeCommandMulti failed, ret = 0x%x.\n",
+		       result);
+		goto err_open_sess;
+	}
+
+	for (uint32_t i = 0; i < MULTI_INVOKE_SESSIONS; i++) {
+		if (memcmp(buffers[i], check_buf, BUFFER_SIZE)) {
+			printf("[TEST FAILED] Buffer %u comparison failed!\n",
+			       i);
+			result = TEEC_ERROR_GENERIC;
+			goto err_open_sess;
+		}
+	}
+
+	printf("[TEST PASSED] Buffer comparison success.\n");
+
+err_open_sess:
+	for (uint32_t i = 0; i < num_open; i++)
+		TEEC_CloseSession(&sessions[i]);
+
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static TEEC_Result run_session_recovery_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_SessionRecoveryConfig config = { 0 };
+	TEEC_SessionRecoveryStats stats = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint32_t idempotent[] = { GP_PROPERTY_TESTS };
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	config.maxRetries = 1;
+	config.holdOff = SESSION_RECOVERY_HOLD_OFF_MS;
+	config.idempotentCommands = idempotent;
+	config.numIdempotentCommands = 1;
+
+	result = TEEC_ConfigureSessionRecovery(&context, &config);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_ConfigureSessionRecovery failed, ret = 0x%x.\n",
+		       result);
+		goto err_config_recovery;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_config_recovery;
+	}
+
+	result = TEEC_InvokeCommand(&session, GP_PROPERTY_TESTS, NULL,
+				    &return_origin);
+
+	TEEC_CloseSession(&session);
+
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeCommand failed, ret = 0x%x.\n", result);
+		goto err_config_recovery;
+	}
+
+	/* A healthy Trusted Application is never recovered */
+	result = TEEC_GetSessionRecoveryStats(&context, &stats);
+	if (result != TEEC_SUCCESS || stats.recoveries ||
+	    stats.failedRecoveries) {
+		printf("[TEST FAILED] Unexpected session recovery!\n");
+		result = TEEC_ERROR_GENERIC;
+		goto err_config_recovery;
+	}
+
+	printf("[TEST PASSED] Session recovery configured.\n");
+
+err_config_recovery:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static TEEC_Result run_statistics_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_StatisticsConfig config = { 0 };
+	TEEC_CommandStatistics stats[2] = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint32_t num_stats = 2;
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	config.maxCommands = 1;
+
+	result = TEEC_ConfigureStatistics(&context, &config);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_ConfigureStatistics failed, ret = 0x%x.\n",
+		       result);
+		goto err_config_stats;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_config_stats;
+	}
+
+	for (uint32_t i = 0; i < STATISTICS_INVOKE_COUNT; i++) {
+		result = TEEC_InvokeCommand(&session, GP_PROPERTY_TESTS, NULL,
+					    &return_origin);
+		if (result != TEEC_SUCCESS) {
+			printf("TEEC_InvokeCommand failed, ret = 0x%x.\n",
+			       result);
+			goto err_open_sess;
+		}
+	}
+
+	result = TEEC_GetStatistics(&session, stats, &num_stats);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_GetStatistics failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	if (num_stats != 1 || stats[0].commandID != GP_PROPERTY_TESTS ||
+	    stats[0].invocations != STATISTICS_INVOKE_COUNT) {
+		printf("[TEST FAILED] Unexpected counters!\n");
+		result = TEEC_ERROR_GENERIC;
+		goto err_open_sess;
+	}
+
+	printf("[TEST PASSED] %u invocations took %llu us.\n",
+	       STATISTICS_INVOKE_COUNT,
+	       (unsigned long long)stats[0].totalTime);
+
+err_open_sess:
+	TEEC_CloseSession(&session);
+
+err_config_stats:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+#ifdef MINKTEEC_LOCAL_TA
+/* The library only opens sessions with the local TA when built with it. */
+
+static TEEC_Result run_local_ta_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_Operation operation = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint8_t buf[BUFFER_SIZE] = { 0 };
+	uint32_t hash = 0x811C9DC5;
+
+	/* Contexts initialized from now on open sessions with the local TA */
+	setenv("MINKTEEC_LOCAL_TA", "1", 1);
+	result = TEEC_InitializeContext(NULL, &context);
+	unsetenv("MINKTEEC_LOCAL_TA");
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_TEMP_OUTPUT,
+						TEEC_VALUE_INPUT, TEEC_NONE,
+						TEEC_NONE);
+	operation.params[0].tmpref.buffer = buf;
+	operation.params[0].tmpref.size = sizeof(buf);
+	operation.params[1].value.a = LOCAL_TA_FILL_BYTE;
+
+	result = TEEC_InvokeCommand(&session, TEEC_LOCAL_TA_CMD_MEMFILL,
+				    &operation, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeCommand failed, ret = 0x%x.\n", result);
+		goto err_invoke;
+	}
+
+	for (size_t i = 0; i < sizeof(buf); i++) {
+		if (buf[i] != LOCAL_TA_FILL_BYTE) {
+			printf("[TEST FAILED] Buffer not filled!\n");
+			result = TEEC_ERROR_GENERIC;
+			goto err_invoke;
+		}
+
+		hash = (hash ^ buf[i]) * 0x01000193;
+	}
+
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_TEMP_INPUT,
+						TEEC_VALUE_OUTPUT, TEEC_NONE,
+						TEEC_NONE);
+	operation.params[0].tmpref.size = sizeof(buf);
+
+	result = TEEC_InvokeCommand(&session, TEEC_LOCAL_TA_CMD_CHECKSUM,
+				    &operation, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeCommand failed, ret = 0x%x.\n", result);
+		goto err_invoke;
+	}
+
+	if (operation.params[1].value.a != hash) {
+		printf("[TEST FAILED] Checksum 0x%x, expected 0x%x!\n",
+		       operation.params[1].value.a, hash);
+		result = TEEC_ERROR_GENERIC;
+		goto err_invoke;
+	}
+
+	/* The sleep is cancelled once the timeout expires */
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_NONE,
+						TEEC_NONE, TEEC_NONE);
+	operation.params[0].value.a = LOCAL_TA_SLEEP_MS;
+
+	result = TEEC_InvokeCommandWithTimeout(&session,
+					       TEEC_LOCAL_TA_CMD_SLEEP,
+					       &operation, INVOKE_TIMEOUT_MS,
+					       &return_origin);
+	if (result != TEEC_ERROR_CANCEL) {
+		printf("[TEST FAILED] Sleep not cancelled, ret = 0x%x.\n",
+		       result);
+		result = TEEC_ERROR_GENERIC;
+		goto err_invoke;
+	}
+
+	result = TEEC_SUCCESS;
+	printf("[TEST PASSED] Checksum 0x%x.\n", hash);
+
+err_invoke:
+	TEEC_CloseSession(&session);
+
+err_open_sess:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+/* A payload streamed from memory, which fails to read past fail_at. */
+struct stream_payload {
+	const uint8_t *data;
+	size_t size;
+	size_t pos;
+	size_t fail_at;
+};
+
+static ssize_t read_payload(void *user_data, void *buffer, size_t size)
+{
+	struct stream_payload *payload = user_data;
+
+	if (payload->fail_at && payload->pos >= payload->fail_at)
+		return -1;
+
+	if (size > payload->size - payload->pos)
+		size = payload->size - payload->pos;
+
+	memcpy(buffer, payload->data + payload->pos, size);
+	payload->pos += size;
+
+	return (ssize_t)size;
+}
+
+static TEEC_Result run_stream_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_Operation operation = { 0 };
+	TEEC_StreamConfig config = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	static uint8_t data[STREAM_CHUNKS * STREAM_CHUNK_SIZE];
+	struct stream_payload payload = { data, sizeof(data), 0, 0 };
+	uint32_t hash = 0x811C9DC5;
+
+	for (size_t i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t)(i * 7);
+		hash = (hash ^ data[i]) * 0x01000193;
+	}
+
+	setenv("MINKTEEC_LOCAL_TA", "1", 1);
+	result = TEEC_InitializeContext(NULL, &context);
+	unsetenv("MINKTEEC_LOCAL_TA");
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	/* The TA fails chunks out of order, and the payload, a multiple of
+	 * the chunk size, ends with an empty final chunk.
+	 */
+	config.commandID = TEEC_LOCAL_TA_CMD_STREAM;
+	config.numBuffers = STREAM_BUFFERS;
+	config.chunkSize = STREAM_CHUNK_SIZE;
+	config.read = read_payload;
+	config.userData = &payload;
+
+	result = TEEC_InvokeStream(&session, &config, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeStream failed, ret = 0x%x, origin %u.\n",
+		       result, return_origin);
+		goto err_invoke;
+	}
+
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_OUTPUT, TEEC_NONE,
+						TEEC_NONE, TEEC_NONE);
+
+	result = TEEC_InvokeCommand(&session, TEEC_LOCAL_TA_CMD_STREAM_HASH,
+				    &operation, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeCommand failed, ret = 0x%x.\n", result);
+		goto err_invoke;
+	}
+
+	if (operation.params[0].value.a != hash ||
+	    operation.params[0].value.b != STREAM_CHUNKS + 1) {
+		printf("[TEST FAILED] Stream 0x%x of %u chunks!\n",
+		       operation.params[0].value.a,
+		       operation.params[0].value.b);
+		result = TEEC_ERROR_GENERIC;
+		goto err_invoke;
+	}
+
+	/* A payload which cannot be read fails in the library */
+	payload.pos = 0;
+	payload.fail_at = STREAM_FAIL_AT;
+
+	result = TEEC_InvokeStream(&session, &config, &return_origin);
+	if (result != TEEC_ERROR_GENERIC ||
+	    return_origin != TEEC_ORIGIN_API) {
+		printf("[TEST FAILED] Read failure 0x%x, origin %u!\n",
+		       result, return_origin);
+		result = TEEC_ERROR_GENERIC;
+		goto err_invoke;
+	}
+
+	/* A failed chunk fails the stream with its origin */
+	payload.pos = 0;
+	payload.fail_at = 0;
+	config.commandID = TEEC_LOCAL_TA_CMD_STREAM_HASH;
+
+	result = TEEC_InvokeStream(&session, &config, &return_origin);
+	if (result != TEEC_ERROR_BAD_PARAMETERS ||
+	    return_origin != TEEC_ORIGIN_TRUSTED_APP) {
+		printf("[TEST FAILED] Chunk failure 0x%x, origin %u!\n",
+		       result, return_origin);
+		result = TEEC_ERROR_GENERIC;
+		goto err_invoke;
+	}
+
+	result = TEEC_SUCCESS;
+	printf("[TEST PASSED] Stream 0x%x.\n", hash);
+
+err_invoke:
+	TEEC_CloseSession(&session);
+
+err_open_sess:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+/* A command in flight as its session crashes. */
+struct crashed_invoke {
+	TEEC_Session *session;
+	TEEC_Result result;
+	uint32_t return_origin;
+};
+
+static void *invoke_crashed_sleep(void *arg)
+{
+	struct crashed_invoke *invoke = arg;
+	TEEC_Operation operation = { 0 };
+
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT, TEEC_NONE,
+						TEEC_NONE, TEEC_NONE);
+	operation.params[0].value.a = RECOVERY_SLEEP_MS;
+
+	invoke->result = TEEC_InvokeCommand(invoke->session,
+					    TEEC_LOCAL_TA_CMD_SLEEP, &operation,
+					    &invoke->return_origin);
+
+	return NULL;
+}
+
+/**
+ * @brief Crash the local TA of a session, and check the session recovery
+ * statistics once the given command was invoked in it.
+ */
+static TEEC_Result crash_and_invoke(TEEC_Context *context,
+				    TEEC_Session *session, uint32_t command,
+				    TEEC_Result expected, uint64_t recoveries,
+				    uint64_t retries)
+{
+	TEEC_Operation operation = { 0 };
+	TEEC_SessionRecoveryStats stats = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+
+	result = TEEC_InvokeCommand(session, TEEC_LOCAL_TA_CMD_CRASH, NULL,
+				    &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeCommand failed, ret = 0x%x.\n", result);
+		return result;
+	}
+
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT,
+						TEEC_VALUE_OUTPUT, TEEC_NONE,
+						TEEC_NONE);
+	operation.params[0].value.a = command;
+
+	result = TEEC_InvokeCommand(session, command, &operation,
+				    &return_origin);
+	if (result != expected ||
+	    (result && return_origin != TEEC_ORIGIN_TEE)) {
+		printf("[TEST FAILED] Command 0x%x: 0x%x, origin %u!\n",
+		       command, result, return_origin);
+		return TEEC_ERROR_GENERIC;
+	}
+
+	result = TEEC_GetSessionRecoveryStats(context, &stats);
+	if (result != TEEC_SUCCESS || stats.recoveries != recoveries ||
+	    stats.retries != retries || stats.failedRecoveries) {
+		printf("[TEST FAILED] %llu recoveries, %llu retries!\n",
+		       (unsigned long long)stats.recoveries,
+		       (unsigned long long)stats.retries);
+		return TEEC_ERROR_GENERIC;
+	}
+
+	return TEEC_SUCCESS;
+}
+
+static TEEC_Result run_local_session_recovery_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_SessionRecoveryConfig config = { 0 };
+	TEEC_SessionRecoveryStats stats = { 0 };
+	TEEC_Result result = TEEC_ERROR_GENERIC;
+	uint32_t return_origin = 0xFFFFFFFF;
+	uint32_t idempotent[] = { TEEC_LOCAL_TA_CMD_ECHO };
+	struct crashed_invoke invokes[RECOVERY_THREADS];
+	pthread_t threads[RECOVERY_THREADS];
+	uint32_t num_threads = 0;
+
+	setenv("MINKTEEC_LOCAL_TA", "1", 1);
+	result = TEEC_InitializeContext(NULL, &context);
+	unsetenv("MINKTEEC_LOCAL_TA");
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	config.maxRetries = 1;
+	config.holdOff = SESSION_RECOVERY_HOLD_OFF_MS;
+	config.idempotentCommands = idempotent;
+	config.numIdempotentCommands = 1;
+
+	result = TEEC_ConfigureSessionRecovery(&context, &config);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_ConfigureSessionRecovery failed, ret = 0x%x.\n",
+		       result);
+		goto err_open_sess;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	/* An idempotent command is retried in the recovered session */
+	result = crash_and_invoke(&context, &session, TEEC_LOCAL_TA_CMD_ECHO,
+				  TEEC_SUCCESS, 1, 1);
+	if (result != TEEC_SUCCESS)
+		goto err_invoke;
+
+	/* Others fail, but the session is recovered for the next commands */
+	result = crash_and_invoke(&context, &session,
+				  TEEC_LOCAL_TA_CMD_STREAM_HASH,
+				  TEEC_ERROR_TARGET_DEAD, 2, 1);
+	if (result != TEEC_SUCCESS)
+		goto err_invoke;
+
+	/* Commands in flight as the TA crashes wait for a single recovery */
+	for (num_threads = 0; num_threads < RECOVERY_THREADS; num_threads++) {
+		invokes[num_threads].session = &session;
+		if (pthread_create(&threads[num_threads], NULL,
+				   invoke_crashed_sleep,
+				   &invokes[num_threads])) {
+			printf("pthread_create failed.\n");
+			result = TEEC_ERROR_GENERIC;
+			break;
+		}
+	}
+
+	usleep(RECOVERY_CRASH_DELAY_MS * 1000);
+
+	if (num_threads == RECOVERY_THREADS)
+		result = TEEC_InvokeCommand(&session, TEEC_LOCAL_TA_CMD_CRASH,
+					    NULL, &return_origin);
+
+	for (uint32_t i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
 
-		if (commands[i] == GP_TA_TA_NEG_TESTS)
-			result = result != TEEC_SUCCESS ? TEEC_SUCCESS :
-							  TEEC_ERROR_GENERIC;
+	if (result != TEEC_SUCCESS)
+		goto err_invoke;
 
-		if (result != TEEC_SUCCESS)
-			printf("TEEC_InvokeCommand %d failed, ret = 0x%x.\n",
-			       commands[i], result);
-		else
-			printf("TEEC_InvokeCommand %d passed.\n", commands[i]);
+	for (uint32_t i = 0; i < RECOVERY_THREADS; i++) {
+		if (invokes[i].result != TEEC_ERROR_TARGET_DEAD ||
+		    invokes[i].return_origin != TEEC_ORIGIN_TEE) {
+			printf("[TEST FAILED] Sleep 0x%x, origin %u!\n",
+			       invokes[i].result, invokes[i].return_origin);
+			result = TEEC_ERROR_GENERIC;
+			goto err_invoke;
+		}
 	}
 
+	result = TEEC_GetSessionRecoveryStats(&context, &stats);
+	if (result != TEEC_SUCCESS || stats.recoveries != 3 ||
+	    stats.coalesced != RECOVERY_THREADS - 1) {
+		printf("[TEST FAILED] %llu recoveries, %llu coalesced!\n",
+		       (unsigned long long)stats.recoveries,
+		       (unsigned long long)stats.coalesced);
+		result = TEEC_ERROR_GENERIC;
+		goto err_invoke;
+	}
+
+	result = TEEC_SUCCESS;
+	printf("[TEST PASSED] Session recovered %llu times.\n",
+	       (unsigned long long)stats.recoveries);
+
+err_invoke:
 	TEEC_CloseSession(&session);
 
 err_open_sess:
@@ -123,83 +1278,127 @@ err_init_context:
 	return result;
 }
 
-static TEEC_Result run_compare_tmp_buffer_test(void)
+static TEEC_Result run_shareable_memory_test(void)
 {
 	printf("==== [%s] START ====\n", __func__);
 
-	TEEC_Context context = { 0 };
+	/* The producer and the consumer would be two processes, the memfd
+	 * passed from one to the other over a UNIX socket.
+	 */
+	TEEC_Context producer = { 0 };
+	TEEC_Context consumer = { 0 };
 	TEEC_Session session = { 0 };
 	TEEC_Operation operation = { 0 };
-	TEEC_TempMemoryReference tmpref = { 0 };
+	TEEC_SharedMemory produced = { 0 };
+	TEEC_SharedMemory imported = { 0 };
 	TEEC_Result result = TEEC_ERROR_GENERIC;
 	uint32_t return_origin = 0xFFFFFFFF;
-	uint8_t check_buf[BUFFER_SIZE] = { 0 };
+	uint32_t hash = 0x811C9DC5;
+	int fd = -1;
 
-	result = TEEC_InitializeContext(NULL, &context);
+	result = TEEC_InitializeContext(NULL, &producer);
 	if (result != TEEC_SUCCESS) {
 		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
-		goto err_init_context;
+		goto err_init_producer;
 	}
 
-	result = TEEC_OpenSession(&context, &session, &gp_test_uuid,
-				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
+	produced.size = SHAREABLE_MEM_SIZE;
+	produced.flags = TEEC_MEM_INPUT | TEEC_MEM_SHAREABLE;
+
+	result = TEEC_AllocateSharedMemory(&producer, &produced);
 	if (result != TEEC_SUCCESS) {
-		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
-		goto err_open_sess;
+		printf("TEEC_AllocateSharedMemory failed, ret = 0x%x.\n",
+		       result);
+		goto err_alloc;
 	}
 
-	// Allocate temp mem
-	tmpref.buffer = malloc(BUFFER_SIZE);
-	if (!tmpref.buffer)
-		goto err_tmp_malloc;
-	tmpref.size = BUFFER_SIZE;
+	result = TEEC_ExportSharedMemory(&produced, &fd);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_ExportSharedMemory failed, ret = 0x%x.\n", result);
+		goto err_export;
+	}
 
-	/* Initialize buffer to all 1's */
-	memset(tmpref.buffer, 0x1, tmpref.size);
+	setenv("MINKTEEC_LOCAL_TA", "1", 1);
+	result = TEEC_InitializeContext(NULL, &consumer);
+	unsetenv("MINKTEEC_LOCAL_TA");
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_consumer;
+	}
 
-	/* Initialize check_buf to all 1's */
-	memset(check_buf, 0x1, sizeof(check_buf));
+	imported.flags = TEEC_MEM_INPUT;
 
-	/* Setup operation */
-	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_VALUE_INPUT,
-						TEEC_MEMREF_TEMP_INOUT,
-						TEEC_NONE, TEEC_NONE);
+	result = TEEC_ImportSharedMemory(&consumer, &imported, fd);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_ImportSharedMemory failed, ret = 0x%x.\n", result);
+		goto err_import;
+	}
 
-	operation.params[0].value.a = 42;
-	operation.params[1].tmpref = tmpref;
+	if (imported.size < SHAREABLE_MEM_SIZE) {
+		printf("[TEST FAILED] Imported 0x%zx bytes!\n", imported.size);
+		result = TEEC_ERROR_GENERIC;
+		goto err_open_sess;
+	}
 
-	result = TEEC_InvokeCommand(&session, EXAMPLE_MULTIPLY_HLOS_BUFFER_CMD,
-				    &operation, &return_origin);
+	/* Written by the producer after the import, read by the TA */
+	for (size_t i = 0; i < imported.size; i++) {
+		((uint8_t *)produced.buffer)[i] = (uint8_t)i;
+		hash = (hash ^ (uint8_t)i) * 0x01000193;
+	}
 
+	result = TEEC_OpenSession(&consumer, &session, &gp_test_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &return_origin);
 	if (result != TEEC_SUCCESS) {
-		printf("TEEC_InvokeCommand failed, ret = 0x%x.\n", result);
-		goto err_invoke_cmd;
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
 	}
 
-	/* Do the multiply locally */
-	for (size_t cnt = 0; cnt < tmpref.size; ++cnt)
-		*(check_buf + cnt) *= operation.params[0].value.a;
+	operation.paramTypes = TEEC_PARAM_TYPES(TEEC_MEMREF_WHOLE,
+						TEEC_VALUE_OUTPUT, TEEC_NONE,
+						TEEC_NONE);
+	operation.params[0].memref.parent = &imported;
 
-	if (memcmp(tmpref.buffer, check_buf, tmpref.size))
-		printf("[TEST FAILED] Buffer comparison failed!\n");
-	else
-		printf("[TEST PASSED] Buffer comparison success.\n");
+	result = TEEC_InvokeCommand(&session, TEEC_LOCAL_TA_CMD_CHECKSUM,
+				    &operation, &return_origin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InvokeCommand failed, ret = 0x%x.\n", result);
+		goto err_invoke;
+	}
 
-err_invoke_cmd:
-	free(tmpref.buffer);
+	if (operation.params[1].value.a != hash) {
+		printf("[TEST FAILED] Checksum 0x%x, expected 0x%x!\n",
+		       operation.params[1].value.a, hash);
+		result = TEEC_ERROR_GENERIC;
+		goto err_invoke;
+	}
 
-err_tmp_malloc:
+	printf("[TEST PASSED] Checksum 0x%x.\n", hash);
+
+err_invoke:
 	TEEC_CloseSession(&session);
 
 err_open_sess:
-	TEEC_FinalizeContext(&context);
+	TEEC_ReleaseSharedMemory(&imported);
 
-err_init_context:
+err_import:
+	TEEC_FinalizeContext(&consumer);
+
+err_init_consumer:
+	close(fd);
+
+err_export:
+	TEEC_ReleaseSharedMemory(&produced);
+
+err_alloc:
+	TEEC_FinalizeContext(&producer);
+
+err_init_producer:
 
 	printf("==== [%s] END ====\n", __func__);
 
 	return result;
 }
+#endif
 
 static TEEC_Result run_temp_memory_ref_test(void)
 {
@@ -213,6 +1412,7 @@ static TEEC_Result run_temp_memory_ref_test(void)
 	TEEC_Result result = TEEC_ERROR_GENERIC;
 	uint32_t return_origin = 0xFFFFFFFF;
 	uint8_t check_buf[BUFFER_SIZE] = { 0 };
+	TEEC_BounceBufferStats bounce_stats = { 0 };
 
 	result = TEEC_InitializeContext(NULL, &context);
 	if (result != TEEC_SUCCESS) {
@@ -271,6 +1471,17 @@ static TEEC_Result run_temp_memory_ref_test(void)
 	else
 		printf("[TEST PASSED] Buffer comparison success.\n");
 
+	result = TEEC_GetBounceBufferStats(&context, &bounce_stats);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_GetBounceBufferStats failed, ret = 0x%x.\n",
+		       result);
+		goto err_invoke_cmd;
+	}
+
+	printf("Bounce buffers: %llu hits, %llu misses.\n",
+	       (unsigned long long)bounce_stats.hits,
+	       (unsigned long long)bounce_stats.misses);
+
 err_invoke_cmd:
 	free(tmpref2.buffer);
 	free(tmpref1.buffer);
@@ -721,6 +1932,125 @@ err_init_context:
 	return result;
 }
 
+static void *send_cancel_session_request(void *arg)
+{
+	usleep(200 * 1000);
+	TEEC_CancelSession((TEEC_Session *)arg);
+
+	return 0;
+}
+
+static int run_cancel_session_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	/* Allocate TEE Client structures on the stack. */
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_Result result = 0xFFFFFFFF;
+	uint32_t returnOrigin = 0;
+	uint32_t command = GP_SAMPLE_WAIT_TEST;
+	pthread_t cancel_thread_id;
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_sample2_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &returnOrigin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	/* Create a new thread to cancel the session */
+	result = pthread_create(&cancel_thread_id, NULL,
+				send_cancel_session_request, &session);
+	if (result) {
+		printf("pthread_create failed, ret = 0x%x.\n", result);
+		goto err_thread_create;
+	}
+
+	/* Without an operation, only the session can cancel the command */
+	result = TEEC_InvokeCommand(&session, command, NULL, &returnOrigin);
+
+	pthread_join(cancel_thread_id, NULL);
+
+	if (result == TEEC_ERROR_CANCEL) {
+		printf("Cancel session test passed!\n");
+		result = TEEC_SUCCESS;
+	} else
+		printf("Cancel session test failed!, ret = 0x%x.\n", result);
+
+err_thread_create:
+	TEEC_CloseSession(&session);
+
+err_open_sess:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
+static int run_invoke_cmd_timeout_test(void)
+{
+	printf("==== [%s] START ====\n", __func__);
+
+	/* Allocate TEE Client structures on the stack. */
+	TEEC_Context context = { 0 };
+	TEEC_Session session = { 0 };
+	TEEC_Operation operation = { 0 };
+	TEEC_Result result = 0xFFFFFFFF;
+	uint32_t returnOrigin = 0;
+	uint32_t command = GP_SAMPLE_WAIT_TEST;
+
+	operation.paramTypes =
+		TEEC_PARAM_TYPES(TEEC_NONE, TEEC_NONE, TEEC_NONE, TEEC_NONE);
+
+	operation.started = 0;
+
+	result = TEEC_InitializeContext(NULL, &context);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_InitializeContext failed, ret = 0x%x.\n", result);
+		goto err_init_context;
+	}
+
+	result = TEEC_OpenSession(&context, &session, &gp_sample2_uuid,
+				  TEEC_LOGIN_USER, NULL, NULL, &returnOrigin);
+	if (result != TEEC_SUCCESS) {
+		printf("TEEC_OpenSession failed, ret = 0x%x.\n", result);
+		goto err_open_sess;
+	}
+
+	/* The command waits for a cancellation, delivered on timeout */
+	result = TEEC_InvokeCommandWithTimeout(&session, command, &operation,
+					       INVOKE_TIMEOUT_MS,
+					       &returnOrigin);
+
+	if (result == TEEC_ERROR_CANCEL) {
+		printf("Invoke command timeout test passed!\n");
+		result = TEEC_SUCCESS;
+	} else
+		printf("Invoke command timeout test failed!, ret = 0x%x.\n",
+		       result);
+
+	TEEC_CloseSession(&session);
+
+err_open_sess:
+	TEEC_FinalizeContext(&context);
+
+err_init_context:
+
+	printf("==== [%s] END ====\n", __func__);
+
+	return result;
+}
+
 static void usage(void)
 {
 	printf("\n\n---------------------------------------------------------\n"
@@ -817,6 +2147,86 @@ common_tests:
 		goto exit;
 	}
 
+	result = run_prepared_invoke_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_prepared_invoke_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_async_invoke_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_async_invoke_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_session_pool_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_session_pool_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_context_pool_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_context_pool_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_invoke_multi_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_invoke_multi_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_session_recovery_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_session_recovery_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_statistics_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_statistics_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+#ifdef MINKTEEC_LOCAL_TA
+	result = run_local_ta_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_local_ta_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_shareable_memory_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_shareable_memory_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_stream_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_stream_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_local_session_recovery_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_local_session_recovery_test failed: 0x%x\n",
+		       result);
+		ret = -1;
+		goto exit;
+	}
+#endif
+
 	result = run_temp_memory_ref_test();
 	if (result != TEEC_SUCCESS) {
 		printf("run_temp_memory_ref_test failed: 0x%x\n", result);
@@ -848,6 +2258,20 @@ common_tests:
 		goto exit;
 	}
 
+	result = run_cancel_session_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_cancel_session_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
+	result = run_invoke_cmd_timeout_test();
+	if (result != TEEC_SUCCESS) {
+		printf("run_invoke_cmd_timeout_test failed: 0x%x\n", result);
+		ret = -1;
+		goto exit;
+	}
+
 exit:
 	if (preload)
 		unload_gp_tas();
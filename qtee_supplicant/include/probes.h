@@ -0,0 +1,22 @@
+// Copyright (c) Qualcomm Technologies, Inc. and/or its subsidiaries.
+// SPDX-License-Identifier: BSD-3-Clause-Clear
+
+#ifndef _PROBES_H_
+#define _PROBES_H_
+
+/* Static USDT probes of the "minkipc" provider.
+ *
+ * Probes are built in with -DENABLE_USDT=ON and cost a single nop until a
+ * tracer (bpftrace, perf) attaches to them. Otherwise they compile to nothing
+ * and their arguments are not evaluated.
+ */
+
+#ifdef MINKIPC_USDT
+#include <sys/sdt.h>
+
+#define PROBE(name, ...) STAP_PROBEV(minkipc, name, ##__VA_ARGS__)
+#else
+#define PROBE(name, ...) do { } while (0)
+#endif
+
+#endif // _PROBES_H_
@@ -3,6 +3,7 @@
 
 #include <dlfcn.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -11,6 +12,7 @@
 #include "listener_mngr.h"
 #include "memscpy.h"
 #include "MinkCom.h"
+#include "probes.h"
 
 #include "CListenerCBO.h"
 #include "IListenerCBO_invoke.h"
@@ -125,9 +127,13 @@ static int32_t CListenerCBO_request(ListenerCBO* me,
 	if (expected == BUSY)
 		return Object_ERROR_BUSY;
 
+	PROBE(listener_request_entry, me->listener_id,
+	      MinkCom_getCorrelationId());
+
 	rv = MinkCom_getMemoryObjectInfo(me->smo, &buf, &buf_len);
 	if (Object_isERROR(rv)) {
-		MSGE("getMemoryObjectInfo failed: 0x%x\n", rv);
+		MSGE("getMemoryObjectInfo failed: 0x%x, request 0x%" PRIx64
+		     "\n", rv, MinkCom_getCorrelationId());
 		goto exit;
 	}
 
@@ -146,7 +152,9 @@ static int32_t CListenerCBO_request(ListenerCBO* me,
 	ret = me->dispatch_func(tmp_buf, buf_len);
 	if (ret) {
 		rv = Object_ERROR;
-		MSGE("dispatch_func failed: %d\n", ret);
+		MSGE("dispatch_func failed: %d for lid : %d, request 0x%"
+		     PRIx64 "\n", ret, me->listener_id,
+		     MinkCom_getCorrelationId());
 	}
 
 	memscpy(buf, buf_len, tmp_buf, buf_len);
@@ -158,6 +166,9 @@ exit:
 	/* Signal the TAs in QTEE waiting on this listener for availability */
 	signal_waiting_listener(me);
 
+	PROBE(listener_request_exit, me->listener_id, rv,
+	      MinkCom_getCorrelationId());
+
 	return rv;
 }
 
@@ -183,6 +194,9 @@ static int32_t CListenerCBO_wait(ListenerCBO *me)
 	if (atomic_load(&me->listener_busy) == FREE)
 		return Object_OK;
 
+	PROBE(listener_wait_entry, me->listener_id,
+	      MinkCom_getCorrelationId());
+
 	/* Now wait... */
 	pthread_mutex_lock(&me->wait_mutex);
 
@@ -215,8 +229,10 @@ static int32_t CListenerCBO_wait(ListenerCBO *me)
 	if(cond_ret_val != 0) {
 		if(cond_ret_val == ETIMEDOUT) {
 			MSGE("[%s], PID : %d, Timed out: The max limit on wait"
-			      " timedout : %s (%d) for lid : %d\n", __FUNCTION__,
-			      getpid(), strerror(errno), errno, me->listener_id);
+			      " timedout : %s (%d) for lid : %d, request 0x%"
+			      PRIx64 "\n", __FUNCTION__, getpid(),
+			      strerror(errno), errno, me->listener_id,
+			      MinkCom_getCorrelationId());
 
 			/* In case of a timeout, dont send error back to TZ.
 			 * Instead, we want the request to be lined up again.
@@ -240,6 +256,9 @@ static int32_t CListenerCBO_wait(ListenerCBO *me)
 
 	pthread_mutex_unlock(&me->wait_mutex);
 
+	PROBE(listener_wait_exit, me->listener_id, rv,
+	      MinkCom_getCorrelationId());
+
 	return rv;
 }
 